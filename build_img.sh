@@ -1,17 +1,47 @@
 image_name="flash_image.bin"
 baud_frequency="115200"
+build_env="az-delivery-devkit-v4"
+partition_table="partitions.csv"
+
+# Prints the offset and size columns of a partition in the table
+partition_field() {
+    awk -F',' -v name="$1" -v column="$2" \
+        '$1 == name { gsub(/[ \t]/, "", $column); print $column }' "$partition_table"
+}
+
+app_size=$(partition_field app0 5)
+assets_offset=$(partition_field assets 4)
+assets_size=$(partition_field assets 5)
+if [ -z "$app_size" ] || [ -z "$assets_offset" ] || [ -z "$assets_size" ]; then
+    echo "Error: $partition_table needs app0 and assets partitions."
+    exit 1
+fi
 
 echo "Building image: $image_name with baud frequency: $baud_frequency"
 
-pio run
+pio run -e $build_env
 if [ $? -ne 0 ]; then
     echo "Error during build. Please check the output for details."
     exit 1
 fi
+echo "Packing assets..."
+python3 tools/mkassets.py assets build/assets.bin --max-size $assets_size
+if [ $? -ne 0 ]; then
+    echo "Error packing assets. Please check the output for details."
+    exit 1
+fi
+
 echo "Moving files..."
-mv .pio/build/az-delivery-devkit-v4/firmware.bin build/firmware.bin
-mv .pio/build/az-delivery-devkit-v4/bootloader.bin build/bootloader.bin
-mv .pio/build/az-delivery-devkit-v4/partitions.bin build/partitions.bin
+mv .pio/build/$build_env/firmware.bin build/firmware.bin
+mv .pio/build/$build_env/bootloader.bin build/bootloader.bin
+mv .pio/build/$build_env/partitions.bin build/partitions.bin
+
+# OTA writes the image into the other slot, so it has to fit one
+firmware_size=$(wc -c < build/firmware.bin)
+if [ "$firmware_size" -gt $((app_size)) ]; then
+    echo "Error: firmware.bin is $firmware_size bytes, the app slot holds $((app_size))."
+    exit 1
+fi
 
 # check if esptool.py is installed
 if ! command -v esptool.py &> /dev/null; then
@@ -23,7 +53,8 @@ esptool.py --chip esp32 merge_bin -o $image_name --flash_mode dio --flash_freq 4
 0xe000 app_bin/boot_app0.bin \
 0x1000 build/bootloader.bin \
 0x8000 build/partitions.bin \
-0x10000 build/firmware.bin --fill-flash-size 4MB
+0x10000 build/firmware.bin \
+$assets_offset build/assets.bin --fill-flash-size 4MB
 if [ $? -ne 0 ]; then
     echo "Error creating image. Please check the output for details."
     exit 1
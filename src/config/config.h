@@ -21,10 +21,151 @@
 #define DEFAULT_STACK_SIZE 2048
 #define IDLE_TASK_STACK_SIZE 1024
 
+// Stack Tuning Settings
+#define STACK_TUNE_APPLY 1              // 0 only reports recommendations
+#define STACK_TUNE_PATH "/stacks.bin"
+#define STACK_TUNE_MAX_PROFILES 24
+#define STACK_TUNE_MARGIN_PERCENT 25    // Headroom over the peak ever observed
+#define STACK_TUNE_MIN_HEADROOM 512
+#define STACK_TUNE_MIN_SIZE 1024
+#define STACK_TUNE_ROUNDING 256
+#define STACK_TUNE_MIN_OBSERVED_S 600   // Profiles younger than this are not applied
+#define STACK_TUNE_SAVE_INTERVAL_MS 60000
+
+// Boot Settings
+#define BOOT_SERIAL_SETTLE_MS 100       // Time for a serial monitor to attach
+#define BOOT_MAX_STAGES 16
+#define BOOT_STAGE_STACK_SIZE 4096
+#define BOOT_STAGE_PRIORITY 1
+
 // File System Settings
+// Storage backend for the data partition. Existing devices hold SPIFFS
+// data; LittleFS cannot mount it and only reformats the partition when
+// FORMAT_LITTLEFS_IF_FAILED is set, so switching means losing its files.
+#define FS_BACKEND_SPIFFS 0
+#define FS_BACKEND_LITTLEFS 1               // Real directories, power-loss safe
+#define FS_BACKEND FS_BACKEND_SPIFFS
+#define FS_PARTITION_LABEL "spiffs"
+#define FS_BENCH_PARTITION "fsbench"        // Scratch partition wiped by fsbench
+#define FS_BENCH_FILES 32
+#define FS_BENCH_FILE_SIZE 1024
+#define FS_BENCH_RANDOM_WRITES 64
 #define FS_MAX_FILES 32
 #define FS_MAX_PATH_LENGTH 64
 #define FS_BLOCK_SIZE 512
+#define FORMAT_SPIFFS_IF_FAILED true
+#define FORMAT_LITTLEFS_IF_FAILED false     // Opt in: wipes a partition LittleFS can't mount
+#define FS_FULL_THRESHOLD_PERCENT 90
+#define FS_CACHE_BLOCKS 16              // FS_BLOCK_SIZE pages kept in RAM
+#define FS_CACHE_FILES 16               // Files with cached metadata
+#define FS_CACHE_READAHEAD 2            // Extra blocks fetched on sequential misses
+#define FS_INDEX_MAX_ENTRIES 1024       // Beyond this the path index is dropped for flash scans
+#define FS_DIRECT_READ_MIN 2048         // Larger reads go straight to flash, sparing the cache
+#define FS_STRING_READ_MAX 8192         // readFile(String) refuses anything bigger
+#define FS_STRING_HEAP_RESERVE 16384    // Heap that must remain after a String read
+#define FS_STRING_CHUNK 128             // Stack buffer used to fill the String
+#define FS_ATOMIC_WRITES 1              // writeFile replaces through a temp file and rename
+#define FS_REPLACE_LOCKS 4              // Replaces of one path share a temp name; hashed to a lock
+#define FS_COMPRESS_FRAME_SIZE 1024     // Raw bytes per independently compressed frame
+#define FS_COMPRESS_MAX_CHAIN 16        // Match candidates tried per position
+#define FS_COMPRESS_DIRS 4
+#define FS_COMPRESS_DEFAULT_DIR ""      // Compressed from boot, e.g. "/logs/"; small appends grow
+#define FS_USAGE_RECONCILE_MS 30000     // Real usage query this long after a write
+#define FS_LOG_BUFFER_SIZE 1024         // Records batched in RAM per append log
+#define FS_LOG_FLUSH_MS 1000            // Oldest buffered record's maximum age
+#define FS_LOG_DURABILITY 1             // LogDurability default: LOG_DURABILITY_TIMED
+#define FS_LOG_BENCH_MAX 2000
+
+#if FS_BACKEND == FS_BACKEND_LITTLEFS
+#define FS_VOLUME "littlefs"
+#else
+#define FS_VOLUME "spiffs"
+#endif
+
+// Async File I/O Settings
+#define FSIO_QUEUE_LENGTH 16
+#define FSIO_BATCH 8                    // Requests drained and scheduled together
+#define FSIO_TASK_STACK_SIZE 4096
+#define FSIO_TASK_PRIORITY 1            // Below the shell and sensor tasks
+#define FSIO_BENCH_MAX 64
+
+// Asset Store Settings
+#define ASSET_PARTITION_LABEL "assets"
+#define ASSET_PARTITION_SUBTYPE 0x40    // Custom data subtype in partitions.csv
+
+// Mount Table Settings
+#define MOUNT_MAX_VOLUMES 6
+#define MOUNT_LAZY_SD 1                 // Probe SD slots on first use, not at boot
+
+// Interrupt Latency Settings
+#define LATENCY_MAX_SOURCES 4
+#define LATENCY_HISTOGRAM_BUCKETS 64
+#define LATENCY_SELFTEST_TIMER 0
+#define LATENCY_SELFTEST_PRIORITY 5
+#define LATENCY_SELFTEST_MAX_HZ 20000
+#define LATENCY_SELFTEST_LOAD_US 900
+
+// Deferred Work Settings
+#define WORKQUEUE_DEPTH 32              // Per core and priority, power of two
+#define WORKQUEUE_WORKER_STACK_SIZE 3072
+#define WORKQUEUE_WORKER_PRIORITY 10
+
+// Event Bus Settings
+#define EVENT_MAX_SUBSCRIBERS 16
+
+// Metrics Settings
+#define METRICS_MAX 48
+#define METRICS_MAX_HISTOGRAMS 6
+#define METRICS_HISTOGRAM_BUCKETS 8
+#define METRICS_NAME_LENGTH 32
+#define METRICS_BINARY_MAX_SIZE 1536
+
+// Kernel Timer Settings
+#define TIMER_WHEEL_BITS 6          // 64 slots per level
+#define TIMER_WHEEL_LEVELS 4        // 2^24 ticks of range
+#define TIMER_SERVICE_STACK_SIZE 4096
+#define TIMER_SERVICE_PRIORITY 2
+#define TIMER_BENCH_MAX 4000
+#define TIMER_BENCH_MIN_DELAY_MS 50
+#define SYSTEM_MONITOR_INTERVAL_MS 5000
+
+// CPU Frequency Governor Settings
+#define GOVERNOR_INTERVAL_MS 200
+#define GOVERNOR_IDLE_INTERVAL_MS 2000  // At the lowest level, so light sleep is not cut short
+#define GOVERNOR_UP_PERCENT 70          // Busiest core above this jumps to the top level
+#define GOVERNOR_DOWN_PERCENT 30        // Below this for GOVERNOR_DOWN_WINDOWS steps down one level
+#define GOVERNOR_DOWN_WINDOWS 3
+
+// Profiler Settings
+#define PROFILER_TIMER_BASE 2       // Hardware timers 2 and 3, one per core
+#define PROFILER_MAX_SAMPLES 4096   // 8 bytes each, allocated on first start
+#define PROFILER_MAX_TASKS 24
+#define PROFILER_DEFAULT_HZ 1000
+#define PROFILER_MAX_HZ 10000
+
+// Service Registry Settings
+#define SERVICES_MAX 8
+#define SERVICE_FS_ESSENTIAL 0      // Otherwise mounted by the first file command,
+                                    // or at boot when STACK_TUNE_APPLY needs the profiles
+#define SERVICE_SHELL_ESSENTIAL 1   // Otherwise started by the first keystroke
+
+// Warm Reboot Settings
+#define WARM_MAX_COUNTERS 32
+
+// Power Management Settings
+#define POWER_TASK_STACK_SIZE 3072
+#define POWER_TASK_CORE 0           // Sleep is decided here once the other core is idle too
+#define POWER_IDLE_HOLDOFF_MS 5000  // Stay awake this long after console or button activity
+#define POWER_MIN_SLEEP_MS 20       // Shorter idle gaps are not worth the wake-up cost
+#define POWER_MAX_SLEEP_MS 10000
+#define POWER_CONSOLE_UART 0
+#define POWER_UART_WAKE_EDGES 3     // RX edges that wake the chip; the waking byte is lost
+
+// Postmortem Settings
+#define POSTMORTEM_MAX_TASKS MAX_TASKS
+#define POSTMORTEM_TRACE_EVENTS 32
+#define POSTMORTEM_METRICS_SIZE 1024
+#define POSTMORTEM_CHECKPOINT_MS 5000
 
 // Hardware Settings
 #define LED_BUILTIN_PIN 2
@@ -0,0 +1,278 @@
+/*
+ * ESP32-OS Append Log Implementation
+ */
+
+#include "appendlog.h"
+#include "fs.h"
+#include "../kernel/kernel.h"
+
+#define LOG_BENCH_PATH "/logbench.txt"
+
+AppendLog::AppendLog(FileSystem* fs) : fs(fs), compressed(false), durability(LOG_DURABILITY_TIMED), logMutex(nullptr),
+                                       buffer(nullptr), buffered(0), flushQueued(false),
+                                       records(0), flushes(0), bytesFlushed(0), failedFlushes(0),
+                                       recordCounter(nullptr), flushCounter(nullptr) {
+    path[0] = '\0';
+    TimerService::setup(&flushTimer, onFlushTimer, this);
+}
+
+AppendLog::~AppendLog() {
+    close();
+    if (logMutex) {
+        vSemaphoreDelete(logMutex);
+        logMutex = nullptr;
+    }
+}
+
+bool AppendLog::open(const char* path, LogDurability durability) {
+    if (!fs || !path) {
+        return false;
+    }
+    close();
+
+    if (!logMutex) {
+        logMutex = xSemaphoreCreateMutex();
+        if (!logMutex) {
+            Serial.println("AppendLog: Failed to create mutex");
+            return false;
+        }
+    }
+
+    buffer = (uint8_t*)malloc(FS_LOG_BUFFER_SIZE);
+    if (!buffer) {
+        Serial.println("AppendLog: Failed to allocate buffer");
+        return false;
+    }
+
+    // Held open for the life of the log; no open/close per record.
+    // The format is decided by the file as it stands before opening.
+    compressed = fs->appendsCompressed(path);
+    file = fs->openFile(path, "a");
+    if (!file) {
+        Serial.printf("AppendLog: Failed to open %s\n", path);
+        free(buffer);
+        buffer = nullptr;
+        return false;
+    }
+
+    strncpy(this->path, path, sizeof(this->path) - 1);
+    this->path[sizeof(this->path) - 1] = '\0';
+    this->durability = durability;
+    buffered = 0;
+
+    MetricsRegistry* registry = kernel ? kernel->getMetrics() : nullptr;
+    if (registry) {
+        recordCounter = registry->registerCounter("fs_log_records_total");
+        flushCounter = registry->registerCounter("fs_log_flushes_total");
+    }
+    return true;
+}
+
+void AppendLog::close() {
+    if (!buffer) {
+        return;
+    }
+
+    TimerService* timers = kernel ? kernel->getTimerService() : nullptr;
+    if (timers) {
+        timers->cancel(&flushTimer);
+    }
+    // A timed flush already on the work queue still points at this log
+    while (flushQueued.load()) {
+        vTaskDelay(1);
+    }
+
+    xSemaphoreTake(logMutex, portMAX_DELAY);
+    flushLocked();
+    fs->closeFile(file, path);
+    free(buffer);
+    buffer = nullptr;
+    xSemaphoreGive(logMutex);
+}
+
+bool AppendLog::append(const uint8_t* data, size_t length) {
+    if (!buffer || !data || xSemaphoreTake(logMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+    bool ok = appendLocked(data, length);
+    if (ok) {
+        records++;
+        MetricsRegistry::increment(recordCounter);
+    }
+    if (durability == LOG_DURABILITY_RECORD) {
+        ok = flushLocked() && ok;
+    }
+    xSemaphoreGive(logMutex);
+    return ok;
+}
+
+bool AppendLog::append(const char* record) {
+    if (!buffer || !record || xSemaphoreTake(logMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+    // Room for both is made first, so the record and its newline land in
+    // the same batch unless the record is too big to buffer at all
+    size_t length = strlen(record);
+    bool ok = (buffered + length + 1 <= FS_LOG_BUFFER_SIZE || flushLocked()) &&
+              appendLocked((const uint8_t*)record, length) &&
+              appendLocked((const uint8_t*)"\n", 1);
+    if (ok) {
+        records++;
+        MetricsRegistry::increment(recordCounter);
+    }
+    if (durability == LOG_DURABILITY_RECORD) {
+        ok = flushLocked() && ok;
+    }
+    xSemaphoreGive(logMutex);
+    return ok;
+}
+
+bool AppendLog::appendLocked(const uint8_t* data, size_t length) {
+    if (buffered + length > FS_LOG_BUFFER_SIZE && !flushLocked()) {
+        return false;
+    }
+
+    // Oversized records skip the buffer rather than being split
+    if (length > FS_LOG_BUFFER_SIZE) {
+        size_t written = writeOut(data, length);
+        flushes++;
+        bytesFlushed += written;
+        MetricsRegistry::increment(flushCounter);
+        fs->noteWritten(path, file.size());
+        return written == length;
+    }
+
+    bool wasEmpty = buffered == 0;
+    memcpy(buffer + buffered, data, length);
+    buffered += length;
+
+    if (wasEmpty && durability == LOG_DURABILITY_TIMED) {
+        TimerService* timers = kernel ? kernel->getTimerService() : nullptr;
+        if (timers) {
+            timers->start(&flushTimer, FS_LOG_FLUSH_MS);
+        }
+    }
+    return true;
+}
+
+bool AppendLog::flushLocked() {
+    if (buffered == 0) {
+        return true;
+    }
+
+    size_t written = writeOut(buffer, buffered);
+    file.flush();                   // Commits data and size, not just the write cache
+    flushes++;
+    bytesFlushed += written;
+    MetricsRegistry::increment(flushCounter);
+    fs->noteWritten(path, file.size());
+
+    // A failed batch is dropped and counted; retrying would grow without bound
+    bool ok = written == buffered;
+    if (!ok) {
+        failedFlushes++;
+        Serial.printf("AppendLog: Short write to %s (%u of %u bytes)\n",
+                      path, (unsigned)written, (unsigned)buffered);
+    }
+    buffered = 0;
+
+    TimerService* timers = kernel ? kernel->getTimerService() : nullptr;
+    if (timers) {
+        timers->cancel(&flushTimer);
+    }
+    return ok;
+}
+
+bool AppendLog::sync() {
+    if (!buffer || xSemaphoreTake(logMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+    bool ok = flushLocked();
+    xSemaphoreGive(logMutex);
+    return ok;
+}
+
+// A compressed batch becomes whole frames, so it is written completely or not at all
+size_t AppendLog::writeOut(const uint8_t* data, size_t length) {
+    if (compressed) {
+        return fs->writeCompressed(file, &data, &length, 1) ? length : 0;
+    }
+    return file.write(data, length);
+}
+
+// Timer service context: flash writes are handed to the work queue
+void AppendLog::onFlushTimer(void* arg) {
+    AppendLog* log = (AppendLog*)arg;
+    WorkQueue* workQueue = kernel ? kernel->getWorkQueue() : nullptr;
+    if (!workQueue || log->flushQueued.exchange(true)) {
+        return;
+    }
+    if (!workQueue->post(timedFlush, log, WORK_PRIO_LOW)) {
+        log->flushQueued.store(false);
+    }
+}
+
+void AppendLog::timedFlush(void* arg) {
+    AppendLog* log = (AppendLog*)arg;
+    if (log->buffer && xSemaphoreTake(log->logMutex, portMAX_DELAY) == pdTRUE) {
+        log->flushLocked();
+        xSemaphoreGive(log->logMutex);
+    }
+    log->flushQueued.store(false);
+}
+
+void AppendLog::printStatistics() {
+    Serial.printf("Append log %s:\n", path[0] ? path : "(closed)");
+    Serial.printf("  Records:        %u\n", records);
+    Serial.printf("  Flash writes:   %u (%u bytes, %u failed)\n", flushes, bytesFlushed, failedFlushes);
+    Serial.printf("  Buffered:       %u / %d bytes\n", (unsigned)buffered, FS_LOG_BUFFER_SIZE);
+    if (flushes > 0) {
+        Serial.printf("  Records/write:  %.1f\n", (float)records / flushes);
+    }
+}
+
+bool AppendLog::runBenchmark(FileSystem* fs, uint32_t recordCount) {
+    if (!fs || recordCount == 0) {
+        return false;
+    }
+
+    char record[48];
+
+    // Baseline: one open, write and close per record
+    fs->deleteFile(LOG_BENCH_PATH);
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < recordCount; i++) {
+        snprintf(record, sizeof(record), "seq=%05u value=%08x\n", i, i * 2654435761UL);
+        if (!fs->appendFile(LOG_BENCH_PATH, record)) {
+            Serial.println("AppendLog: appendFile failed during benchmark");
+            fs->deleteFile(LOG_BENCH_PATH);
+            return false;
+        }
+    }
+    uint32_t directUs = micros() - start;
+
+    fs->deleteFile(LOG_BENCH_PATH);
+    AppendLog log(fs);
+    start = micros();
+    if (!log.open(LOG_BENCH_PATH, LOG_DURABILITY_BATCH)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < recordCount; i++) {
+        snprintf(record, sizeof(record), "seq=%05u value=%08x", i, i * 2654435761UL);
+        log.append(record);
+    }
+    log.close();
+    uint32_t logUs = micros() - start;
+    uint32_t logWrites = log.getFlushes();
+
+    fs->deleteFile(LOG_BENCH_PATH);
+
+    Serial.println("Method          Time (ms)    Records/s   Flash writes");
+    Serial.println("------------------------------------------------------");
+    Serial.printf("appendFile   %12.1f %12.0f %14u\n", directUs / 1000.0,
+                  recordCount * 1000000.0 / (directUs ? directUs : 1), recordCount);
+    Serial.printf("AppendLog    %12.1f %12.0f %14u\n", logUs / 1000.0,
+                  recordCount * 1000000.0 / (logUs ? logUs : 1), logWrites);
+    Serial.printf("Speedup: %.1fx\n", (float)directUs / (logUs ? logUs : 1));
+    return true;
+}
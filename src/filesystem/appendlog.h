@@ -0,0 +1,76 @@
+/*
+ * ESP32-OS Append Log Header
+ * Buffered record log that keeps its file open and flushes in batches
+ */
+
+#ifndef APPENDLOG_H
+#define APPENDLOG_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
+#include "FS.h"
+#include "../config/config.h"
+#include "../kernel/metrics.h"
+#include "../kernel/timerwheel.h"
+
+class FileSystem;
+
+// How much an acknowledged append can lose on a crash or power cut
+enum LogDurability {
+    LOG_DURABILITY_BATCH = 0,   // Up to FS_LOG_BUFFER_SIZE bytes; flushed on size or sync()
+    LOG_DURABILITY_TIMED,       // Also flushed FS_LOG_FLUSH_MS after the first buffered record
+    LOG_DURABILITY_RECORD       // Nothing; every append is written and committed
+};
+
+class AppendLog {
+private:
+    FileSystem* fs;
+    char path[FS_MAX_PATH_LENGTH];
+    File file;
+    bool compressed;            // Batches are written as compressed frames
+    LogDurability durability;
+    SemaphoreHandle_t logMutex;
+    uint8_t* buffer;
+    size_t buffered;
+    SoftTimer flushTimer;
+    std::atomic<bool> flushQueued;  // Timed flush posted to the work queue
+
+    // Statistics
+    uint32_t records;
+    uint32_t flushes;           // Batches written to flash
+    uint32_t bytesFlushed;
+    uint32_t failedFlushes;
+
+    Metric* recordCounter;
+    Metric* flushCounter;
+
+    bool appendLocked(const uint8_t* data, size_t length);
+    bool flushLocked();
+    size_t writeOut(const uint8_t* data, size_t length);
+    static void onFlushTimer(void* arg);
+    static void timedFlush(void* arg);
+
+public:
+    AppendLog(FileSystem* fs);
+    ~AppendLog();
+
+    bool open(const char* path, LogDurability durability = (LogDurability)FS_LOG_DURABILITY);
+    void close();
+    bool isOpen() const { return buffer != nullptr; }
+
+    bool append(const uint8_t* data, size_t length);
+    bool append(const char* record);        // Adds the trailing newline
+    // Writes everything buffered and commits it to flash
+    bool sync();
+
+    uint32_t getRecords() const { return records; }
+    uint32_t getFlushes() const { return flushes; }
+    void printStatistics();
+
+    // Logs the same records through appendFile() and through an AppendLog
+    static bool runBenchmark(FileSystem* fs, uint32_t recordCount);
+};
+
+#endif // APPENDLOG_H
@@ -0,0 +1,136 @@
+/*
+ * ESP32-OS Asset Store Implementation
+ */
+
+#include "assets.h"
+#include "../kernel/checksum.h"
+
+AssetStore::AssetStore() : image(nullptr), mapHandle(0), header(nullptr), entries(nullptr),
+                           lookups(0), misses(0) {
+}
+
+AssetStore::~AssetStore() {
+    shutdown();
+}
+
+bool AssetStore::init() {
+    const esp_partition_t* partition = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)ASSET_PARTITION_SUBTYPE, ASSET_PARTITION_LABEL);
+    if (!partition) {
+        Serial.println("AssetStore: No '" ASSET_PARTITION_LABEL "' partition");
+        return false;
+    }
+
+    // Validate the header before mapping so only the image itself is mapped
+    AssetHeader probe;
+    if (esp_partition_read(partition, 0, &probe, sizeof(probe)) != ESP_OK ||
+        probe.magic != ASSET_MAGIC || probe.version != ASSET_VERSION) {
+        Serial.println("AssetStore: No asset image in partition");
+        return false;
+    }
+    if (probe.imageSize > partition->size ||
+        sizeof(AssetHeader) + probe.indexSize > probe.imageSize ||
+        probe.count * sizeof(AssetEntry) > probe.indexSize) {
+        Serial.println("AssetStore: Asset image header is corrupt");
+        return false;
+    }
+
+    const void* mapped = nullptr;
+    if (esp_partition_mmap(partition, 0, probe.imageSize, SPI_FLASH_MMAP_DATA,
+                           &mapped, &mapHandle) != ESP_OK) {
+        Serial.println("AssetStore: Failed to map asset partition");
+        return false;
+    }
+    image = (const uint8_t*)mapped;
+    header = (const AssetHeader*)image;
+    entries = (const AssetEntry*)(image + sizeof(AssetHeader));
+
+    // Checked once here so lookups can trust every offset
+    bool valid = fnv1a(entries, header->indexSize) == header->indexChecksum;
+    uint32_t namesEnd = sizeof(AssetHeader) + header->indexSize;
+    for (uint16_t i = 0; valid && i < header->count; i++) {
+        valid = entries[i].nameOffset < namesEnd &&
+                entries[i].dataOffset <= header->imageSize &&
+                entries[i].length <= header->imageSize - entries[i].dataOffset;
+    }
+    if (!valid) {
+        Serial.println("AssetStore: Asset index checksum mismatch");
+        shutdown();
+        return false;
+    }
+
+    Serial.printf("AssetStore: %u assets mapped (%u bytes)\n", header->count, header->imageSize);
+    return true;
+}
+
+void AssetStore::shutdown() {
+    if (image) {
+        spi_flash_munmap(mapHandle);
+    }
+    image = nullptr;
+    header = nullptr;
+    entries = nullptr;
+}
+
+void AssetStore::makeAsset(const AssetEntry& entry, Asset& out) const {
+    out.name = (const char*)(image + entry.nameOffset);
+    out.data = image + entry.dataOffset;
+    out.length = entry.length;
+}
+
+bool AssetStore::find(const char* name, Asset& out) {
+    if (!header || !name) {
+        return false;
+    }
+    if (name[0] == '/') {
+        name++;
+    }
+    lookups++;
+
+    // Lower bound on the hash; names are only compared within a hash run
+    uint32_t hash = fnv1a(name, strlen(name));
+    size_t low = 0;
+    size_t high = header->count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (entries[mid].nameHash < hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    for (size_t i = low; i < header->count && entries[i].nameHash == hash; i++) {
+        if (strcmp((const char*)(image + entries[i].nameOffset), name) == 0) {
+            makeAsset(entries[i], out);
+            return true;
+        }
+    }
+    misses++;
+    return false;
+}
+
+void AssetStore::forEach(AssetVisitor_t visitor, void* context) {
+    if (!header || !visitor) {
+        return;
+    }
+
+    Asset asset;
+    for (uint16_t i = 0; i < header->count; i++) {
+        makeAsset(entries[i], asset);
+        visitor(asset, context);
+    }
+}
+
+void AssetStore::printStatistics() {
+    Serial.println("Asset Store Statistics:");
+    Serial.println("=======================");
+    if (!header) {
+        Serial.println("Not mapped");
+        return;
+    }
+    Serial.printf("Assets:          %u\n", header->count);
+    Serial.printf("Image size:      %u bytes\n", header->imageSize);
+    Serial.printf("Mapped at:       %p\n", image);
+    Serial.printf("Lookups:         %u (%u misses)\n", lookups, misses);
+}
@@ -0,0 +1,71 @@
+/*
+ * ESP32-OS Asset Store Header
+ * Read-only assets mapped straight out of their own flash partition
+ */
+
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "../config/config.h"
+
+// Image layout written by tools/mkassets.py; all fields little-endian.
+// Entries are sorted by (nameHash, name) and data is 4-byte aligned.
+#define ASSET_MAGIC 0x54455341      // "ASET"
+#define ASSET_VERSION 1
+
+struct AssetHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t indexSize;         // Entries, names and padding after the header
+    uint32_t imageSize;
+    uint32_t indexChecksum;     // FNV-1a over the index
+};
+
+struct AssetEntry {
+    uint32_t nameHash;          // FNV-1a of the name
+    uint32_t nameOffset;        // From the start of the image
+    uint32_t dataOffset;
+    uint32_t length;
+};
+
+// Points into mapped flash; valid until the store shuts down
+struct Asset {
+    const char* name;
+    const uint8_t* data;
+    size_t length;
+};
+
+typedef void (*AssetVisitor_t)(const Asset& asset, void* context);
+
+class AssetStore {
+private:
+    const uint8_t* image;       // Mapped partition, nullptr until init
+    spi_flash_mmap_handle_t mapHandle;
+    const AssetHeader* header;
+    const AssetEntry* entries;
+
+    // Statistics
+    uint32_t lookups;
+    uint32_t misses;
+
+    void makeAsset(const AssetEntry& entry, Asset& out) const;
+
+public:
+    AssetStore();
+    ~AssetStore();
+
+    bool init();
+    void shutdown();
+
+    // Zero-copy and zero-heap: the result points into flash
+    bool find(const char* name, Asset& out);
+    void forEach(AssetVisitor_t visitor, void* context);
+
+    uint16_t getCount() const { return header ? header->count : 0; }
+    void printStatistics();
+};
+
+#endif // ASSETS_H
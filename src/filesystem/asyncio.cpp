@@ -0,0 +1,380 @@
+/*
+ * ESP32-OS Async File I/O Implementation
+ */
+
+#include "asyncio.h"
+#include "fs.h"
+#include "../kernel/kernel.h"
+#include <new>
+
+#define FSIO_BENCH_PATH "/fsio_bench.txt"
+#define FSIO_BENCH_RECORD 64
+
+AsyncIO::AsyncIO() : fs(nullptr), queue(nullptr), ioTask(nullptr), running(false),
+                     submitted(0), completed(0), failed(0), rejected(0),
+                     mergedAppends(0), reorderedReads(0), maxLatencyUs(0), maxDepth(0) {
+}
+
+AsyncIO::~AsyncIO() {
+    shutdown();
+}
+
+bool AsyncIO::init() {
+    if (running) {
+        return true;
+    }
+
+    fs = kernel && kernel->getServices() ? kernel->getServices()->get<FileSystem>("fs") : nullptr;
+    if (!fs) {
+        Serial.println("AsyncIO: File system not available");
+        return false;
+    }
+
+    queue = xQueueCreate(FSIO_QUEUE_LENGTH, sizeof(IoRequest*));
+    if (!queue) {
+        Serial.println("AsyncIO: Failed to create request queue");
+        return false;
+    }
+
+    running = true;
+    if (xTaskCreate(ioLoop, "fsio", FSIO_TASK_STACK_SIZE, this,
+                    FSIO_TASK_PRIORITY, &ioTask) != pdPASS) {
+        running = false;
+        vQueueDelete(queue);
+        queue = nullptr;
+        Serial.println("AsyncIO: Failed to create I/O task");
+        return false;
+    }
+
+    Serial.println("AsyncIO: File I/O task started");
+    return true;
+}
+
+void AsyncIO::shutdown() {
+    if (!running) {
+        return;
+    }
+
+    // Let the batch in progress finish; a null request wakes an idle task
+    running = false;
+    IoRequest* wake = nullptr;
+    xQueueSend(queue, &wake, portMAX_DELAY);
+    while (ioTask) {
+        vTaskDelay(1);
+    }
+    
+    // Nothing will serve what is still queued; fail it so no waiter hangs
+    IoRequest* request = nullptr;
+    while (xQueueReceive(queue, &request, 0) == pdTRUE) {
+        if (request) {
+            request->transferred = 0;
+            complete(request, false);
+        }
+    }
+    vQueueDelete(queue);
+    queue = nullptr;
+}
+
+void AsyncIO::setup(IoRequest* request) {
+    memset(request, 0, sizeof(IoRequest));
+    request->done = xSemaphoreCreateBinaryStatic(&request->doneStorage);
+}
+
+bool AsyncIO::submit(IoRequest* request) {
+    if (!running || !request->done || request->status == IO_PENDING) {
+        return false;
+    }
+
+    request->status = IO_PENDING;
+    request->transferred = 0;
+    request->latencyUs = 0;
+    request->submitUs = micros();
+    xSemaphoreTake(request->done, 0);   // Drop a completion nobody waited for
+
+    if (xQueueSend(queue, &request, 0) != pdTRUE) {
+        request->status = IO_IDLE;
+        rejected++;
+        return false;
+    }
+
+    submitted++;
+    uint32_t depth = uxQueueMessagesWaiting(queue);
+    if (depth > maxDepth) {
+        maxDepth = depth;
+    }
+    return true;
+}
+
+bool AsyncIO::read(IoRequest* request, const char* path, size_t offset, uint8_t* buffer, size_t length,
+                   IoCallback_t callback, void* context) {
+    if (!request || !path || !buffer) {
+        return false;
+    }
+    request->op = IO_READ;
+    request->path = path;
+    request->offset = offset;
+    request->buffer = buffer;
+    request->length = length;
+    request->callback = callback;
+    request->context = context;
+    return submit(request);
+}
+
+bool AsyncIO::write(IoRequest* request, const char* path, const uint8_t* data, size_t length,
+                    IoCallback_t callback, void* context) {
+    if (!request || !path || !data) {
+        return false;
+    }
+    request->op = IO_WRITE;
+    request->path = path;
+    request->data = data;
+    request->length = length;
+    request->callback = callback;
+    request->context = context;
+    return submit(request);
+}
+
+bool AsyncIO::append(IoRequest* request, const char* path, const uint8_t* data, size_t length,
+                     IoCallback_t callback, void* context) {
+    if (!request || !path || !data) {
+        return false;
+    }
+    request->op = IO_APPEND;
+    request->path = path;
+    request->data = data;
+    request->length = length;
+    request->callback = callback;
+    request->context = context;
+    return submit(request);
+}
+
+bool AsyncIO::remove(IoRequest* request, const char* path, IoCallback_t callback, void* context) {
+    if (!request || !path) {
+        return false;
+    }
+    request->op = IO_DELETE;
+    request->path = path;
+    request->length = 0;
+    request->callback = callback;
+    request->context = context;
+    return submit(request);
+}
+
+bool AsyncIO::wait(IoRequest* request, uint32_t timeoutMs) {
+    if (!request || !request->done || request->callback) {
+        return false;
+    }
+    if (request->status == IO_PENDING) {
+        TickType_t ticks = timeoutMs == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+        xSemaphoreTake(request->done, ticks);
+    }
+    return request->status == IO_DONE;
+}
+
+void AsyncIO::ioLoop(void* parameter) {
+    AsyncIO* io = (AsyncIO*)parameter;
+    IoRequest* batch[FSIO_BATCH];
+
+    while (io->running) {
+        if (xQueueReceive(io->queue, &batch[0], portMAX_DELAY) != pdTRUE || !batch[0]) {
+            continue;
+        }
+
+        // Whatever else is already queued is scheduled together
+        size_t count = 1;
+        while (count < FSIO_BATCH && xQueueReceive(io->queue, &batch[count], 0) == pdTRUE) {
+            if (batch[count]) {
+                count++;
+            }
+        }
+        io->runBatch(batch, count);
+    }
+
+    io->ioTask = nullptr;
+    vTaskDelete(nullptr);
+}
+
+// True if a request earlier in the batch modifies the same path
+bool AsyncIO::writtenBefore(IoRequest** batch, size_t index) {
+    for (size_t i = 0; i < index; i++) {
+        if (batch[i]->op != IO_READ && strcmp(batch[i]->path, batch[index]->path) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AsyncIO::runBatch(IoRequest** batch, size_t count) {
+    bool finished[FSIO_BATCH] = { false };
+
+    // Reads first: they are short and usually someone is waiting on them.
+    // A read never overtakes a write to its own path.
+    bool writeSeen = false;
+    for (size_t i = 0; i < count; i++) {
+        if (batch[i]->op != IO_READ) {
+            writeSeen = true;
+        } else if (!writtenBefore(batch, i)) {
+            if (writeSeen) {
+                reorderedReads++;
+            }
+            execute(batch[i]);
+            finished[i] = true;
+        }
+    }
+
+    // The rest in submission order
+    for (size_t i = 0; i < count; i++) {
+        if (finished[i]) {
+            continue;
+        }
+        if (batch[i]->op == IO_APPEND) {
+            i += runAppends(batch, finished, i, count) - 1;
+        } else {
+            execute(batch[i]);
+            finished[i] = true;
+        }
+    }
+}
+
+// Adjacent appends to one file share a single open and close
+size_t AsyncIO::runAppends(IoRequest** batch, bool* finished, size_t start, size_t count) {
+    const uint8_t* parts[FSIO_BATCH];
+    size_t lengths[FSIO_BATCH];
+    size_t run = 0;
+
+    size_t end = start;
+    while (end < count && !finished[end] && batch[end]->op == IO_APPEND &&
+           strcmp(batch[end]->path, batch[start]->path) == 0) {
+        parts[run] = batch[end]->data;
+        lengths[run] = batch[end]->length;
+        run++;
+        end++;
+    }
+
+    bool ok = fs->appendFile(batch[start]->path, parts, lengths, run);
+    for (size_t i = start; i < end; i++) {
+        batch[i]->transferred = ok ? batch[i]->length : 0;
+        finished[i] = true;
+        complete(batch[i], ok);
+    }
+    mergedAppends += run - 1;
+    return run;
+}
+
+void AsyncIO::execute(IoRequest* request) {
+    bool ok = false;
+    switch (request->op) {
+        case IO_READ:
+            request->transferred = fs->read(request->path, request->offset, request->buffer, request->length);
+            ok = request->transferred > 0 || fs->fileExists(request->path);
+            break;
+        case IO_WRITE:
+            ok = fs->writeFile(request->path, request->data, request->length);
+            request->transferred = ok ? request->length : 0;
+            break;
+        case IO_APPEND: {
+            const uint8_t* part = request->data;
+            ok = fs->appendFile(request->path, &part, &request->length, 1);
+            request->transferred = ok ? request->length : 0;
+            break;
+        }
+        case IO_DELETE:
+            ok = fs->deleteFile(request->path);
+            break;
+    }
+    complete(request, ok);
+}
+
+void AsyncIO::complete(IoRequest* request, bool ok) {
+    request->latencyUs = micros() - request->submitUs;
+    if (request->latencyUs > maxLatencyUs) {
+        maxLatencyUs = request->latencyUs;
+    }
+    completed++;
+    if (!ok) {
+        failed++;
+    }
+    request->status = ok ? IO_DONE : IO_FAILED;
+
+    // Exactly one completion path, so the caller may reuse or free the
+    // request as soon as it sees the result
+    if (request->callback) {
+        request->callback(request, request->context);
+    } else {
+        xSemaphoreGive(request->done);
+    }
+}
+
+void AsyncIO::printStatistics() {
+    Serial.println("Async File I/O Statistics:");
+    Serial.println("==========================");
+    Serial.printf("Submitted:       %u (%u rejected, queue full)\n", submitted, rejected);
+    Serial.printf("Completed:       %u (%u failed)\n", completed, failed);
+    Serial.printf("Merged appends:  %u\n", mergedAppends);
+    Serial.printf("Reordered reads: %u\n", reorderedReads);
+    Serial.printf("Max latency:     %u us\n", maxLatencyUs);
+    Serial.printf("Max queue depth: %u / %d\n", maxDepth, FSIO_QUEUE_LENGTH);
+}
+
+bool AsyncIO::runBenchmark(uint32_t count) {
+    if (!running || count == 0) {
+        return false;
+    }
+
+    IoRequest* requests = new (std::nothrow) IoRequest[count];
+    if (!requests) {
+        Serial.println("AsyncIO: Not enough memory for the benchmark");
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        setup(&requests[i]);
+    }
+    uint8_t record[FSIO_BENCH_RECORD];
+    memset(record, 'x', sizeof(record) - 1);
+    record[sizeof(record) - 1] = '\n';
+
+    // Synchronous: the caller waits out every flash write itself
+    fs->deleteFile(FSIO_BENCH_PATH);
+    const uint8_t* part = record;
+    size_t length = sizeof(record);
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < count; i++) {
+        fs->appendFile(FSIO_BENCH_PATH, &part, &length, 1);
+    }
+    uint32_t syncUs = micros() - start;
+
+    // Queued: the caller only pays for submission. Submissions that find
+    // the queue full are retried, which is counted against the caller.
+    fs->deleteFile(FSIO_BENCH_PATH);
+    uint32_t mergedBefore = mergedAppends;
+    uint32_t callerUs = 0;
+    bool ok = true;
+    start = micros();
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t submitStart = micros();
+        while (!append(&requests[i], FSIO_BENCH_PATH, record, sizeof(record))) {
+            if (!running) {
+                ok = false;     // Shut down meanwhile; the rest is never queued
+                break;
+            }
+            vTaskDelay(1);
+        }
+        callerUs += micros() - submitStart;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        ok = wait(&requests[i]) && ok;
+    }
+    uint32_t asyncUs = micros() - start;
+
+    fs->deleteFile(FSIO_BENCH_PATH);
+    for (uint32_t i = 0; i < count; i++) {
+        vSemaphoreDelete(requests[i].done);
+    }
+    delete[] requests;
+
+    Serial.printf("Synchronous appends:  %8.1f ms on the caller\n", syncUs / 1000.0);
+    Serial.printf("Queued appends:       %8.1f ms on the caller, %.1f ms to complete\n",
+                  callerUs / 1000.0, asyncUs / 1000.0);
+    Serial.printf("Appends merged:       %u of %u\n", mergedAppends - mergedBefore, count);
+    return ok;
+}
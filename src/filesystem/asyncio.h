@@ -0,0 +1,113 @@
+/*
+ * ESP32-OS Async File I/O Header
+ * Request queue served by a dedicated file system task
+ */
+
+#ifndef ASYNCIO_H
+#define ASYNCIO_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include "../config/config.h"
+
+class FileSystem;
+
+enum IoOp {
+    IO_READ = 0,
+    IO_WRITE,                   // Replaces the file
+    IO_APPEND,
+    IO_DELETE
+};
+
+enum IoStatus {
+    IO_IDLE = 0,
+    IO_PENDING,
+    IO_DONE,
+    IO_FAILED
+};
+
+struct IoRequest;
+typedef void (*IoCallback_t)(IoRequest* request, void* context);
+
+// Owned by the caller and queued by pointer, so submitting never allocates.
+// Initialize with AsyncIO::setup() before first use, and release done with
+// vSemaphoreDelete() before freeing it. The path and buffer must stay valid
+// until the request completes.
+struct IoRequest {
+    IoOp op;
+    const char* path;
+    size_t offset;              // Reads only
+    uint8_t* buffer;            // Read destination
+    const uint8_t* data;        // Write and append source
+    size_t length;
+    IoCallback_t callback;      // Runs on the I/O task; nullptr to use wait()
+    void* context;
+
+    volatile IoStatus status;
+    size_t transferred;
+    uint32_t submitUs;
+    uint32_t latencyUs;         // Submission to completion
+
+    StaticSemaphore_t doneStorage;
+    SemaphoreHandle_t done;
+};
+
+class AsyncIO {
+private:
+    FileSystem* fs;
+    QueueHandle_t queue;
+    TaskHandle_t ioTask;
+    volatile bool running;
+
+    // Statistics
+    uint32_t submitted;
+    uint32_t completed;
+    uint32_t failed;
+    uint32_t rejected;          // Queue full at submission
+    uint32_t mergedAppends;     // Appends that shared another request's open
+    uint32_t reorderedReads;    // Reads served ahead of earlier writes
+    uint32_t maxLatencyUs;
+    uint32_t maxDepth;
+
+    bool submit(IoRequest* request);
+    void runBatch(IoRequest** batch, size_t count);
+    bool writtenBefore(IoRequest** batch, size_t index);
+    size_t runAppends(IoRequest** batch, bool* finished, size_t start, size_t count);
+    void execute(IoRequest* request);
+    void complete(IoRequest* request, bool ok);
+
+    static void ioLoop(void* parameter);
+
+public:
+    AsyncIO();
+    ~AsyncIO();
+
+    bool init();
+    void shutdown();
+
+    static void setup(IoRequest* request);
+
+    // Never block: false when the request is still pending or the queue is full
+    bool read(IoRequest* request, const char* path, size_t offset, uint8_t* buffer, size_t length,
+              IoCallback_t callback = nullptr, void* context = nullptr);
+    bool write(IoRequest* request, const char* path, const uint8_t* data, size_t length,
+               IoCallback_t callback = nullptr, void* context = nullptr);
+    bool append(IoRequest* request, const char* path, const uint8_t* data, size_t length,
+                IoCallback_t callback = nullptr, void* context = nullptr);
+    bool remove(IoRequest* request, const char* path,
+                IoCallback_t callback = nullptr, void* context = nullptr);
+
+    // Future-style completion for requests submitted without a callback
+    bool wait(IoRequest* request, uint32_t timeoutMs = portMAX_DELAY);
+    static bool isDone(const IoRequest* request) { return request->status >= IO_DONE; }
+
+    void printStatistics();
+
+    // Caller-side time of synchronous appends against queued ones
+    bool runBenchmark(uint32_t count);
+};
+
+#endif // ASYNCIO_H
@@ -0,0 +1,364 @@
+/*
+ * ESP32-OS Block Cache Implementation
+ */
+
+#include "blockcache.h"
+#include "../kernel/checksum.h"
+
+BlockCache::BlockCache() : volume(nullptr), data(nullptr), cacheMutex(nullptr), clock(0),
+                           hitCounter(nullptr), missCounter(nullptr) {
+    memset(blocks, 0, sizeof(blocks));
+    memset(files, 0, sizeof(files));
+    resetStatistics();
+}
+
+BlockCache::~BlockCache() {
+    shutdown();
+}
+
+bool BlockCache::init(fs::FS* volume) {
+    if (data) {
+        return true;
+    }
+
+    cacheMutex = xSemaphoreCreateMutex();
+    if (!cacheMutex) {
+        Serial.println("BlockCache: Failed to create mutex");
+        return false;
+    }
+
+    data = (uint8_t*)malloc(FS_CACHE_BLOCKS * FS_BLOCK_SIZE);
+    if (!data) {
+        Serial.println("BlockCache: Failed to allocate cache memory");
+        vSemaphoreDelete(cacheMutex);
+        cacheMutex = nullptr;
+        return false;
+    }
+
+    this->volume = volume;
+    Serial.printf("BlockCache: %d x %d byte blocks allocated\n", FS_CACHE_BLOCKS, FS_BLOCK_SIZE);
+    return true;
+}
+
+void BlockCache::shutdown() {
+    if (data) {
+        free(data);
+        data = nullptr;
+    }
+    if (cacheMutex) {
+        vSemaphoreDelete(cacheMutex);
+        cacheMutex = nullptr;
+    }
+    volume = nullptr;
+}
+
+void BlockCache::setVolume(fs::FS* volume) {
+    invalidateAll();
+    this->volume = volume;
+}
+
+void BlockCache::registerMetrics(MetricsRegistry* registry) {
+    if (!registry) {
+        return;
+    }
+
+    hitCounter = registry->registerCounter("fs_cache_hits_total");
+    missCounter = registry->registerCounter("fs_cache_misses_total");
+}
+
+int BlockCache::lookupFileLocked(const char* path, uint32_t hash) {
+    for (int i = 0; i < FS_CACHE_FILES; i++) {
+        if (files[i].valid && files[i].pathHash == hash && strcmp(files[i].path, path) == 0) {
+            files[i].lastUsed = ++clock;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void BlockCache::dropFileLocked(int file) {
+    for (int i = 0; i < FS_CACHE_BLOCKS; i++) {
+        if (blocks[i].valid && blocks[i].file == file) {
+            blocks[i].valid = false;
+        }
+    }
+    files[file].valid = false;
+}
+
+int BlockCache::loadFileLocked(const char* path) {
+    if (!volume || strlen(path) >= FS_MAX_PATH_LENGTH) {
+        return -1;
+    }
+
+    int victim = 0;
+    for (int i = 0; i < FS_CACHE_FILES; i++) {
+        if (!files[i].valid) {
+            victim = i;
+            break;
+        }
+        if (files[i].lastUsed < files[victim].lastUsed) {
+            victim = i;
+        }
+    }
+    if (files[victim].valid) {
+        dropFileLocked(victim);
+        evictions++;
+    }
+
+    CachedFile& entry = files[victim];
+    strncpy(entry.path, path, sizeof(entry.path) - 1);
+    entry.path[sizeof(entry.path) - 1] = '\0';
+    entry.pathHash = fnv1a(path, strlen(path));
+    entry.exists = false;
+    entry.isDirectory = false;
+    entry.size = 0;
+    entry.lastWrite = 0;
+    entry.lastBlock = CACHE_NO_BLOCK;
+
+    // exists() first: opening a missing file for read logs an error
+    if (volume->exists(path)) {
+        File handle = volume->open(path, "r");
+        if (handle) {
+            entry.exists = true;
+            entry.isDirectory = handle.isDirectory();
+            entry.size = handle.size();
+            entry.lastWrite = handle.getLastWrite();
+            handle.close();
+        }
+    }
+
+    entry.lastUsed = ++clock;
+    entry.valid = true;
+    return victim;
+}
+
+int BlockCache::findBlockLocked(int file, uint32_t index) {
+    for (int i = 0; i < FS_CACHE_BLOCKS; i++) {
+        if (blocks[i].valid && blocks[i].file == file && blocks[i].index == index) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int BlockCache::victimBlockLocked() {
+    int victim = 0;
+    for (int i = 0; i < FS_CACHE_BLOCKS; i++) {
+        if (!blocks[i].valid) {
+            return i;
+        }
+        if (blocks[i].lastUsed < blocks[victim].lastUsed) {
+            victim = i;
+        }
+    }
+    evictions++;
+    return victim;
+}
+
+bool BlockCache::fillLocked(int file, File& handle, uint32_t first, uint32_t count) {
+    const CachedFile& entry = files[file];
+    uint32_t lastIndex = entry.size ? (entry.size - 1) / FS_BLOCK_SIZE : 0;
+
+    for (uint32_t index = first; index < first + count && index <= lastIndex; index++) {
+        if (findBlockLocked(file, index) >= 0) {
+            continue;
+        }
+
+        if (!handle) {
+            handle = volume->open(entry.path, "r");
+            if (!handle) {
+                return false;
+            }
+        }
+
+        int slot = victimBlockLocked();
+        size_t offset = (size_t)index * FS_BLOCK_SIZE;
+        size_t want = entry.size - offset < FS_BLOCK_SIZE ? entry.size - offset : FS_BLOCK_SIZE;
+        if (!handle.seek(offset) || handle.read(data + slot * FS_BLOCK_SIZE, want) != want) {
+            blocks[slot].valid = false;
+            return index > first;
+        }
+
+        blocks[slot].file = file;
+        blocks[slot].index = index;
+        blocks[slot].length = want;
+        blocks[slot].lastUsed = ++clock;
+        blocks[slot].valid = true;
+        if (index > first) {
+            readAhead++;
+        }
+    }
+    return true;
+}
+
+bool BlockCache::stat(const char* path, CacheStat& out) {
+    if (!path || !cacheMutex || xSemaphoreTake(cacheMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+
+    int file = lookupFileLocked(path, fnv1a(path, strlen(path)));
+    if (file >= 0) {
+        metaHits++;
+    } else {
+        metaMisses++;
+        file = loadFileLocked(path);
+    }
+
+    bool ok = file >= 0;
+    if (ok) {
+        out.exists = files[file].exists;
+        out.isDirectory = files[file].isDirectory;
+        out.size = files[file].size;
+        out.lastWrite = files[file].lastWrite;
+    }
+
+    xSemaphoreGive(cacheMutex);
+    return ok;
+}
+
+size_t BlockCache::read(const char* path, size_t offset, uint8_t* buffer, size_t length) {
+    if (!path || !buffer || !data || xSemaphoreTake(cacheMutex, portMAX_DELAY) != pdTRUE) {
+        return 0;
+    }
+
+    int file = lookupFileLocked(path, fnv1a(path, strlen(path)));
+    if (file < 0) {
+        file = loadFileLocked(path);
+    }
+    if (file < 0 || !files[file].exists || files[file].isDirectory || offset >= files[file].size) {
+        xSemaphoreGive(cacheMutex);
+        return 0;
+    }
+
+    CachedFile& entry = files[file];
+    if (length > entry.size - offset) {
+        length = entry.size - offset;
+    }
+
+    File handle;                // Opened on the first miss only
+    size_t copied = 0;
+    while (copied < length) {
+        size_t position = offset + copied;
+        uint32_t index = position / FS_BLOCK_SIZE;
+        size_t within = position % FS_BLOCK_SIZE;
+
+        int slot = findBlockLocked(file, index);
+        if (slot >= 0) {
+            hits++;
+            MetricsRegistry::increment(hitCounter);
+        } else {
+            misses++;
+            MetricsRegistry::increment(missCounter);
+
+            // Sequential access pulls the following blocks in the same pass
+            bool sequential = entry.lastBlock != CACHE_NO_BLOCK && entry.lastBlock + 1 == index;
+            if (!fillLocked(file, handle, index, sequential ? 1 + FS_CACHE_READAHEAD : 1)) {
+                break;
+            }
+            slot = findBlockLocked(file, index);
+            if (slot < 0) {
+                break;
+            }
+        }
+
+        CacheBlock& block = blocks[slot];
+        block.lastUsed = ++clock;
+        entry.lastBlock = index;
+        if (within >= block.length) {
+            break;
+        }
+
+        size_t chunk = block.length - within;
+        if (chunk > length - copied) {
+            chunk = length - copied;
+        }
+        memcpy(buffer + copied, data + slot * FS_BLOCK_SIZE + within, chunk);
+        copied += chunk;
+    }
+
+    if (handle) {
+        handle.close();
+    }
+
+    xSemaphoreGive(cacheMutex);
+    return copied;
+}
+
+void BlockCache::invalidate(const char* path) {
+    if (!path || !cacheMutex || xSemaphoreTake(cacheMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    int file = lookupFileLocked(path, fnv1a(path, strlen(path)));
+    if (file >= 0) {
+        dropFileLocked(file);
+        invalidations++;
+    }
+
+    xSemaphoreGive(cacheMutex);
+}
+
+void BlockCache::invalidatePrefix(const char* prefix) {
+    if (!prefix || !cacheMutex || xSemaphoreTake(cacheMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    size_t length = strlen(prefix);
+    for (int i = 0; i < FS_CACHE_FILES; i++) {
+        if (files[i].valid && strncmp(files[i].path, prefix, length) == 0) {
+            dropFileLocked(i);
+            invalidations++;
+        }
+    }
+
+    xSemaphoreGive(cacheMutex);
+}
+
+void BlockCache::invalidateAll() {
+    if (!cacheMutex || xSemaphoreTake(cacheMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    for (int i = 0; i < FS_CACHE_FILES; i++) {
+        if (files[i].valid) {
+            dropFileLocked(i);
+            invalidations++;
+        }
+    }
+
+    xSemaphoreGive(cacheMutex);
+}
+
+void BlockCache::printStatistics() {
+    uint32_t lookups = hits + misses;
+    uint32_t metaLookups = metaHits + metaMisses;
+    int cachedBlocks = 0;
+    int cachedFiles = 0;
+    for (int i = 0; i < FS_CACHE_BLOCKS; i++) {
+        cachedBlocks += blocks[i].valid ? 1 : 0;
+    }
+    for (int i = 0; i < FS_CACHE_FILES; i++) {
+        cachedFiles += files[i].valid ? 1 : 0;
+    }
+
+    Serial.println("Block Cache:");
+    Serial.printf("Blocks:          %d/%d x %d bytes\n", cachedBlocks, FS_CACHE_BLOCKS, FS_BLOCK_SIZE);
+    Serial.printf("Files:           %d/%d\n", cachedFiles, FS_CACHE_FILES);
+    Serial.printf("Block hits:      %u (%.1f%%)\n", hits, lookups ? hits * 100.0 / lookups : 0.0);
+    Serial.printf("Block misses:    %u\n", misses);
+    Serial.printf("Read-ahead:      %u blocks\n", readAhead);
+    Serial.printf("Metadata hits:   %u (%.1f%%)\n", metaHits,
+                  metaLookups ? metaHits * 100.0 / metaLookups : 0.0);
+    Serial.printf("Evictions:       %u\n", evictions);
+    Serial.printf("Invalidations:   %u\n", invalidations);
+}
+
+void BlockCache::resetStatistics() {
+    hits = 0;
+    misses = 0;
+    readAhead = 0;
+    evictions = 0;
+    invalidations = 0;
+    metaHits = 0;
+    metaMisses = 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * ESP32-OS Block Cache Header
+ * LRU cache of file pages and metadata in front of the flash file system
+ */
+
+#ifndef BLOCKCACHE_H
+#define BLOCKCACHE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "FS.h"
+#include "../config/config.h"
+#include "../kernel/metrics.h"
+
+#define CACHE_NO_BLOCK 0xFFFFFFFF
+
+struct CachedFile {
+    char path[FS_MAX_PATH_LENGTH];
+    uint32_t pathHash;
+    bool valid;
+    bool exists;                // Negative lookups are cached too
+    bool isDirectory;
+    size_t size;
+    time_t lastWrite;
+    uint32_t lastUsed;
+    uint32_t lastBlock;         // Last block read, for read-ahead
+};
+
+struct CacheBlock {
+    uint8_t file;               // Index into the file table
+    bool valid;
+    uint16_t length;            // Short for the file's last block
+    uint32_t index;             // Block number within the file
+    uint32_t lastUsed;
+};
+
+struct CacheStat {
+    bool exists;
+    bool isDirectory;
+    size_t size;
+    time_t lastWrite;
+};
+
+// Only sees changes made through FileSystem; writers must invalidate
+class BlockCache {
+private:
+    fs::FS* volume;
+    uint8_t* data;              // FS_CACHE_BLOCKS * FS_BLOCK_SIZE
+    CacheBlock blocks[FS_CACHE_BLOCKS];
+    CachedFile files[FS_CACHE_FILES];
+    SemaphoreHandle_t cacheMutex;
+    uint32_t clock;             // LRU timestamp source
+
+    // Statistics
+    Metric* hitCounter;
+    Metric* missCounter;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t readAhead;
+    uint32_t evictions;
+    uint32_t invalidations;
+    uint32_t metaHits;
+    uint32_t metaMisses;
+
+    int lookupFileLocked(const char* path, uint32_t hash);
+    int loadFileLocked(const char* path);
+    void dropFileLocked(int file);
+    int findBlockLocked(int file, uint32_t index);
+    int victimBlockLocked();
+    bool fillLocked(int file, File& handle, uint32_t first, uint32_t count);
+
+public:
+    BlockCache();
+    ~BlockCache();
+
+    bool init(fs::FS* volume);
+    void shutdown();
+    void setVolume(fs::FS* volume);
+    void registerMetrics(MetricsRegistry* registry);
+
+    bool stat(const char* path, CacheStat& out);
+    // Returns bytes copied; short at end of file, 0 if the file is missing
+    size_t read(const char* path, size_t offset, uint8_t* buffer, size_t length);
+
+    void invalidate(const char* path);
+    void invalidatePrefix(const char* prefix);
+    void invalidateAll();
+
+    void printStatistics();
+    void resetStatistics();
+};
+
+#endif // BLOCKCACHE_H
@@ -4,11 +4,29 @@
 
 #include "fs.h"
 #include "FS.h"
-#include "SPIFFS.h"
-#define FORMAT_SPIFFS_IF_FAILED true
+#include "../kernel/kernel.h"
+#include "../kernel/checksum.h"
+#include <esp_heap_caps.h>
 using namespace fs;
-FileSystem::FileSystem() : initialized(false), mounted(false), 
-                          totalBytes(0), usedBytes(0) {
+FileSystem::FileSystem() : initialized(false), mounted(false), backend(nullptr), volume(nullptr),
+                          totalBytes(0), usedBytes(0), fullSignalled(false),
+                          usageLock(portMUX_INITIALIZER_UNLOCKED),
+                          reconcileQueued(false), usageQueries(0), lastDrift(0),
+                          codecMutex(nullptr), codecWorkspace(nullptr), frameRaw(nullptr),
+                          framePacked(nullptr), frameDecoded(nullptr), writeGeneration(0),
+                          decodedGeneration(0), decodedStart(0), decodedPhysical(0), decodedLength(0),
+                          compressedRaw(0), compressedStored(0),
+                          atomicWrites(FS_ATOMIC_WRITES), recoveredWrites(0),
+                          replacesInFlight(0), replaceLeftovers(false), warmSaved(false),
+                          readOps(nullptr), writeOps(nullptr), bytesRead(nullptr),
+                          bytesWritten(nullptr), usedGauge(nullptr), totalGauge(nullptr) {
+    TimerService::setup(&usageTimer, onUsageTimer, this);
+    memset(compressDirs, 0, sizeof(compressDirs));
+    memset(replaceLocks, 0, sizeof(replaceLocks));
+    decodedPath[0] = '\0';
+    if (FS_COMPRESS_DEFAULT_DIR[0]) {
+        setCompression(FS_COMPRESS_DEFAULT_DIR, true);
+    }
 }
 
 FileSystem::~FileSystem() {
@@ -19,48 +37,237 @@ bool FileSystem::init() {
     if (initialized) {
         return true;
     }
-    // check if the disk is formatted
-    if (!SPIFFS.begin(FORMAT_SPIFFS_IF_FAILED)) {
-        Serial.println("FileSystem: Failed to initialize SPIFFS");
+    if (!kernel || !kernel->getMountTable()) {
+        Serial.println("FileSystem: Mount table not available");
+        return false;
+    }
+    
+    // Mounted here on first use; the mount table shares the handle
+    backend = vfsActive();
+    volume = kernel->getMountTable()->mount(backend->name);
+    if (!volume) {
+        Serial.printf("FileSystem: Failed to mount %s\n", backend->name);
+        return false;
+    }
+    
+    if (!cache.init(volume)) {
+        Serial.println("FileSystem: Failed to initialize block cache");
         return false;
     }
     
-    // Initialize SPIFFS
-    if (!SPIFFS.begin(true)) { // Format if mount fails
-        Serial.println("FileSystem: Failed to mount SPIFFS");
+    // One flash walk now instead of one per listing or directory operation
+    if (!index.init()) {
+        Serial.println("FileSystem: Failed to initialize path index");
+        return false;
+    }
+    codecMutex = xSemaphoreCreateMutex();
+    if (!codecMutex) {
+        Serial.println("FileSystem: Failed to create codec mutex");
         return false;
     }
+    for (int i = 0; i < FS_REPLACE_LOCKS; i++) {
+        replaceLocks[i] = xSemaphoreCreateMutex();
+        if (!replaceLocks[i]) {
+            Serial.println("FileSystem: Failed to create replace locks");
+            return false;
+        }
+    }
+    
+    if (index.build(volume, backend->realDirectories)) {
+        Serial.printf("FileSystem: Indexed %u paths in %u ms\n",
+                      (unsigned)index.getCount(), index.getBuildMs());
+    }
+    // Before anything reads a file a reset may have left half replaced.
+    // Finds them through the index, and keeps it in step. A warm restart
+    // from a quiet file system left nothing to recover, and the usage it
+    // recorded is exact.
+    WarmBoot* warm = kernel->getWarmBoot();
+    bool clean = warm && warm->isWarm() && warm->getRecord().fsClean;
+    if (!clean) {
+        recoverReplaces();
+    }
     
     mounted = true;
-    updateStatistics();
+    registerMetrics();
+    if (clean) {
+        totalBytes = warm->getRecord().fsTotalBytes;
+        usedBytes = warm->getRecord().fsUsedBytes;
+        publishUsage();
+        Serial.println("FileSystem: Clean warm restart, skipped recovery and usage query");
+    } else {
+        updateStatistics();
+    }
     
     initialized = true;
-    Serial.println("FileSystem: SPIFFS mounted successfully");
+    Serial.printf("FileSystem: %s mounted successfully\n", backend->name);
     Serial.printf("FileSystem: Total: %zu bytes, Used: %zu bytes, Free: %zu bytes\n",
                   totalBytes, usedBytes, getFreeBytes());
     
     return true;
 }
 
+void FileSystem::registerMetrics() {
+    MetricsRegistry* registry = kernel ? kernel->getMetrics() : nullptr;
+    if (!registry) {
+        return;
+    }
+    
+    readOps = registry->registerCounter("fs_read_ops_total");
+    writeOps = registry->registerCounter("fs_write_ops_total");
+    bytesRead = registry->registerCounter("fs_read_bytes_total");
+    bytesWritten = registry->registerCounter("fs_written_bytes_total");
+    usedGauge = registry->registerGauge("fs_used_bytes");
+    totalGauge = registry->registerGauge("fs_total_bytes");
+    cache.registerMetrics(registry);
+}
+
 void FileSystem::shutdown() {
+    if (kernel && kernel->getTimerService()) {
+        kernel->getTimerService()->cancel(&usageTimer);
+    }
     if (mounted) {
-        SPIFFS.end();
+        if (kernel && kernel->getMountTable()) {
+            kernel->getMountTable()->unmount(backend->name);
+        }
+        volume = nullptr;
         mounted = false;
     }
+    cache.shutdown();
+    index.shutdown();
+    if (codecMutex) {
+        vSemaphoreDelete(codecMutex);
+        codecMutex = nullptr;
+    }
+    for (int i = 0; i < FS_REPLACE_LOCKS; i++) {
+        if (replaceLocks[i]) {
+            vSemaphoreDelete(replaceLocks[i]);
+            replaceLocks[i] = nullptr;
+        }
+    }
+    free(codecWorkspace);
+    free(frameRaw);
+    free(framePacked);
+    free(frameDecoded);
+    codecWorkspace = nullptr;
+    frameRaw = framePacked = frameDecoded = nullptr;
+    decodedLength = 0;
     initialized = false;
 }
 
+void FileSystem::noteWritten(const char* path, uint32_t size) {
+    uint32_t before = 0;
+    bool known = size != PATH_SIZE_UNKNOWN && previousFootprint(path, before);
+    index.upsert(path, size, time(nullptr));
+    cache.invalidate(path);
+    writeGeneration++;
+    adjustUsage(known ? (int32_t)footprint(size) - (int32_t)before : 0, known);
+}
+
+void FileSystem::noteRemoved(const char* path) {
+    uint32_t before = 0;
+    bool known = previousFootprint(path, before);
+    index.remove(path);
+    cache.invalidate(path);
+    writeGeneration++;
+    adjustUsage(-(int32_t)before, known);
+}
+
+// Data rounded up to the allocation unit, plus one unit of metadata
+uint32_t FileSystem::footprint(uint32_t size) const {
+    uint32_t unit = backend->allocationUnit;
+    return ((size + unit - 1) / unit + 1) * unit;
+}
+
+// False when the file's current size is not known to the index
+bool FileSystem::previousFootprint(const char* path, uint32_t& bytes) {
+    PathEntry entry;
+    if (index.lookup(path, entry)) {
+        if (entry.size == PATH_SIZE_UNKNOWN) {
+            return false;
+        }
+        bytes = footprint(entry.size);
+        return true;
+    }
+    bytes = 0;
+    return index.isValid();     // Absent from a complete index: a new file
+}
+
+void FileSystem::adjustUsage(int32_t delta, bool known) {
+    warmStateChanged();
+    
+    // Unknown changes leave the estimate alone until the next real query
+    if (known) {
+        portENTER_CRITICAL(&usageLock);
+        if (delta < 0 && (size_t)-delta > usedBytes) {
+            usedBytes = 0;
+        } else {
+            usedBytes += delta;
+            if (usedBytes > totalBytes) {
+                usedBytes = totalBytes;
+            }
+        }
+        portEXIT_CRITICAL(&usageLock);
+    }
+    
+    publishUsage();
+    
+    // One real query per quiet period, however many writes came before it;
+    // restarting re-arms the pending timer so the query waits for the last change
+    TimerService* timers = kernel ? kernel->getTimerService() : nullptr;
+    if (timers) {
+        timers->start(&usageTimer, FS_USAGE_RECONCILE_MS);
+    }
+}
+
+// Checked after the change is counted, and prepareWarmReboot checks the
+// counts after setting warmSaved, so no change goes unseen by both
+void FileSystem::warmStateChanged() {
+    if (warmSaved.load() && kernel && kernel->getWarmBoot()) {
+        kernel->getWarmBoot()->markFsDirty();
+    }
+}
+
+bool FileSystem::prepareWarmReboot(uint32_t& total, uint32_t& used) {
+    warmSaved.store(true);
+    if (!initialized || replacesInFlight.load() > 0 || replaceLeftovers.load() ||
+        reconcileQueued.load() || TimerService::isPending(&usageTimer)) {
+        return false;
+    }
+    total = totalBytes;
+    used = usedBytes;
+    return true;
+}
+
+// Timer service context: the backend query runs on the work queue
+void FileSystem::onUsageTimer(void* arg) {
+    FileSystem* fs = (FileSystem*)arg;
+    WorkQueue* workQueue = kernel ? kernel->getWorkQueue() : nullptr;
+    if (!workQueue || fs->reconcileQueued.exchange(true)) {
+        return;
+    }
+    if (!workQueue->post(reconcileUsage, fs, WORK_PRIO_LOW)) {
+        fs->reconcileQueued.store(false);
+    }
+}
+
+void FileSystem::reconcileUsage(void* arg) {
+    FileSystem* fs = (FileSystem*)arg;
+    fs->updateStatistics();
+    fs->reconcileQueued.store(false);
+}
+
 bool FileSystem::createFile(const char* path) {
     if (!initialized || !path) {
         return false;
     }
-    File file = SPIFFS.open(path, "w");
+    File file = volume->open(path, "w", true);
     if (!file) {
+        cache.invalidate(path);
         return false;
     }
     
     file.close();
-    updateStatistics();
+    noteWritten(path, 0);
     return true;
 }
 
@@ -69,9 +276,11 @@ bool FileSystem::deleteFile(const char* path) {
         return false;
     }
     
-    bool result = SPIFFS.remove(path);
+    bool result = volume->remove(path);
     if (result) {
-        updateStatistics();
+        noteRemoved(path);
+    } else {
+        cache.invalidate(path);
     }
     return result;
 }
@@ -81,7 +290,12 @@ bool FileSystem::fileExists(const char* path) {
         return false;
     }
     
-    return SPIFFS.exists(path);
+    if (index.isValid()) {
+        return index.contains(path);
+    }
+    
+    CacheStat stat;
+    return cache.stat(path, stat) && stat.exists;
 }
 
 bool FileSystem::renameFile(const char* oldPath, const char* newPath) {
@@ -89,7 +303,14 @@ bool FileSystem::renameFile(const char* oldPath, const char* newPath) {
         return false;
     }
     
-    return SPIFFS.rename(oldPath, newPath);
+    bool result = volume->rename(oldPath, newPath);
+    if (result) {
+        index.rename(oldPath, newPath);
+    }
+    cache.invalidate(oldPath);
+    cache.invalidate(newPath);
+    writeGeneration++;
+    return result;
 }
 
 bool FileSystem::createDirectory(const char* path) {
@@ -97,6 +318,15 @@ bool FileSystem::createDirectory(const char* path) {
         return false;
     }
     
+    if (backend->realDirectories) {
+        bool result = volume->mkdir(path);
+        if (result) {
+            index.upsertDirectory(path, time(nullptr));
+        }
+        cache.invalidate(path);
+        return result;
+    }
+    
     // SPIFFS doesn't have real directories, but we can simulate by creating
     // a placeholder file
     String dirMarker = String(path) + "/.dir";
@@ -108,18 +338,37 @@ bool FileSystem::deleteDirectory(const char* path) {
         return false;
     }
     
+    String prefix = String(path) + "/";
+    if (backend->realDirectories) {
+        bool result = removeTree(path);
+        cache.invalidatePrefix(prefix.c_str());
+        adjustUsage(0, false);  // Directory metadata is not estimated
+        return result;
+    }
+    
+    if (index.isValid()) {
+        std::vector<std::string> paths;
+        index.collectPrefix(prefix.c_str(), paths);
+        for (size_t i = 0; i < paths.size(); i++) {
+            if (volume->remove(paths[i].c_str())) {
+                noteRemoved(paths[i].c_str());
+            }
+        }
+        return true;
+    }
+    
     // Delete all files in the directory
-    File root = SPIFFS.open("/");
+    File root = volume->open("/");
     if (!root || !root.isDirectory()) {
         return false;
     }
     
     File file = root.openNextFile();
     while (file) {
-        String fileName = file.name();
-        if (fileName.startsWith(path)) {
+        String fileName = file.path();
+        if (fileName.startsWith(prefix)) {
             file.close();
-            SPIFFS.remove(fileName.c_str());
+            volume->remove(fileName.c_str());
         } else {
             file.close();
         }
@@ -127,15 +376,72 @@ bool FileSystem::deleteDirectory(const char* path) {
     }
     
     root.close();
-    updateStatistics();
+    cache.invalidatePrefix(path);
+    writeGeneration++;
+    adjustUsage(0, false);
     return true;
 }
 
+// Entries are collected first; removing while a directory is open for
+// iteration is not safe on LittleFS
+bool FileSystem::removeTree(const char* dir) {
+    std::vector<std::string> files;
+    std::vector<std::string> dirs;
+    
+    File root = volume->open(dir);
+    if (!root || !root.isDirectory()) {
+        return false;
+    }
+    File entry = root.openNextFile();
+    while (entry) {
+        if (entry.isDirectory()) {
+            dirs.push_back(entry.path());
+        } else {
+            files.push_back(entry.path());
+        }
+        entry.close();
+        entry = root.openNextFile();
+    }
+    root.close();
+    
+    for (size_t i = 0; i < files.size(); i++) {
+        volume->remove(files[i].c_str());
+        noteRemoved(files[i].c_str());
+    }
+    for (size_t i = 0; i < dirs.size(); i++) {
+        removeTree(dirs[i].c_str());
+    }
+    bool result = volume->rmdir(dir);
+    if (result) {
+        index.remove(dir);
+    }
+    cache.invalidate(dir);
+    return result;
+}
+
 bool FileSystem::directoryExists(const char* path) {
     if (!initialized || !path) {
         return false;
     }
     
+    // Any file below the path, marker or not, makes a simulated directory
+    if (index.isValid()) {
+        if (strcmp(path, "/") == 0) {
+            return true;
+        }
+        return backend->realDirectories ? index.isDirectory(path)
+                                        : index.hasPrefix((String(path) + "/").c_str());
+    }
+    
+    // Opening a missing path makes LittleFS log an error
+    if (backend->realDirectories) {
+        if (!volume->exists(path)) {
+            return false;
+        }
+        File dir = volume->open(path);
+        return dir && dir.isDirectory();
+    }
+    
     String dirMarker = String(path) + "/.dir";
     return fileExists(dirMarker.c_str());
 }
@@ -145,24 +451,50 @@ File FileSystem::openFile(const char* path, const char* mode) {
         return File();
     }
     
-    return SPIFFS.open(path, mode);
+    // Writes through the raw handle bypass the cache; drop what it holds now
+    File file = volume->open(path, mode, strcmp(mode, "r") != 0);
+    if (strcmp(mode, "r") != 0) {
+        if (file) {
+            noteWritten(path, PATH_SIZE_UNKNOWN);
+        } else {
+            cache.invalidate(path);
+        }
+    }
+    return file;
+}
+
+void FileSystem::closeFile(File& file, const char* path) {
+    if (!file) {
+        return;
+    }
+    file.close();
+    
+    // Anything cached while the handle was open may predate its writes
+    if (initialized && path) {
+        noteWritten(path, PATH_SIZE_UNKNOWN);
+    }
 }
 
 bool FileSystem::writeFile(const char* path, const char* data) {
     if (!initialized || !path || !data) {
         return false;
     }
+    if (compressedDir(path)) {
+        return writeFile(path, (const uint8_t*)data, strlen(data));
+    }
     
-    File file = SPIFFS.open(path, "w");
+    char temp[FS_MAX_PATH_LENGTH];
+    File file = beginReplace(path, temp);
     if (!file) {
         return false;
     }
     
     size_t bytesWritten = file.print(data);
-    file.close();
+    bool committed = finishReplace(file, path, temp, bytesWritten == strlen(data));
     
-    updateStatistics();
-    return bytesWritten > 0;
+    MetricsRegistry::increment(writeOps);
+    MetricsRegistry::increment(this->bytesWritten, bytesWritten);
+    return committed && bytesWritten > 0;
 }
 
 bool FileSystem::writeFile(const char* path, const uint8_t* data, size_t length) {
@@ -170,16 +502,23 @@ bool FileSystem::writeFile(const char* path, const uint8_t* data, size_t length)
         return false;
     }
     
-    File file = SPIFFS.open(path, "w");
+    char temp[FS_MAX_PATH_LENGTH];
+    File file = beginReplace(path, temp);
     if (!file) {
         return false;
     }
     
-    size_t bytesWritten = file.write(data, length);
-    file.close();
+    size_t bytesWritten;
+    if (compressedDir(path)) {
+        bytesWritten = writeCompressed(file, &data, &length, 1) ? length : 0;
+    } else {
+        bytesWritten = file.write(data, length);
+    }
+    bool committed = finishReplace(file, path, temp, bytesWritten == length);
     
-    updateStatistics();
-    return bytesWritten == length;
+    MetricsRegistry::increment(writeOps);
+    MetricsRegistry::increment(this->bytesWritten, bytesWritten);
+    return committed;
 }
 
 bool FileSystem::readFile(const char* path, String& content) {
@@ -187,51 +526,620 @@ bool FileSystem::readFile(const char* path, String& content) {
         return false;
     }
     
-    File file = SPIFFS.open(path, "r");
-    if (!file) {
+    CacheStat stat;
+    if (!cache.stat(path, stat) || !stat.exists || stat.isDirectory) {
+        return false;
+    }
+    bool compressed = isCompressedFile(path);
+    size_t size = compressed ? compressedSize(path) : stat.size;
+    
+    // The whole file lands on the heap; refuse before it can starve the system
+    if (size > FS_STRING_READ_MAX ||
+        heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) < size + FS_STRING_HEAP_RESERVE) {
+        Serial.printf("FileSystem: %s too large for a String read (%u bytes)\n",
+                      path, (unsigned)size);
         return false;
     }
     
-    content = file.readString();
+    // One allocation of the final size, filled from a small stack chunk
+    content = "";
+    if (!content.reserve(size)) {
+        return false;
+    }
+    
+    // concat(buffer, length) copies up to a terminator on some cores;
+    // the spare byte keeps every chunk terminated
+    uint8_t chunk[FS_STRING_CHUNK + 1];
+    size_t length = 0;
+    while (length < size) {
+        size_t wanted = size - length < FS_STRING_CHUNK ? size - length : FS_STRING_CHUNK;
+        size_t got = readLogical(path, length, chunk, wanted, compressed);
+        if (got == 0) {
+            break;
+        }
+        chunk[got] = '\0';
+        content.concat((const char*)chunk, got);
+        length += got;
+    }
+    
+    MetricsRegistry::increment(readOps);
+    MetricsRegistry::increment(bytesRead, length);
+    
+    return length == size;
+}
+
+size_t FileSystem::read(const char* path, size_t offset, uint8_t* buffer, size_t length) {
+    if (!initialized || !path || !buffer) {
+        return 0;
+    }
+    
+    size_t copied = readLogical(path, offset, buffer, length, isCompressedFile(path));
+    
+    MetricsRegistry::increment(readOps);
+    MetricsRegistry::increment(bytesRead, copied);
+    return copied;
+}
+
+size_t FileSystem::readInto(const char* path, ByteSpan span, size_t offset) {
+    if (!initialized || !path || !span.data || span.length == 0) {
+        return 0;
+    }
+    
+    // Small reads share cached blocks; large ones would only evict them.
+    // Compressed files always go through the decoder.
+    if (span.length < FS_DIRECT_READ_MIN || isCompressedFile(path)) {
+        return read(path, offset, span.data, span.length);
+    }
+    
+    File file = volume->open(path, "r");
+    if (!file || file.isDirectory() || !file.seek(offset)) {
+        return 0;
+    }
+    size_t copied = file.read(span.data, span.length);
     file.close();
     
-    return true;
+    MetricsRegistry::increment(readOps);
+    MetricsRegistry::increment(bytesRead, copied);
+    return copied;
+}
+
+bool FileSystem::readChunks(const char* path, ByteSpan buffer, ChunkVisitor_t visitor, void* context) {
+    if (!initialized || !path || !buffer.data || buffer.length == 0 || !visitor) {
+        return false;
+    }
+    
+    CacheStat stat;
+    if (!cache.stat(path, stat) || !stat.exists || stat.isDirectory) {
+        return false;
+    }
+    
+    bool compressed = isCompressedFile(path);
+    size_t size = compressed ? compressedSize(path) : stat.size;
+    
+    // Large buffers keep one handle open for the whole pass
+    File file;
+    if (buffer.length >= FS_DIRECT_READ_MIN && !compressed) {
+        file = volume->open(path, "r");
+        if (!file) {
+            return false;
+        }
+    }
+    
+    size_t offset = 0;
+    bool completed = true;
+    while (offset < size) {
+        size_t got = file ? file.read(buffer.data, buffer.length)
+                          : readLogical(path, offset, buffer.data, buffer.length, compressed);
+        if (got == 0) {
+            completed = false;
+            break;
+        }
+        MetricsRegistry::increment(bytesRead, got);
+        if (!visitor(buffer.data, got, offset, context)) {
+            break;
+        }
+        offset += got;
+    }
+    
+    if (file) {
+        file.close();
+    }
+    MetricsRegistry::increment(readOps);
+    return completed;
+}
+
+bool FileSystem::writeChunks(const char* path, ByteSpan buffer, ChunkProducer_t producer, void* context,
+                             bool append) {
+    if (!initialized || !path || !buffer.data || buffer.length == 0 || !producer) {
+        return false;
+    }
+    
+    bool compressed = append ? appendsCompressed(path) : compressedDir(path);
+    char temp[FS_MAX_PATH_LENGTH];
+    File file = append ? volume->open(path, "a", true) : beginReplace(path, temp);
+    if (!file) {
+        return false;
+    }
+    
+    size_t total = 0;
+    bool completed = true;
+    size_t produced;
+    while ((produced = producer(buffer.data, buffer.length, context)) > 0) {
+        const uint8_t* part = buffer.data;
+        bool written = produced <= buffer.length &&
+                       (compressed ? writeCompressed(file, &part, &produced, 1)
+                                   : file.write(buffer.data, produced) == produced);
+        if (!written) {
+            completed = false;
+            break;
+        }
+        total += produced;
+    }
+    
+    if (append) {
+        uint32_t size = file.size();
+        file.close();
+        noteWritten(path, size);
+    } else {
+        completed = finishReplace(file, path, temp, completed);
+    }
+    
+    MetricsRegistry::increment(writeOps);
+    MetricsRegistry::increment(this->bytesWritten, total);
+    return completed;
 }
 
 bool FileSystem::appendFile(const char* path, const char* data) {
     if (!initialized || !path || !data) {
         return false;
     }
+    if (appendsCompressed(path)) {
+        const uint8_t* part = (const uint8_t*)data;
+        size_t length = strlen(data);
+        return length > 0 && appendFile(path, &part, &length, 1);
+    }
     
-    File file = SPIFFS.open(path, "a");
+    File file = volume->open(path, "a", true);
     if (!file) {
         return false;
     }
     
     size_t bytesWritten = file.print(data);
+    uint32_t size = file.size();
     file.close();
+    noteWritten(path, size);
     
-    updateStatistics();
+    MetricsRegistry::increment(writeOps);
+    MetricsRegistry::increment(this->bytesWritten, bytesWritten);
     return bytesWritten > 0;
 }
 
+bool FileSystem::appendFile(const char* path, const uint8_t* const* parts, const size_t* lengths,
+                            size_t count) {
+    if (!initialized || !path || !parts || !lengths || count == 0) {
+        return false;
+    }
+    
+    bool compressed = appendsCompressed(path);
+    File file = volume->open(path, "a", true);
+    if (!file) {
+        return false;
+    }
+    
+    size_t total = 0;
+    bool complete = true;
+    if (compressed) {
+        complete = writeCompressed(file, parts, lengths, count);
+        for (size_t i = 0; complete && i < count; i++) {
+            total += lengths[i];
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            size_t written = file.write(parts[i], lengths[i]);
+            total += written;
+            complete = complete && written == lengths[i];
+        }
+    }
+    uint32_t size = file.size();
+    file.close();
+    noteWritten(path, size);
+    
+    MetricsRegistry::increment(writeOps);
+    MetricsRegistry::increment(this->bytesWritten, total);
+    return complete;
+}
+
+// Replacing writes go to a temp file beside the target; a name with no
+// room for the tag, here or in the backend, is written in place
+File FileSystem::beginReplace(const char* path, char* temp) {
+    if (!atomicWrites || !vfsReplaceName(backend, path, VFS_TEMP_KIND, temp, FS_MAX_PATH_LENGTH)) {
+        temp[0] = '\0';
+        return volume->open(path, "w", true);
+    }
+    xSemaphoreTake(replaceLock(path), portMAX_DELAY);
+    replacesInFlight++;
+    warmStateChanged();
+    File file = volume->open(temp, "w", true);
+    if (!file) {
+        replacesInFlight--;
+        xSemaphoreGive(replaceLock(path));
+    }
+    return file;
+}
+
+SemaphoreHandle_t FileSystem::replaceLock(const char* path) {
+    return replaceLocks[fnv1a(path, strlen(path)) % FS_REPLACE_LOCKS];
+}
+
+// Closes a replacing write and moves it into place. An incomplete temp is
+// dropped, leaving the old file as it was.
+bool FileSystem::finishReplace(File& file, const char* path, const char* temp, bool complete) {
+    file.flush();
+    uint32_t size = file.size();
+    file.close();
+    
+    if (!temp[0]) {
+        noteWritten(path, size);
+        return complete;
+    }
+    if (!complete) {
+        volume->remove(temp);
+        replacesInFlight--;
+        xSemaphoreGive(replaceLock(path));
+        return false;
+    }
+    bool replaced = vfsReplace(volume, backend, temp, path);
+    replacesInFlight--;
+    if (!replaced) {
+        // A commit file left behind is finished by the next mount
+        replaceLeftovers.store(true);
+        Serial.printf("FileSystem: Failed to replace %s\n", path);
+        if (volume->exists(temp)) {
+            volume->remove(temp);
+        }
+        if (volume->exists(path)) {
+            noteWritten(path, PATH_SIZE_UNKNOWN);
+        } else {
+            noteRemoved(path);
+        }
+        xSemaphoreGive(replaceLock(path));
+        return false;
+    }
+    noteWritten(path, size);
+    xSemaphoreGive(replaceLock(path));
+    return true;
+}
+
+void FileSystem::collectReplace(const PathEntry& entry, void* context) {
+    char target[FS_MAX_PATH_LENGTH];
+    char kind;
+    if (!entry.isDirectory && vfsReplaceTarget(entry.path, target, sizeof(target), kind)) {
+        ((std::vector<std::string>*)context)->push_back(entry.path);
+    }
+}
+
+// Flash walk for when the path index is disabled
+void FileSystem::collectReplaces(const char* dir, std::vector<std::string>& out) {
+    std::vector<std::string> dirs;
+    
+    File root = volume->open(dir);
+    if (!root || !root.isDirectory()) {
+        return;
+    }
+    char target[FS_MAX_PATH_LENGTH];
+    char kind;
+    File entry = root.openNextFile();
+    while (entry) {
+        const char* path = entry.path();
+        if (entry.isDirectory()) {
+            dirs.push_back(path);
+        } else if (vfsReplaceTarget(path, target, sizeof(target), kind)) {
+            out.push_back(path);
+        }
+        entry.close();
+        entry = root.openNextFile();
+    }
+    root.close();
+    
+    for (size_t i = 0; i < dirs.size(); i++) {
+        collectReplaces(dirs[i].c_str(), out);
+    }
+}
+
+// A temp file was never finished and is dropped. A commit file is
+// complete and replaces whatever is at its target.
+void FileSystem::recoverReplaces() {
+    std::vector<std::string> found;
+    if (index.isValid()) {
+        index.forEachPrefix("/", collectReplace, &found);
+    } else {
+        collectReplaces("/", found);
+    }
+    
+    char target[FS_MAX_PATH_LENGTH];
+    char kind;
+    for (size_t i = 0; i < found.size(); i++) {
+        const char* path = found[i].c_str();
+        if (!vfsReplaceTarget(path, target, sizeof(target), kind)) {
+            continue;
+        }
+        if (kind == VFS_TEMP_KIND) {
+            volume->remove(path);
+            index.remove(path);
+        } else {
+            if (volume->exists(target) && volume->remove(target)) {
+                index.remove(target);
+            }
+            if (!volume->rename(path, target)) {
+                Serial.printf("FileSystem: Failed to recover %s\n", target);
+                continue;
+            }
+            index.rename(path, target);
+        }
+        recoveredWrites++;
+    }
+    
+    if (recoveredWrites > 0) {
+        Serial.printf("FileSystem: Recovered %u interrupted writes\n", recoveredWrites);
+    }
+}
+
+bool FileSystem::setCompression(const char* dirPrefix, bool enabled) {
+    if (!dirPrefix || !dirPrefix[0]) {
+        return false;
+    }
+    
+    // Stored as "/dir/" so "/logs/" never matches "/logsold/x"
+    char prefix[FS_MAX_PATH_LENGTH];
+    size_t length = strlen(dirPrefix);
+    int written = snprintf(prefix, sizeof(prefix), "%s%s%s", dirPrefix[0] == '/' ? "" : "/",
+                           dirPrefix, dirPrefix[length - 1] == '/' ? "" : "/");
+    if (written < 0 || (size_t)written >= sizeof(prefix)) {
+        return false;
+    }
+    
+    int freeSlot = -1;
+    for (int i = 0; i < FS_COMPRESS_DIRS; i++) {
+        if (strcmp(compressDirs[i], prefix) == 0) {
+            if (!enabled) {
+                compressDirs[i][0] = '\0';
+            }
+            return true;
+        }
+        if (!compressDirs[i][0] && freeSlot < 0) {
+            freeSlot = i;
+        }
+    }
+    if (!enabled) {
+        return true;
+    }
+    if (freeSlot < 0) {
+        return false;
+    }
+    strcpy(compressDirs[freeSlot], prefix);
+    return true;
+}
+
+bool FileSystem::compressedDir(const char* path) {
+    for (int i = 0; i < FS_COMPRESS_DIRS; i++) {
+        if (compressDirs[i][0] && strncmp(path, compressDirs[i], strlen(compressDirs[i])) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// An existing file keeps its format; only new or empty files follow the setting
+bool FileSystem::appendsCompressed(const char* path) {
+    uint32_t magic = 0;
+    size_t got = cache.read(path, 0, (uint8_t*)&magic, sizeof(magic));
+    if (got == sizeof(magic)) {
+        return magic == FS_COMPRESS_MAGIC;
+    }
+    return got == 0 && compressedDir(path);
+}
+
+bool FileSystem::isCompressedFile(const char* path) {
+    uint32_t magic = 0;
+    return cache.read(path, 0, (uint8_t*)&magic, sizeof(magic)) == sizeof(magic) &&
+           magic == FS_COMPRESS_MAGIC;
+}
+
+// Sum of the frame headers' raw lengths; touches only the headers
+size_t FileSystem::compressedSize(const char* path) {
+    size_t size = 0;
+    size_t physical = sizeof(uint32_t);
+    uint8_t header[FS_FRAME_HEADER];
+    while (cache.read(path, physical, header, sizeof(header)) == sizeof(header)) {
+        size_t stored = (header[0] | (header[1] << 8)) & ~FS_FRAME_STORED;
+        size += header[2] | (header[3] << 8);
+        physical += FS_FRAME_HEADER + stored;
+    }
+    return size;
+}
+
+bool FileSystem::codecReadyLocked() {
+    if (!codecWorkspace) {
+        codecWorkspace = (LzssWorkspace*)malloc(sizeof(LzssWorkspace));
+    }
+    if (!frameRaw) {
+        frameRaw = (uint8_t*)malloc(FS_COMPRESS_FRAME_SIZE);
+    }
+    if (!framePacked) {
+        framePacked = (uint8_t*)malloc(FS_FRAME_HEADER + FS_COMPRESS_FRAME_SIZE);
+    }
+    if (!frameDecoded) {
+        frameDecoded = (uint8_t*)malloc(FS_COMPRESS_FRAME_SIZE);
+    }
+    if (!codecWorkspace || !frameRaw || !framePacked || !frameDecoded) {
+        Serial.println("FileSystem: Out of memory for compression buffers");
+        return false;
+    }
+    return true;
+}
+
+// Writes frameRaw[0..length) as one frame, raw if compression does not shrink it
+bool FileSystem::emitFrameLocked(File& file, size_t length) {
+    uint8_t* payload = framePacked + FS_FRAME_HEADER;
+    size_t stored = lzssCompress(frameRaw, length, payload, length - 1, codecWorkspace);
+    uint16_t storedField = (uint16_t)stored;
+    if (stored == 0) {
+        memcpy(payload, frameRaw, length);
+        stored = length;
+        storedField = (uint16_t)(length | FS_FRAME_STORED);
+    }
+    
+    framePacked[0] = storedField & 0xFF;
+    framePacked[1] = storedField >> 8;
+    framePacked[2] = length & 0xFF;
+    framePacked[3] = length >> 8;
+    
+    size_t total = FS_FRAME_HEADER + stored;
+    compressedRaw += length;
+    compressedStored += total;
+    return file.write(framePacked, total) == total;
+}
+
+// Appends the parts to an open file as whole frames
+bool FileSystem::writeCompressed(File& file, const uint8_t* const* parts, const size_t* lengths,
+                                 size_t count) {
+    if (!codecMutex || xSemaphoreTake(codecMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+    
+    bool ok = codecReadyLocked();
+    if (ok && file.size() == 0) {
+        uint32_t magic = FS_COMPRESS_MAGIC;
+        ok = file.write((const uint8_t*)&magic, sizeof(magic)) == sizeof(magic);
+        compressedStored += sizeof(magic);
+    }
+    
+    size_t fill = 0;
+    for (size_t i = 0; ok && i < count; i++) {
+        const uint8_t* source = parts[i];
+        size_t left = lengths[i];
+        while (ok && left > 0) {
+            size_t take = FS_COMPRESS_FRAME_SIZE - fill < left ? FS_COMPRESS_FRAME_SIZE - fill : left;
+            memcpy(frameRaw + fill, source, take);
+            fill += take;
+            source += take;
+            left -= take;
+            if (fill == FS_COMPRESS_FRAME_SIZE) {
+                ok = emitFrameLocked(file, fill);
+                fill = 0;
+            }
+        }
+    }
+    if (ok && fill > 0) {
+        ok = emitFrameLocked(file, fill);
+    }
+    
+    xSemaphoreGive(codecMutex);
+    return ok;
+}
+
+size_t FileSystem::readCompressed(const char* path, size_t offset, uint8_t* buffer, size_t length) {
+    if (length == 0 || !codecMutex || xSemaphoreTake(codecMutex, portMAX_DELAY) != pdTRUE) {
+        return 0;
+    }
+    
+    // Taken before touching the flash: a write that lands mid-read can
+    // only make the decoded frame look stale, never current
+    uint32_t generation = writeGeneration.load();
+    bool sameFile = decodedLength > 0 && decodedGeneration == generation &&
+                    strcmp(decodedPath, path) == 0;
+    
+    // Sequential readers resume at the last decoded frame instead of
+    // walking every header from the start of the file
+    size_t start = 0;
+    size_t physical = sizeof(uint32_t);
+    if (sameFile && offset >= decodedStart) {
+        start = decodedStart;
+        physical = decodedPhysical;
+    }
+    
+    size_t copied = 0;
+    uint8_t header[FS_FRAME_HEADER];
+    while (copied < length && codecReadyLocked() &&
+           cache.read(path, physical, header, sizeof(header)) == sizeof(header)) {
+        uint16_t storedField = header[0] | (header[1] << 8);
+        size_t stored = storedField & ~FS_FRAME_STORED;
+        size_t rawLength = header[2] | (header[3] << 8);
+        if (rawLength == 0 || rawLength > FS_COMPRESS_FRAME_SIZE || stored > FS_COMPRESS_FRAME_SIZE) {
+            break;      // Corrupt or torn frame
+        }
+        
+        size_t position = offset + copied;
+        if (position < start + rawLength) {
+            bool decoded = sameFile && decodedPhysical == physical && decodedLength == rawLength;
+            if (!decoded) {
+                decodedLength = 0;
+                bool raw = storedField & FS_FRAME_STORED;
+                uint8_t* target = raw ? frameDecoded : framePacked;
+                if (cache.read(path, physical + FS_FRAME_HEADER, target, stored) != stored ||
+                    (raw ? stored != rawLength
+                         : lzssDecompress(framePacked, stored, frameDecoded, FS_COMPRESS_FRAME_SIZE) != rawLength)) {
+                    break;
+                }
+                strncpy(decodedPath, path, sizeof(decodedPath) - 1);
+                decodedPath[sizeof(decodedPath) - 1] = '\0';
+                decodedGeneration = generation;
+                decodedStart = start;
+                decodedPhysical = physical;
+                decodedLength = rawLength;
+                sameFile = true;
+            }
+            
+            size_t take = start + rawLength - position < length - copied ? start + rawLength - position
+                                                                         : length - copied;
+            memcpy(buffer + copied, frameDecoded + (position - start), take);
+            copied += take;
+        }
+        start += rawLength;
+        physical += FS_FRAME_HEADER + stored;
+    }
+    
+    xSemaphoreGive(codecMutex);
+    return copied;
+}
+
+size_t FileSystem::readLogical(const char* path, size_t offset, uint8_t* buffer, size_t length,
+                               bool compressed) {
+    return compressed ? readCompressed(path, offset, buffer, length)
+                      : cache.read(path, offset, buffer, length);
+}
+
+void FileSystem::printCompression() {
+    Serial.print("Compressed dirs: ");
+    bool any = false;
+    for (int i = 0; i < FS_COMPRESS_DIRS; i++) {
+        if (compressDirs[i][0]) {
+            Serial.printf("%s%s", any ? ", " : "", compressDirs[i]);
+            any = true;
+        }
+    }
+    Serial.println(any ? "" : "none");
+    if (compressedStored > 0) {
+        Serial.printf("Compression:     %u bytes stored as %u this boot (%.2f:1)\n",
+                      compressedRaw, compressedStored, (float)compressedRaw / compressedStored);
+    }
+}
+
 bool FileSystem::getFileInfo(const char* path, FileInfo& info) {
     if (!initialized || !path) {
         return false;
     }
     
-    File file = SPIFFS.open(path, "r");
-    if (!file) {
+    CacheStat stat;
+    if (!cache.stat(path, stat) || !stat.exists) {
         return false;
     }
     
     strncpy(info.name, path, sizeof(info.name) - 1);
     info.name[sizeof(info.name) - 1] = '\0';
-    info.size = file.size();
-    info.isDirectory = file.isDirectory();
-    info.lastModified = file.getLastWrite();
-    
-    file.close();
+    info.size = !stat.isDirectory && isCompressedFile(path) ? compressedSize(path) : stat.size;
+    info.isDirectory = stat.isDirectory;
+    info.lastModified = stat.lastWrite;
     return true;
 }
 
@@ -240,14 +1148,66 @@ size_t FileSystem::getFileSize(const char* path) {
         return 0;
     }
     
-    File file = SPIFFS.open(path, "r");
-    if (!file) {
+    // The index holds sizes on flash
+    if (isCompressedFile(path)) {
+        return compressedSize(path);
+    }
+    
+    PathEntry entry;
+    if (index.lookup(path, entry) && entry.size != PATH_SIZE_UNKNOWN) {
+        return entry.size;
+    }
+    
+    CacheStat stat;
+    if (!cache.stat(path, stat) || !stat.exists) {
         return 0;
     }
+    return stat.size;
+}
+
+// Listing state handed to printEntry through the index visitor
+struct ListContext {
+    FileSystem* fs;
+    size_t prefixLength;
+    bool detailed;
+};
+
+void FileSystem::printEntry(const PathEntry& entry, void* context) {
+    ListContext* list = (ListContext*)context;
+    const char* name = entry.path + list->prefixLength;
+    if (entry.isDirectory) {
+        Serial.printf("%-28s %8s\n", name, "<DIR>");
+        return;
+    }
     
-    size_t size = file.size();
-    file.close();
-    return size;
+    // Written through a raw handle since indexed; ask the flash once
+    uint32_t size = entry.size;
+    time_t lastWrite = entry.lastWrite;
+    if (size == PATH_SIZE_UNKNOWN) {
+        CacheStat stat;
+        if (list->fs->cache.stat(entry.path, stat) && stat.exists) {
+            size = stat.size;
+            lastWrite = stat.lastWrite;
+        } else {
+            size = 0;
+        }
+    }
+    
+    if (!list->detailed) {
+        Serial.printf("%-28s %8u\n", name, (unsigned)size);
+        return;
+    }
+    
+    struct tm* timeinfo = localtime(&lastWrite);
+    Serial.printf("%-28s %8u  %04d-%02d-%02d %02d:%02d:%02d\n",
+                 name,
+                 (unsigned)size,
+                 timeinfo->tm_year + 1900,
+                 timeinfo->tm_mon + 1,
+                 timeinfo->tm_mday,
+                 timeinfo->tm_hour,
+                 timeinfo->tm_min,
+                 timeinfo->tm_sec);
 }
 
 void FileSystem::listFiles(const char* path) {
@@ -256,7 +1216,17 @@ void FileSystem::listFiles(const char* path) {
         return;
     }
     
-    File root = SPIFFS.open(path ? path : "/");
+    if (index.isValid()) {
+        String prefix = (!path || strcmp(path, "/") == 0) ? String("/") : String(path) + "/";
+        ListContext list = { this, prefix.length(), false };
+        Serial.printf("Directory listing for: %s\n", path ? path : "/");
+        Serial.println("Name                          Size");
+        Serial.println("------------------------------------");
+        index.forEachChild(prefix.c_str(), printEntry, &list);
+        return;
+    }
+    
+    File root = volume->open(path ? path : "/");
     if (!root || !root.isDirectory()) {
         Serial.println("Failed to open directory");
         return;
@@ -282,7 +1252,17 @@ void FileSystem::listFilesDetailed(const char* path) {
         return;
     }
     
-    File root = SPIFFS.open(path ? path : "/");
+    if (index.isValid()) {
+        String prefix = (!path || strcmp(path, "/") == 0) ? String("/") : String(path) + "/";
+        ListContext list = { this, prefix.length(), true };
+        Serial.printf("Detailed directory listing for: %s\n", path ? path : "/");
+        Serial.println("Name                          Size      Modified");
+        Serial.println("------------------------------------------------");
+        index.forEachChild(prefix.c_str(), printEntry, &list);
+        return;
+    }
+    
+    File root = volume->open(path ? path : "/");
     if (!root || !root.isDirectory()) {
         Serial.println("Failed to open directory");
         return;
@@ -319,25 +1299,35 @@ bool FileSystem::format() {
         return false;
     }
     
-    Serial.println("FileSystem: Formatting SPIFFS...");
-    SPIFFS.end();
+    Serial.printf("FileSystem: Formatting %s...\n", backend->name);
+    MountTable* mounts = kernel->getMountTable();
+    mounts->unmount(backend->name);
     mounted = false;
     
-    if (!SPIFFS.format()) {
+    // Remounted even when the format fails, so the old volume stays usable
+    bool formatted = backend->format();
+    if (!formatted) {
         Serial.println("FileSystem: Format failed");
-        return false;
     }
     
-    if (!SPIFFS.begin()) {
+    volume = mounts->mount(backend->name, true);
+    if (!volume) {
+        // No volume to operate on: every call is refused until init() again
         Serial.println("FileSystem: Failed to remount after format");
+        shutdown();
         return false;
     }
     
     mounted = true;
+    cache.setVolume(volume);
+    index.build(volume, backend->realDirectories);
+    writeGeneration++;
     updateStatistics();
     
-    Serial.println("FileSystem: Format completed successfully");
-    return true;
+    if (formatted) {
+        Serial.println("FileSystem: Format completed successfully");
+    }
+    return formatted;
 }
 
 bool FileSystem::check() {
@@ -367,8 +1357,30 @@ void FileSystem::updateStatistics() {
         return;
     }
     
-    totalBytes = SPIFFS.totalBytes();
-    usedBytes = SPIFFS.usedBytes();
+    // Queried outside the lock; the backend walks its metadata
+    size_t total = backend->totalBytes();
+    size_t used = backend->usedBytes();
+    
+    portENTER_CRITICAL(&usageLock);
+    lastDrift = (int32_t)usedBytes - (int32_t)used;
+    totalBytes = total;
+    usedBytes = used;
+    usageQueries++;
+    portEXIT_CRITICAL(&usageLock);
+    
+    publishUsage();
+}
+
+void FileSystem::publishUsage() {
+    MetricsRegistry::set(totalGauge, totalBytes);
+    MetricsRegistry::set(usedGauge, usedBytes);
+    
+    // Publish once when crossing the threshold, not on every write
+    bool full = getUsagePercent() >= FS_FULL_THRESHOLD_PERCENT;
+    if (full && !fullSignalled && kernel && kernel->getEventBus()) {
+        kernel->getEventBus()->publish(EVENT_FS_FULL, (uint32_t)getUsagePercent());
+    }
+    fullSignalled = full;
 }
 
 void FileSystem::printStatistics() {
@@ -383,6 +1395,21 @@ void FileSystem::printStatistics() {
     Serial.printf("Free Space:      %zu bytes (%.2f KB)\n", 
                   getFreeBytes(), getFreeBytes() / 1024.0);
     Serial.printf("Usage:           %.1f%%\n", getUsagePercent());
+    Serial.printf("Usage queries:   %u (estimate was off by %d bytes)\n",
+                  usageQueries, lastDrift);
+    Serial.printf("Atomic writes:   %s (%u interrupted writes recovered at mount)\n",
+                  atomicWrites ? "on" : "off", recoveredWrites);
+    Serial.println();
+    cache.printStatistics();
+    Serial.println();
+    if (index.isValid()) {
+        Serial.printf("Path Index:      %u entries, %u bytes, built in %u ms\n",
+                      (unsigned)index.getCount(), (unsigned)index.getMemoryUsage(),
+                      index.getBuildMs());
+    } else {
+        Serial.printf("Path Index:      disabled (over %d entries)\n", FS_INDEX_MAX_ENTRIES);
+    }
+    printCompression();
 }
 
 bool FileSystem::isValidPath(const char* path) {
@@ -446,3 +1473,23 @@ void FileSystem::getDirName(const char* path, char* dirname, size_t maxLen) {
     strncpy(dirname, path, len);
     dirname[len] = '\0';
 }
+
+ChunkReader::ChunkReader(FileSystem* fs, const char* path, ByteSpan buffer)
+    : fs(fs), buffer(buffer), offset(0) {
+    strncpy(this->path, path ? path : "", sizeof(this->path) - 1);
+    this->path[sizeof(this->path) - 1] = '\0';
+}
+
+bool ChunkReader::next(ByteSpan& chunk) {
+    if (!fs || !path[0]) {
+        return false;
+    }
+    
+    size_t got = fs->readInto(path, buffer, offset);
+    if (got == 0) {
+        return false;
+    }
+    chunk = ByteSpan(buffer.data, got);
+    offset += got;
+    return true;
+}
@@ -1,6 +1,6 @@
 /*
  * ESP32-OS File System Header
- * Simple file system interface using SPIFFS
+ * Simple file system interface over the configured VFS backend
  */
 
 #ifndef FS_T_H
@@ -8,8 +8,22 @@
 
 #include <Arduino.h>
 #include "FS.h"
-#include <SPIFFS.h>
 #include "../config/config.h"
+#include "../kernel/metrics.h"
+#include "blockcache.h"
+#include "pathindex.h"
+#include "vfs.h"
+#include "lzss.h"
+#include "../kernel/timerwheel.h"
+#include <atomic>
+
+// Compressed file layout: u32 magic, then frames of u16 stored length
+// (FS_FRAME_STORED set when kept raw), u16 raw length and the payload.
+// Frames are independent, so appends just add frames.
+#define FS_COMPRESS_MAGIC 0x1A5A4C89    // "\x89LZ\x1A"
+#define FS_FRAME_HEADER 4
+#define FS_FRAME_STORED 0x8000
+
 struct FileInfo {
     char name[FS_MAX_PATH_LENGTH];
     size_t size;
@@ -17,12 +31,107 @@ struct FileInfo {
     uint32_t lastModified;
 };
 
+// Caller-owned memory; the file system never allocates behind it
+struct ByteSpan {
+    uint8_t* data;
+    size_t length;
+    
+    ByteSpan() : data(nullptr), length(0) {}
+    ByteSpan(uint8_t* data, size_t length) : data(data), length(length) {}
+};
+
+// Sees each chunk in file order; return false to stop early
+typedef bool (*ChunkVisitor_t)(const uint8_t* data, size_t length, size_t offset, void* context);
+// Fills up to length bytes of the buffer; returns 0 when there is no more
+typedef size_t (*ChunkProducer_t)(uint8_t* buffer, size_t length, void* context);
+
 class FileSystem {
+    friend class AppendLog;     // Keeps index and cache current on each flush
+    
 private:
     bool initialized;
     bool mounted;
+    const VfsBackend* backend;
+    fs::FS* volume;         // Shared handle from the kernel mount table
     size_t totalBytes;
     size_t usedBytes;
+    bool fullSignalled;     // EVENT_FS_FULL published for the current episode
+    
+    // Usage is estimated from writes and frees, and only queried from the
+    // backend FS_USAGE_RECONCILE_MS after the last change
+    portMUX_TYPE usageLock;
+    SoftTimer usageTimer;
+    std::atomic<bool> reconcileQueued;
+    uint32_t usageQueries;
+    int32_t lastDrift;      // Estimate minus real usage at the last query
+    BlockCache cache;       // Pages and metadata; invalidated by every mutation here
+    PathIndex index;        // Every file path, sorted; built once at mount
+    
+    // Transparent compression. Codec buffers are allocated on first use and
+    // shared under codecMutex.
+    char compressDirs[FS_COMPRESS_DIRS][FS_MAX_PATH_LENGTH];
+    SemaphoreHandle_t codecMutex;
+    LzssWorkspace* codecWorkspace;
+    uint8_t* frameRaw;          // Frame being built by a write
+    uint8_t* framePacked;       // Header and payload, either direction
+    uint8_t* frameDecoded;      // Last frame read, kept for sequential reads
+    std::atomic<uint32_t> writeGeneration;  // Bumped by every mutation
+    uint32_t decodedGeneration;
+    char decodedPath[FS_MAX_PATH_LENGTH];
+    size_t decodedStart;        // Logical offset of the decoded frame
+    size_t decodedPhysical;     // File offset of its header
+    size_t decodedLength;       // 0 when nothing is decoded
+    uint32_t compressedRaw;     // Bytes written through the codec since boot
+    uint32_t compressedStored;  // What they took on flash
+    
+    bool atomicWrites;          // Replacing writes survive a reset mid-write
+    uint32_t recoveredWrites;   // Interrupted replaces cleaned up at mount
+    
+    // A warm restart with nothing mid-replace skips recovery and the usage
+    // query. Anything that changes after the state is saved clears the
+    // warm record's flag again.
+    std::atomic<uint32_t> replacesInFlight;
+    std::atomic<bool> replaceLeftovers; // A failed replace left a file for recovery
+    std::atomic<bool> warmSaved;
+    // Held from beginReplace to finishReplace. The temp name is derived
+    // from the path, so two replaces of one path must not overlap.
+    SemaphoreHandle_t replaceLocks[FS_REPLACE_LOCKS];
+    
+    // Metrics
+    Metric* readOps;
+    Metric* writeOps;
+    Metric* bytesRead;
+    Metric* bytesWritten;
+    Metric* usedGauge;
+    Metric* totalGauge;
+    
+    void registerMetrics();
+    void noteWritten(const char* path, uint32_t size);
+    void noteRemoved(const char* path);
+    uint32_t footprint(uint32_t size) const;
+    bool previousFootprint(const char* path, uint32_t& bytes);
+    void adjustUsage(int32_t delta, bool known);
+    void warmStateChanged();
+    void publishUsage();
+    static void onUsageTimer(void* arg);
+    static void reconcileUsage(void* arg);
+    bool removeTree(const char* dir);
+    bool compressedDir(const char* path);
+    bool appendsCompressed(const char* path);
+    bool isCompressedFile(const char* path);
+    size_t compressedSize(const char* path);
+    bool codecReadyLocked();
+    bool emitFrameLocked(File& file, size_t length);
+    bool writeCompressed(File& file, const uint8_t* const* parts, const size_t* lengths, size_t count);
+    size_t readCompressed(const char* path, size_t offset, uint8_t* buffer, size_t length);
+    size_t readLogical(const char* path, size_t offset, uint8_t* buffer, size_t length, bool compressed);
+    static void printEntry(const PathEntry& entry, void* context);
+    File beginReplace(const char* path, char* temp);
+    SemaphoreHandle_t replaceLock(const char* path);
+    bool finishReplace(File& file, const char* path, const char* temp, bool complete);
+    void recoverReplaces();
+    void collectReplaces(const char* dir, std::vector<std::string>& out);
+    static void collectReplace(const PathEntry& entry, void* context);
     
     // File operations
     bool isValidPath(const char* path);
@@ -47,13 +156,34 @@ public:
     bool directoryExists(const char* path);
     
     // File I/O
+    // A handle opened for writing bypasses the cache; close it with
+    // closeFile so cached pages and the index pick up what it wrote
     File openFile(const char* path, const char* mode = "r");
+    void closeFile(File& file, const char* path);
+    // With atomic writes on, a reset leaves either the old or the new
+    // contents, never a truncated file
     bool writeFile(const char* path, const char* data);
     bool writeFile(const char* path, const uint8_t* data, size_t length);
     bool readFile(const char* path, String& content);
+    size_t read(const char* path, size_t offset, uint8_t* buffer, size_t length);
+    
+    // Streaming I/O through caller-owned buffers, constant RAM for any file
+    // size. readFile(String) is bounded by FS_STRING_READ_MAX.
+    size_t readInto(const char* path, ByteSpan span, size_t offset = 0);
+    bool readChunks(const char* path, ByteSpan buffer, ChunkVisitor_t visitor, void* context);
+    bool writeChunks(const char* path, ByteSpan buffer, ChunkProducer_t producer, void* context,
+                     bool append = false);
     bool appendFile(const char* path, const char* data);
+    // Gathers several buffers into one open/write/close
+    bool appendFile(const char* path, const uint8_t* const* parts, const size_t* lengths, size_t count);
     
-    // File information
+    // New files under these prefixes are stored compressed. Reads detect
+    // compressed files by their magic, whatever the current setting.
+    bool setCompression(const char* dirPrefix, bool enabled);
+    bool isCompressed(const char* path) { return initialized && path && isCompressedFile(path); }
+    void printCompression();
+    
+    // File information (sizes are logical, before compression)
     bool getFileInfo(const char* path, FileInfo& info);
     size_t getFileSize(const char* path);
     
@@ -72,8 +202,13 @@ public:
     // File system maintenance
     bool format();
     bool check();
+    // True when nothing is mid-replace and usage is exact
+    bool prepareWarmReboot(uint32_t& total, uint32_t& used);
+    void setAtomicWrites(bool enabled) { atomicWrites = enabled; }
+    bool getAtomicWrites() const { return atomicWrites; }
     void updateStatistics();
     void printStatistics();
+    void resetCacheStatistics() { cache.resetStatistics(); }
     
     // Utility functions
     static const char* getFileExtension(const char* filename);
@@ -81,4 +216,20 @@ public:
     static void getDirName(const char* path, char* dirname, size_t maxLen);
 };
 
+// Pull-style iteration: each next() refills the caller's buffer
+class ChunkReader {
+private:
+    FileSystem* fs;
+    char path[FS_MAX_PATH_LENGTH];
+    ByteSpan buffer;
+    size_t offset;
+    
+public:
+    ChunkReader(FileSystem* fs, const char* path, ByteSpan buffer);
+    
+    bool next(ByteSpan& chunk);
+    size_t getOffset() const { return offset; }
+    void rewind() { offset = 0; }
+};
+
 #endif // FS_H
@@ -0,0 +1,127 @@
+/*
+ * ESP32-OS LZSS Codec Implementation
+ */
+
+#include "lzss.h"
+#include <string.h>
+
+static inline uint32_t lzssHash(const uint8_t* p) {
+    return ((p[0] << 6) ^ (p[1] << 3) ^ p[2]) & ((1 << LZSS_HASH_BITS) - 1);
+}
+
+static inline void lzssInsert(const uint8_t* input, size_t length, size_t position,
+                              LzssWorkspace* workspace) {
+    if (position + LZSS_MIN_MATCH <= length) {
+        uint32_t hash = lzssHash(input + position);
+        workspace->prev[position] = workspace->head[hash];
+        workspace->head[hash] = (uint16_t)position;
+    }
+}
+
+size_t lzssCompress(const uint8_t* input, size_t length, uint8_t* output, size_t capacity,
+                    LzssWorkspace* workspace) {
+    if (!input || !output || !workspace || length > FS_COMPRESS_FRAME_SIZE) {
+        return 0;
+    }
+    for (size_t i = 0; i < (1 << LZSS_HASH_BITS); i++) {
+        workspace->head[i] = LZSS_NIL;
+    }
+
+    size_t in = 0;
+    size_t out = 0;
+    size_t flagPosition = 0;
+    int bit = 0;
+
+    while (in < length) {
+        if (bit == 0) {
+            if (out >= capacity) {
+                return 0;
+            }
+            flagPosition = out++;
+            output[flagPosition] = 0;
+        }
+
+        // Longest match along a bounded hash chain
+        size_t bestLength = 0;
+        size_t bestDistance = 0;
+        if (in + LZSS_MIN_MATCH <= length) {
+            size_t limit = length - in < LZSS_MAX_MATCH ? length - in : LZSS_MAX_MATCH;
+            uint16_t candidate = workspace->head[lzssHash(input + in)];
+            for (int chain = 0; candidate != LZSS_NIL && chain < FS_COMPRESS_MAX_CHAIN; chain++) {
+                if (in - candidate > LZSS_WINDOW) {
+                    break;
+                }
+                size_t matched = 0;
+                while (matched < limit && input[candidate + matched] == input[in + matched]) {
+                    matched++;
+                }
+                if (matched > bestLength) {
+                    bestLength = matched;
+                    bestDistance = in - candidate;
+                    if (matched == limit) {
+                        break;
+                    }
+                }
+                candidate = workspace->prev[candidate];
+            }
+        }
+
+        if (bestLength >= LZSS_MIN_MATCH) {
+            if (out + 2 > capacity) {
+                return 0;
+            }
+            output[out++] = (uint8_t)((bestDistance - 1) & 0xFF);
+            output[out++] = (uint8_t)((((bestDistance - 1) >> 8) << 4) | (bestLength - LZSS_MIN_MATCH));
+            for (size_t i = 0; i < bestLength; i++) {
+                lzssInsert(input, length, in + i, workspace);
+            }
+            in += bestLength;
+        } else {
+            if (out >= capacity) {
+                return 0;
+            }
+            output[flagPosition] |= (uint8_t)(1 << bit);
+            output[out++] = input[in];
+            lzssInsert(input, length, in, workspace);
+            in++;
+        }
+        bit = (bit + 1) & 7;
+    }
+    return out;
+}
+
+size_t lzssDecompress(const uint8_t* input, size_t length, uint8_t* output, size_t capacity) {
+    if (!input || !output) {
+        return 0;
+    }
+
+    size_t in = 0;
+    size_t out = 0;
+    while (in < length) {
+        uint8_t flags = input[in++];
+        for (int bit = 0; bit < 8 && in < length; bit++) {
+            if (flags & (1 << bit)) {
+                if (out >= capacity) {
+                    return 0;
+                }
+                output[out++] = input[in++];
+                continue;
+            }
+
+            if (in + 2 > length) {
+                return 0;
+            }
+            size_t distance = (input[in] | ((input[in + 1] >> 4) << 8)) + 1;
+            size_t matched = (input[in + 1] & 0x0F) + LZSS_MIN_MATCH;
+            in += 2;
+            if (distance > out || out + matched > capacity) {
+                return 0;
+            }
+            // Byte by byte: overlapping copies repeat the pattern
+            for (size_t i = 0; i < matched; i++, out++) {
+                output[out] = output[out - distance];
+            }
+        }
+    }
+    return out;
+}
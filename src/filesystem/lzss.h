@@ -0,0 +1,33 @@
+/*
+ * ESP32-OS LZSS Codec Header
+ * Small-footprint LZSS for compressing file frames in place
+ */
+
+#ifndef LZSS_H
+#define LZSS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../config/config.h"
+
+// Token stream: a flag byte per eight items, LSB first; 1 is a literal byte,
+// 0 a two-byte match of 12-bit distance and 4-bit length (3..18)
+#define LZSS_WINDOW 4096
+#define LZSS_MIN_MATCH 3
+#define LZSS_MAX_MATCH 18
+#define LZSS_HASH_BITS 8
+#define LZSS_NIL 0xFFFF
+
+// Match finder state for one input of up to FS_COMPRESS_FRAME_SIZE bytes
+struct LzssWorkspace {
+    uint16_t head[1 << LZSS_HASH_BITS];
+    uint16_t prev[FS_COMPRESS_FRAME_SIZE];
+};
+
+// Returns the compressed size, or 0 if it would not fit in capacity
+size_t lzssCompress(const uint8_t* input, size_t length, uint8_t* output, size_t capacity,
+                    LzssWorkspace* workspace);
+// Returns the decompressed size, or 0 if the input is corrupt or too large
+size_t lzssDecompress(const uint8_t* input, size_t length, uint8_t* output, size_t capacity);
+
+#endif // LZSS_H
@@ -0,0 +1,420 @@
+/*
+ * ESP32-OS Path Index Implementation
+ */
+
+#include "pathindex.h"
+#include <algorithm>
+
+// Orders slots by the path each one points at
+struct SlotLess {
+    const std::vector<char>& arena;
+    SlotLess(const std::vector<char>& arena) : arena(arena) {}
+    bool operator()(const PathSlot& a, const PathSlot& b) const {
+        return strcmp(&arena[a.offset], &arena[b.offset]) < 0;
+    }
+};
+
+PathIndex::PathIndex() : garbage(0), indexMutex(nullptr), valid(false), directories(false),
+                         buildMs(0) {
+}
+
+PathIndex::~PathIndex() {
+    shutdown();
+}
+
+bool PathIndex::init() {
+    indexMutex = xSemaphoreCreateMutex();
+    if (!indexMutex) {
+        Serial.println("PathIndex: Failed to create mutex");
+        return false;
+    }
+    return true;
+}
+
+void PathIndex::shutdown() {
+    dropLocked();
+    if (indexMutex) {
+        vSemaphoreDelete(indexMutex);
+        indexMutex = nullptr;
+    }
+}
+
+size_t PathIndex::lowerBound(const char* path) const {
+    size_t low = 0;
+    size_t high = slots.size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (strcmp(pathAt(mid), path) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+bool PathIndex::findLocked(const char* path, size_t& slot) const {
+    slot = lowerBound(path);
+    return slot < slots.size() && strcmp(pathAt(slot), path) == 0;
+}
+
+PathEntry PathIndex::entryAt(size_t slot) const {
+    PathEntry entry;
+    entry.path = pathAt(slot);
+    entry.size = slots[slot].size;
+    entry.lastWrite = slots[slot].lastWrite;
+    entry.isDirectory = slots[slot].isDirectory;
+    return entry;
+}
+
+// The path must not point into the arena, which may move while it grows
+bool PathIndex::insertLocked(const char* path, uint32_t size, time_t lastWrite, bool isDirectory) {
+    if (slots.size() >= FS_INDEX_MAX_ENTRIES) {
+        // Too large to keep; every lookup falls back to flash from now on
+        dropLocked();
+        return false;
+    }
+
+    PathSlot slot;
+    slot.offset = arena.size();
+    slot.size = size;
+    slot.lastWrite = lastWrite;
+    slot.isDirectory = isDirectory;
+    arena.insert(arena.end(), path, path + strlen(path) + 1);
+    slots.insert(slots.begin() + lowerBound(path), slot);
+    return true;
+}
+
+void PathIndex::eraseLocked(size_t slot) {
+    garbage += strlen(pathAt(slot)) + 1;
+    slots.erase(slots.begin() + slot);
+    if (garbage * 2 > arena.size()) {
+        compactLocked();
+    }
+}
+
+// Packs the live paths into a fresh arena, in slot order
+void PathIndex::compactLocked() {
+    std::vector<char> packed;
+    packed.reserve(arena.size() - garbage);
+    for (size_t i = 0; i < slots.size(); i++) {
+        const char* path = pathAt(i);
+        uint32_t offset = packed.size();
+        packed.insert(packed.end(), path, path + strlen(path) + 1);
+        slots[i].offset = offset;
+    }
+    arena.swap(packed);
+    garbage = 0;
+}
+
+void PathIndex::dropLocked() {
+    std::vector<PathSlot>().swap(slots);
+    std::vector<char>().swap(arena);
+    garbage = 0;
+    valid = false;
+}
+
+// Creating a file on a backend with real directories creates its parents
+bool PathIndex::addParentsLocked(const char* path, time_t lastWrite) {
+    if (!directories) {
+        return true;
+    }
+
+    char parent[FS_MAX_PATH_LENGTH];
+    size_t slot;
+    for (const char* slash = strchr(path + 1, '/'); slash; slash = strchr(slash + 1, '/')) {
+        size_t length = slash - path;
+        if (length >= sizeof(parent)) {
+            break;
+        }
+        memcpy(parent, path, length);
+        parent[length] = '\0';
+        if (!findLocked(parent, slot) && !insertLocked(parent, 0, lastWrite, true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PathIndex::scanLocked(fs::FS* volume, const char* dir) {
+    File root = volume->open(dir);
+    if (!root || !root.isDirectory()) {
+        return false;
+    }
+
+    File file = root.openNextFile();
+    while (file) {
+        if (slots.size() >= FS_INDEX_MAX_ENTRIES) {
+            file.close();
+            root.close();
+            return false;
+        }
+
+        // Appended unsorted; build() sorts once the walk is done
+        std::string path = file.path();
+        PathSlot slot;
+        slot.offset = arena.size();
+        slot.size = file.isDirectory() ? 0 : file.size();
+        slot.lastWrite = file.getLastWrite();
+        slot.isDirectory = file.isDirectory();
+        arena.insert(arena.end(), path.c_str(), path.c_str() + path.size() + 1);
+        slots.push_back(slot);
+        file.close();
+
+        if (slot.isDirectory && !scanLocked(volume, path.c_str())) {
+            root.close();
+            return false;
+        }
+        file = root.openNextFile();
+    }
+
+    root.close();
+    return true;
+}
+
+bool PathIndex::build(fs::FS* volume, bool realDirectories) {
+    if (!volume || !indexMutex || xSemaphoreTake(indexMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+
+    uint32_t start = millis();
+    dropLocked();
+    directories = realDirectories;
+    valid = scanLocked(volume, "/");
+    if (valid) {
+        std::sort(slots.begin(), slots.end(), SlotLess(arena));
+    } else {
+        dropLocked();
+        Serial.printf("PathIndex: Disabled, more than %d entries or scan failed\n", FS_INDEX_MAX_ENTRIES);
+    }
+    buildMs = millis() - start;
+
+    xSemaphoreGive(indexMutex);
+    return valid;
+}
+
+void PathIndex::upsert(const char* path, uint32_t size, time_t lastWrite) {
+    if (!path || !valid || xSemaphoreTake(indexMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    size_t slot;
+    if (findLocked(path, slot)) {
+        slots[slot].size = size;
+        slots[slot].lastWrite = lastWrite;
+        slots[slot].isDirectory = false;
+    } else if (addParentsLocked(path, lastWrite)) {
+        insertLocked(path, size, lastWrite, false);
+    }
+
+    xSemaphoreGive(indexMutex);
+}
+
+void PathIndex::upsertDirectory(const char* path, time_t lastWrite) {
+    if (!path || !valid || !directories || xSemaphoreTake(indexMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    size_t slot;
+    if (!findLocked(path, slot) && addParentsLocked(path, lastWrite)) {
+        insertLocked(path, 0, lastWrite, true);
+    }
+
+    xSemaphoreGive(indexMutex);
+}
+
+bool PathIndex::remove(const char* path) {
+    if (!path || !valid || xSemaphoreTake(indexMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+
+    size_t slot;
+    bool found = findLocked(path, slot);
+    if (found) {
+        eraseLocked(slot);
+    }
+
+    xSemaphoreGive(indexMutex);
+    return found;
+}
+
+bool PathIndex::rename(const char* oldPath, const char* newPath) {
+    if (!oldPath || !newPath || !valid || xSemaphoreTake(indexMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+
+    size_t slot;
+    bool found = findLocked(oldPath, slot);
+    if (found) {
+        // Copied out first; erasing may compact the arena under the paths
+        std::vector<std::pair<std::string, PathSlot> > moved;
+        std::string oldPrefix = std::string(oldPath) + "/";
+        moved.push_back(std::make_pair(std::string(newPath), slots[slot]));
+        if (slots[slot].isDirectory) {
+            for (size_t i = lowerBound(oldPrefix.c_str()); i < slots.size(); i++) {
+                if (strncmp(pathAt(i), oldPrefix.c_str(), oldPrefix.size()) != 0) {
+                    break;
+                }
+                moved.push_back(std::make_pair(std::string(newPath) + (pathAt(i) + strlen(oldPath)),
+                                               slots[i]));
+            }
+            for (size_t i = moved.size() - 1; i > 0; i--) {
+                eraseLocked(lowerBound(oldPrefix.c_str()));
+            }
+        }
+        eraseLocked(lowerBound(oldPath));
+
+        // The target is replaced, as the rename on flash did
+        size_t existing;
+        if (findLocked(newPath, existing)) {
+            eraseLocked(existing);
+        }
+        bool ok = addParentsLocked(newPath, moved[0].second.lastWrite);
+        for (size_t i = 0; ok && i < moved.size(); i++) {
+            ok = insertLocked(moved[i].first.c_str(), moved[i].second.size,
+                              moved[i].second.lastWrite, moved[i].second.isDirectory);
+        }
+    }
+
+    xSemaphoreGive(indexMutex);
+    return found;
+}
+
+bool PathIndex::lookup(const char* path, PathEntry& out) {
+    if (!path || !valid || xSemaphoreTake(indexMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+
+    size_t slot;
+    bool found = findLocked(path, slot);
+    if (found) {
+        out = entryAt(slot);
+        out.path = nullptr;
+    }
+
+    xSemaphoreGive(indexMutex);
+    return found;
+}
+
+bool PathIndex::contains(const char* path) {
+    PathEntry entry;
+    return lookup(path, entry);
+}
+
+bool PathIndex::isDirectory(const char* path) {
+    PathEntry entry;
+    return lookup(path, entry) && entry.isDirectory;
+}
+
+bool PathIndex::hasPrefix(const char* prefix) {
+    if (!prefix || !valid || xSemaphoreTake(indexMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+
+    size_t position = lowerBound(prefix);
+    bool found = position < slots.size() &&
+                 strncmp(pathAt(position), prefix, strlen(prefix)) == 0;
+
+    xSemaphoreGive(indexMutex);
+    return found;
+}
+
+size_t PathIndex::forEachPrefix(const char* prefix, PathVisitor_t visitor, void* context) {
+    if (!prefix || !visitor || !valid || xSemaphoreTake(indexMutex, portMAX_DELAY) != pdTRUE) {
+        return 0;
+    }
+
+    // Matches are contiguous in sorted order, starting at the lower bound
+    size_t length = strlen(prefix);
+    size_t visited = 0;
+    for (size_t i = lowerBound(prefix); i < slots.size(); i++) {
+        if (strncmp(pathAt(i), prefix, length) != 0) {
+            break;
+        }
+        visitor(entryAt(i), context);
+        visited++;
+    }
+
+    xSemaphoreGive(indexMutex);
+    return visited;
+}
+
+static void collectVisitor(const PathEntry& entry, void* context) {
+    ((std::vector<std::string>*)context)->push_back(entry.path);
+}
+
+void PathIndex::collectPrefix(const char* prefix, std::vector<std::string>& out) {
+    forEachPrefix(prefix, collectVisitor, &out);
+}
+
+size_t PathIndex::forEachChild(const char* dir, PathVisitor_t visitor, void* context) {
+    if (!dir || !visitor || !valid || xSemaphoreTake(indexMutex, portMAX_DELAY) != pdTRUE) {
+        return 0;
+    }
+
+    char prefix[FS_MAX_PATH_LENGTH];
+    size_t length = strlen(dir);
+    snprintf(prefix, sizeof(prefix), "%s%s", dir, length > 0 && dir[length - 1] == '/' ? "" : "/");
+    length = strlen(prefix);
+
+    char child[FS_MAX_PATH_LENGTH];
+    size_t visited = 0;
+    size_t i = lowerBound(prefix);
+    while (i < slots.size() && strncmp(pathAt(i), prefix, length) == 0) {
+        const char* rest = pathAt(i) + length;
+        const char* slash = strchr(rest, '/');
+        if (!slash) {
+            visitor(entryAt(i), context);
+            visited++;
+            i++;
+            continue;
+        }
+
+        // Something deeper: its directory is reported once, unless it is
+        // indexed itself and was reported already. Everything below one
+        // directory is contiguous in sorted order.
+        size_t childLength = slash - pathAt(i);
+        if (childLength + 1 >= sizeof(child)) {
+            i++;
+            continue;
+        }
+        memcpy(child, pathAt(i), childLength);
+        child[childLength] = '\0';
+        size_t slot;
+        if (!findLocked(child, slot)) {
+            PathEntry entry;
+            entry.path = child;
+            entry.size = 0;
+            entry.lastWrite = slots[i].lastWrite;
+            entry.isDirectory = true;
+            visitor(entry, context);
+            visited++;
+        }
+        child[childLength] = '/';
+        child[childLength + 1] = '\0';
+        while (i < slots.size() && strncmp(pathAt(i), child, childLength + 1) == 0) {
+            i++;
+        }
+    }
+
+    xSemaphoreGive(indexMutex);
+    return visited;
+}
+
+size_t PathIndex::getCount() {
+    if (!indexMutex || xSemaphoreTake(indexMutex, portMAX_DELAY) != pdTRUE) {
+        return 0;
+    }
+    size_t count = slots.size();
+    xSemaphoreGive(indexMutex);
+    return count;
+}
+
+size_t PathIndex::getMemoryUsage() {
+    if (!indexMutex || xSemaphoreTake(indexMutex, portMAX_DELAY) != pdTRUE) {
+        return 0;
+    }
+    size_t bytes = slots.capacity() * sizeof(PathSlot) + arena.capacity();
+    xSemaphoreGive(indexMutex);
+    return bytes;
+}
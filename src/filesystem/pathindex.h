@@ -0,0 +1,96 @@
+/*
+ * ESP32-OS Path Index Header
+ * Sorted in-RAM index of file paths for lookups and prefix enumeration
+ */
+
+#ifndef PATHINDEX_H
+#define PATHINDEX_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <vector>
+#include <string>
+#include "FS.h"
+#include "../config/config.h"
+
+#define PATH_SIZE_UNKNOWN 0xFFFFFFFF    // Written through a raw handle since indexed
+
+struct PathEntry {
+    const char* path;       // Points into the index; only valid inside a visitor
+    uint32_t size;
+    time_t lastWrite;
+    bool isDirectory;
+};
+
+typedef void (*PathVisitor_t)(const PathEntry& entry, void* context);
+
+// Paths are packed end to end in one arena rather than one heap string
+// each. Removed paths leave a hole until the arena is compacted.
+struct PathSlot {
+    uint32_t offset;        // Into the arena
+    uint32_t size;
+    time_t lastWrite;
+    bool isDirectory;
+};
+
+// Only sees changes made through FileSystem, like the block cache
+class PathIndex {
+private:
+    std::vector<PathSlot> slots;        // Sorted by path
+    std::vector<char> arena;            // NUL-terminated paths
+    size_t garbage;                     // Arena bytes no slot points at
+    SemaphoreHandle_t indexMutex;
+    bool valid;                         // Built and within FS_INDEX_MAX_ENTRIES
+    bool directories;                   // The backend has real directories to index
+    uint32_t buildMs;
+
+    const char* pathAt(size_t slot) const { return &arena[slots[slot].offset]; }
+    size_t lowerBound(const char* path) const;
+    bool findLocked(const char* path, size_t& slot) const;
+    bool insertLocked(const char* path, uint32_t size, time_t lastWrite, bool isDirectory);
+    void eraseLocked(size_t slot);
+    void compactLocked();
+    void dropLocked();
+    bool addParentsLocked(const char* path, time_t lastWrite);
+    bool scanLocked(fs::FS* volume, const char* dir);
+    PathEntry entryAt(size_t slot) const;
+
+public:
+    PathIndex();
+    ~PathIndex();
+
+    bool init();
+    void shutdown();
+
+    // One flash walk at mount; false leaves the index invalid. Directories
+    // are indexed on backends that have them, otherwise they are implied
+    // by the files below them.
+    bool build(fs::FS* volume, bool realDirectories);
+    bool isValid() const { return valid; }
+
+    void upsert(const char* path, uint32_t size, time_t lastWrite);
+    void upsertDirectory(const char* path, time_t lastWrite);
+    bool remove(const char* path);
+    // A directory takes everything below it along
+    bool rename(const char* oldPath, const char* newPath);
+
+    // Copies size and time out; the path is left null
+    bool lookup(const char* path, PathEntry& out);
+    bool contains(const char* path);
+    bool isDirectory(const char* path);
+    bool hasPrefix(const char* prefix);
+
+    // Visits entries starting with prefix in path order, under the index lock
+    size_t forEachPrefix(const char* prefix, PathVisitor_t visitor, void* context);
+    void collectPrefix(const char* prefix, std::vector<std::string>& out);
+    // Visits the entries directly inside dir, each subdirectory once,
+    // whether it is indexed itself or only implied by its files
+    size_t forEachChild(const char* dir, PathVisitor_t visitor, void* context);
+
+    size_t getCount();
+    size_t getMemoryUsage();
+    uint32_t getBuildMs() const { return buildMs; }
+};
+
+#endif // PATHINDEX_H
@@ -0,0 +1,279 @@
+/*
+ * ESP32-OS VFS Implementation
+ */
+
+#include "vfs.h"
+#include "../kernel/checksum.h"
+#include <SPIFFS.h>
+#include <LittleFS.h>
+#include <esp_partition.h>
+
+#define FS_BENCH_MOUNT_POINT "/fsbench"
+#define FS_BENCH_MAX_OPEN 5
+#define FS_BENCH_RANDOM_FILE "/bench/random.bin"
+#define FS_BENCH_RANDOM_FILE_SIZE 16384
+#define FS_BENCH_RANDOM_CHUNK 64
+
+// SPIFFS: flat namespace, directories faked with marker files
+static bool mountSpiffs() { return SPIFFS.begin(FORMAT_SPIFFS_IF_FAILED, "/spiffs", 10, FS_PARTITION_LABEL); }
+static void unmountSpiffs() { SPIFFS.end(); }
+static bool formatSpiffs() { return SPIFFS.format(); }
+static size_t totalSpiffs() { return SPIFFS.totalBytes(); }
+static size_t usedSpiffs() { return SPIFFS.usedBytes(); }
+
+const VfsBackend vfsSpiffs = {
+    "spiffs", &SPIFFS, mountSpiffs, unmountSpiffs, formatSpiffs,
+    totalSpiffs, usedSpiffs, false, 256, false, 31
+};
+
+// LittleFS: real directories, copy-on-write metadata survives power loss
+static bool mountLittleFS() { return LittleFS.begin(FORMAT_LITTLEFS_IF_FAILED, "/littlefs", 10, FS_PARTITION_LABEL); }
+static void unmountLittleFS() { LittleFS.end(); }
+static bool formatLittleFS() { return LittleFS.format(); }
+static size_t totalLittleFS() { return LittleFS.totalBytes(); }
+static size_t usedLittleFS() { return LittleFS.usedBytes(); }
+
+const VfsBackend vfsLittleFS = {
+    "littlefs", &LittleFS, mountLittleFS, unmountLittleFS, formatLittleFS,
+    totalLittleFS, usedLittleFS, true, 4096, true, 255
+};
+
+const VfsBackend* vfsActive() {
+#if FS_BACKEND == FS_BACKEND_LITTLEFS
+    return &vfsLittleFS;
+#else
+    return &vfsSpiffs;
+#endif
+}
+
+static uint16_t replaceTag(const char* path, size_t length) {
+    uint32_t hash = fnv1a(path, length);
+    return (hash ^ (hash >> 16)) & 0xFFFF;
+}
+
+bool vfsReplaceName(const VfsBackend* backend, const char* path, char kind, char* name, size_t size) {
+    int length = snprintf(name, size, "%s~%04x%c", path, replaceTag(path, strlen(path)), kind);
+    if (length < 0 || (size_t)length >= size) {
+        return false;
+    }
+    const char* stored = name;
+    if (backend->realDirectories && strrchr(name, '/')) {
+        stored = strrchr(name, '/') + 1;
+    }
+    return strlen(stored) <= backend->maxNameLength;
+}
+
+bool vfsReplaceTarget(const char* name, char* target, size_t size, char& kind) {
+    size_t length = strlen(name);
+    if (length <= VFS_REPLACE_TAG_LENGTH || length - VFS_REPLACE_TAG_LENGTH >= size) {
+        return false;
+    }
+    length -= VFS_REPLACE_TAG_LENGTH;
+    kind = name[length + VFS_REPLACE_TAG_LENGTH - 1];
+    if (kind != VFS_TEMP_KIND && kind != VFS_COMMIT_KIND) {
+        return false;
+    }
+
+    char tag[VFS_REPLACE_TAG_LENGTH + 1];
+    snprintf(tag, sizeof(tag), "~%04x%c", replaceTag(name, length), kind);
+    if (strcmp(name + length, tag) != 0) {
+        return false;
+    }
+    memcpy(target, name, length);
+    target[length] = '\0';
+    return true;
+}
+
+bool vfsReplace(fs::FS* volume, const VfsBackend* backend, const char* temp, const char* path) {
+    if (backend->replacingRename) {
+        return volume->rename(temp, path);
+    }
+    
+    // Once the commit name exists, a reset at any later point leaves a
+    // complete file that recovery moves into place
+    char commit[FS_MAX_PATH_LENGTH];
+    if (!vfsReplaceName(backend, path, VFS_COMMIT_KIND, commit, sizeof(commit))) {
+        if (volume->exists(path) && !volume->remove(path)) {
+            return false;
+        }
+        return volume->rename(temp, path);
+    }
+    if (volume->exists(commit)) {
+        volume->remove(commit);
+    }
+    if (!volume->rename(temp, commit)) {
+        return false;
+    }
+    if (volume->exists(path) && !volume->remove(path)) {
+        return false;
+    }
+    return volume->rename(commit, path);
+}
+
+// Benchmark
+
+struct BenchResult {
+    uint32_t createUs;          // FS_BENCH_FILES files of FS_BENCH_FILE_SIZE
+    uint32_t remountUs;         // Mount with those files present
+    uint32_t lookupUs;          // One hit and one miss per file
+    uint32_t replaceUs;         // Rewrite each file truncated in place
+    uint32_t atomicReplaceUs;   // Rewrite each file through a temp and rename
+    uint32_t randomWriteUs;     // Open, seek, write, close in a larger file
+    uint32_t deleteUs;
+};
+
+// Same offsets for every backend
+static uint32_t benchRandom(uint32_t& state) {
+    state = state * 1664525UL + 1013904223UL;
+    return state >> 8;
+}
+
+// Each backend class gets its own instance on the scratch partition so the
+// live volume stays mounted throughout
+template <typename Backend>
+static bool benchBackend(const char* name, const VfsBackend* backend, uint8_t* buffer, BenchResult& result) {
+    Backend fs;
+    char path[FS_MAX_PATH_LENGTH];
+    char temp[FS_MAX_PATH_LENGTH];
+
+    if (!fs.begin(true, FS_BENCH_MOUNT_POINT, FS_BENCH_MAX_OPEN, FS_BENCH_PARTITION)) {
+        Serial.printf("VFS: Failed to mount %s on '%s'\n", name, FS_BENCH_PARTITION);
+        return false;
+    }
+    fs.format();
+    fs.end();
+    if (!fs.begin(false, FS_BENCH_MOUNT_POINT, FS_BENCH_MAX_OPEN, FS_BENCH_PARTITION)) {
+        Serial.printf("VFS: %s did not remount after format\n", name);
+        return false;
+    }
+    fs.mkdir("/bench");
+
+    uint32_t start = micros();
+    for (int i = 0; i < FS_BENCH_FILES; i++) {
+        snprintf(path, sizeof(path), "/bench/f%02d", i);
+        File file = fs.open(path, "w", true);
+        if (!file) {
+            Serial.printf("VFS: %s failed to create %s\n", name, path);
+            fs.end();
+            return false;
+        }
+        file.write(buffer, FS_BENCH_FILE_SIZE);
+        file.close();
+    }
+    result.createUs = micros() - start;
+
+    fs.end();
+    start = micros();
+    bool remounted = fs.begin(false, FS_BENCH_MOUNT_POINT, FS_BENCH_MAX_OPEN, FS_BENCH_PARTITION);
+    result.remountUs = micros() - start;
+    if (!remounted) {
+        Serial.printf("VFS: %s failed to remount\n", name);
+        return false;
+    }
+
+    start = micros();
+    for (int i = 0; i < FS_BENCH_FILES; i++) {
+        snprintf(path, sizeof(path), "/bench/f%02d", i);
+        fs.exists(path);
+        snprintf(path, sizeof(path), "/bench/m%02d", i);
+        fs.exists(path);
+    }
+    result.lookupUs = micros() - start;
+
+    start = micros();
+    for (int i = 0; i < FS_BENCH_FILES; i++) {
+        snprintf(path, sizeof(path), "/bench/f%02d", i);
+        File file = fs.open(path, "w");
+        file.write(buffer, FS_BENCH_FILE_SIZE);
+        file.close();
+    }
+    result.replaceUs = micros() - start;
+
+    start = micros();
+    for (int i = 0; i < FS_BENCH_FILES; i++) {
+        snprintf(path, sizeof(path), "/bench/f%02d", i);
+        vfsReplaceName(backend, path, VFS_TEMP_KIND, temp, sizeof(temp));
+        File file = fs.open(temp, "w", true);
+        file.write(buffer, FS_BENCH_FILE_SIZE);
+        file.flush();
+        file.close();
+        if (!vfsReplace(&fs, backend, temp, path)) {
+            Serial.printf("VFS: %s failed to replace %s\n", name, path);
+        }
+    }
+    result.atomicReplaceUs = micros() - start;
+
+    // Untimed setup: the file being updated in place
+    File file = fs.open(FS_BENCH_RANDOM_FILE, "w", true);
+    for (int written = 0; file && written < FS_BENCH_RANDOM_FILE_SIZE; written += FS_BENCH_FILE_SIZE) {
+        file.write(buffer, FS_BENCH_FILE_SIZE);
+    }
+    file.close();
+
+    uint32_t seed = 1;
+    start = micros();
+    for (int i = 0; i < FS_BENCH_RANDOM_WRITES; i++) {
+        uint32_t offset = (benchRandom(seed) % (FS_BENCH_RANDOM_FILE_SIZE / FS_BENCH_RANDOM_CHUNK)) *
+                          FS_BENCH_RANDOM_CHUNK;
+        file = fs.open(FS_BENCH_RANDOM_FILE, "r+");
+        if (file) {
+            file.seek(offset);
+            file.write(buffer, FS_BENCH_RANDOM_CHUNK);
+            file.close();
+        }
+    }
+    result.randomWriteUs = micros() - start;
+
+    start = micros();
+    for (int i = 0; i < FS_BENCH_FILES; i++) {
+        snprintf(path, sizeof(path), "/bench/f%02d", i);
+        fs.remove(path);
+    }
+    result.deleteUs = micros() - start;
+
+    fs.format();
+    fs.end();
+    return true;
+}
+
+bool vfsRunBenchmark() {
+    if (!esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                  FS_BENCH_PARTITION)) {
+        Serial.printf("VFS: No '%s' data partition; flash the bench environment\n",
+                      FS_BENCH_PARTITION);
+        return false;
+    }
+
+    uint8_t* buffer = (uint8_t*)malloc(FS_BENCH_FILE_SIZE);
+    if (!buffer) {
+        Serial.println("VFS: Failed to allocate benchmark buffer");
+        return false;
+    }
+    for (int i = 0; i < FS_BENCH_FILE_SIZE; i++) {
+        buffer[i] = (uint8_t)i;
+    }
+
+    Serial.printf("Benchmarking on '%s': %d x %d byte files, %d random %d byte writes\n",
+                  FS_BENCH_PARTITION, FS_BENCH_FILES, FS_BENCH_FILE_SIZE,
+                  FS_BENCH_RANDOM_WRITES, FS_BENCH_RANDOM_CHUNK);
+
+    BenchResult spiffs, littlefs;
+    bool ok = benchBackend<fs::SPIFFSFS>("SPIFFS", &vfsSpiffs, buffer, spiffs) &&
+              benchBackend<fs::LittleFSFS>("LittleFS", &vfsLittleFS, buffer, littlefs);
+    free(buffer);
+    if (!ok) {
+        return false;
+    }
+
+    Serial.println("Operation          SPIFFS (ms)   LittleFS (ms)");
+    Serial.println("-----------------------------------------------");
+    Serial.printf("Create files       %11.1f   %13.1f\n", spiffs.createUs / 1000.0, littlefs.createUs / 1000.0);
+    Serial.printf("Mount              %11.1f   %13.1f\n", spiffs.remountUs / 1000.0, littlefs.remountUs / 1000.0);
+    Serial.printf("Lookups            %11.1f   %13.1f\n", spiffs.lookupUs / 1000.0, littlefs.lookupUs / 1000.0);
+    Serial.printf("Replace in place   %11.1f   %13.1f\n", spiffs.replaceUs / 1000.0, littlefs.replaceUs / 1000.0);
+    Serial.printf("Replace atomically %11.1f   %13.1f\n", spiffs.atomicReplaceUs / 1000.0, littlefs.atomicReplaceUs / 1000.0);
+    Serial.printf("Random writes      %11.1f   %13.1f\n", spiffs.randomWriteUs / 1000.0, littlefs.randomWriteUs / 1000.0);
+    Serial.printf("Delete files       %11.1f   %13.1f\n", spiffs.deleteUs / 1000.0, littlefs.deleteUs / 1000.0);
+    Serial.printf("Active backend: %s\n", vfsActive()->name);
+    return true;
+}
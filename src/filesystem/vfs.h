@@ -0,0 +1,58 @@
+/*
+ * ESP32-OS VFS Header
+ * Storage backend table so FileSystem is not tied to one flash file system
+ */
+
+#ifndef VFS_H
+#define VFS_H
+
+#include <Arduino.h>
+#include "FS.h"
+#include "../config/config.h"
+#include "../kernel/mount.h"
+
+// Atomic replace: data goes to a temp name beside path and is renamed over
+// path once complete. Backends that cannot rename over an existing file
+// first rename the temp to a commit name, which marks it complete for
+// mount-time recovery. Both are path + "~", four hex digits of the path's
+// hash and the kind, so recovery only touches names it made itself.
+#define VFS_REPLACE_TAG_LENGTH 6
+#define VFS_TEMP_KIND 't'
+#define VFS_COMMIT_KIND 'c'
+
+// One entry per flash file system. FileSystem only talks to the fs::FS
+// handle and these hooks, never to a backend's global object.
+struct VfsBackend {
+    const char* name;                   // Also the mount table volume name
+    fs::FS* fs;
+    VolumeMountFunction_t mount;
+    VolumeUnmountFunction_t unmount;
+    bool (*format)();
+    size_t (*totalBytes)();
+    size_t (*usedBytes)();
+    bool realDirectories;               // mkdir/rmdir instead of /.dir markers
+    uint32_t allocationUnit;            // Bytes a file grows by on flash, for usage estimates
+    bool replacingRename;               // rename() atomically replaces an existing target
+    uint16_t maxNameLength;             // Whole path on SPIFFS, one component with real directories
+};
+
+extern const VfsBackend vfsSpiffs;
+extern const VfsBackend vfsLittleFS;
+
+// Backend selected by FS_BACKEND
+const VfsBackend* vfsActive();
+
+// Temp or commit name for path; false when the backend can't store it
+bool vfsReplaceName(const VfsBackend* backend, const char* path, char kind, char* name, size_t size);
+// Target and kind of a name vfsReplaceName made; false for anything else
+bool vfsReplaceTarget(const char* name, char* target, size_t size, char& kind);
+
+// Moves a complete, closed temp file over path. Without room for the
+// commit name the target is replaced in place, unprotected.
+bool vfsReplace(fs::FS* volume, const VfsBackend* backend, const char* temp, const char* path);
+
+// Formats FS_BENCH_PARTITION with each backend in turn and times the same
+// workload on both. Never touches the live data partition.
+bool vfsRunBenchmark();
+
+#endif // VFS_H
@@ -7,9 +7,14 @@
 #include <esp_sleep.h>
 #include <esp_task_wdt.h>
 #include <driver/adc.h>
+#include "../kernel/kernel.h"
+
+volatile uint32_t HAL::lastButtonEdge = 0;
 
 HAL::HAL() : initialized(false), ledState(false), lastButtonPress(0),
-             temperature(0.0), vccVoltage(0) {
+             temperature(0.0), vccVoltage(0), blinkOnTime(0), blinkOffTime(0),
+             blinkSteps(0), blinkRestoreState(false) {
+    TimerService::setup(&blinkTimer, blinkStep, this);
 }
 
 HAL::~HAL() {
@@ -44,9 +49,14 @@ void HAL::shutdown() {
         return;
     }
     
-    // Turn off LED
+    // Stop any blink in progress and turn off LED
+    if (kernel && kernel->getTimerService()) {
+        kernel->getTimerService()->cancel(&blinkTimer);
+    }
     setLED(false);
     
+    detachInterrupt(digitalPinToInterrupt(HAL_BUTTON_PIN));
+    
     // Disable watchdog
     disableWatchdog();
     
@@ -59,8 +69,31 @@ void HAL::initGPIO() {
     digitalWrite(HAL_LED_PIN, LOW);
     ledState = false;
     
-    // Initialize button pin
+    // Initialize button pin; presses are published on the kernel event bus
     pinMode(HAL_BUTTON_PIN, INPUT_PULLUP);
+    armButton();
+}
+
+void HAL::armButton() {
+    attachInterrupt(digitalPinToInterrupt(HAL_BUTTON_PIN), buttonISR, FALLING);
+}
+
+void IRAM_ATTR HAL::buttonISR() {
+    uint32_t now = millis();
+    if (now - lastButtonEdge < 50) { // 50ms debounce
+        return;
+    }
+    lastButtonEdge = now;
+    PowerManager::notifyActivity();
+    
+    // The kernel may not be up yet during early boot
+    if (kernel && kernel->getEventBus()) {
+        BaseType_t woken = pdFALSE;
+        kernel->getEventBus()->publishFromISR(EVENT_BUTTON_PRESSED, HAL_BUTTON_PIN, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
 }
 
 void HAL::initADC() {
@@ -89,16 +122,47 @@ void HAL::toggleLED() {
 void HAL::blinkLED(uint16_t onTime, uint16_t offTime, uint8_t count) {
     if (!initialized) return;
     
-    bool originalState = ledState;
+    TimerService* timers = kernel ? kernel->getTimerService() : nullptr;
+    if (!timers) {
+        // Before the kernel is up: blink inline
+        bool originalState = ledState;
+        
+        for (uint8_t i = 0; i < count; i++) {
+            setLED(true);
+            delay(onTime);
+            setLED(false);
+            delay(offTime);
+        }
+        
+        setLED(originalState);
+        return;
+    }
+    
+    // Restarting mid-blink keeps the state from before the first blink
+    if (!TimerService::isPending(&blinkTimer)) {
+        blinkRestoreState = ledState;
+    }
+    timers->cancel(&blinkTimer);
     
-    for (uint8_t i = 0; i < count; i++) {
-        setLED(true);
-        delay(onTime);
-        setLED(false);
-        delay(offTime);
+    blinkOnTime = onTime;
+    blinkOffTime = offTime;
+    blinkSteps = count * 2;
+    blinkStep(this);
+}
+
+void HAL::blinkStep(void* arg) {
+    HAL* self = (HAL*)arg;
+    
+    if (self->blinkSteps == 0) {
+        self->setLED(self->blinkRestoreState);
+        return;
     }
     
-    setLED(originalState);
+    // Even steps switch on, odd steps switch off
+    bool on = (self->blinkSteps % 2) == 0;
+    self->setLED(on);
+    self->blinkSteps--;
+    kernel->getTimerService()->start(&self->blinkTimer, on ? self->blinkOnTime : self->blinkOffTime);
 }
 
 bool HAL::isButtonPressed() {
@@ -8,6 +8,7 @@
 
 #include <Arduino.h>
 #include "../config/config.h"
+#include "../kernel/timerwheel.h"
 
 // GPIO pin definitions
 #define HAL_LED_PIN LED_BUILTIN_PIN
@@ -23,7 +24,19 @@ private:
     float temperature;
     uint32_t vccVoltage;
     
+    // Non-blocking blink driven by the kernel timer service
+    SoftTimer blinkTimer;
+    uint16_t blinkOnTime;
+    uint16_t blinkOffTime;
+    uint16_t blinkSteps;
+    bool blinkRestoreState;
+    static void blinkStep(void* arg);
+    
+    static volatile uint32_t lastButtonEdge;
+    static void IRAM_ATTR buttonISR();
+    
     void initGPIO();
+    static void armButton();
     void initADC();
     void initPWM();
     
@@ -43,6 +56,8 @@ public:
     // Button input
     bool isButtonPressed();
     bool wasButtonPressed(); // Debounced
+    // Light sleep's level wake-up replaces the button's edge interrupt
+    static void restoreButtonInterrupt() { armButton(); }
     
     // Analog input
     uint16_t readAnalog(uint8_t pin);
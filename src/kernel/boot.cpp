@@ -0,0 +1,296 @@
+/*
+ * ESP32-OS Boot Sequencer Implementation
+ */
+
+#include "boot.h"
+#include "checksum.h"
+
+#define BOOT_RECORD_MAGIC 0x424F4F54 // "BOOT"
+
+static_assert(BOOT_MAX_STAGES <= 24, "Event groups carry at most 24 stage bits");
+
+// Survives software resets and watchdog reboots, not power cycles
+static RTC_NOINIT_ATTR BootRecord bootRecord;
+
+struct BootStageContext {
+    BootSequencer* sequencer;
+    int index;
+};
+static BootStageContext stageContexts[BOOT_MAX_STAGES];
+
+static uint32_t recordChecksum(const BootRecord& record) {
+    // Everything but the checksum itself
+    return fnv1a(&record, offsetof(BootRecord, checksum));
+}
+
+BootSequencer::BootSequencer() : stageCount(0), completed(nullptr), startUs(0),
+                                 readyUs(0), warm(false), failedStage(-1), hasPrevious(false) {
+    memset(stages, 0, sizeof(stages));
+    memset(&previous, 0, sizeof(previous));
+}
+
+BootSequencer::~BootSequencer() {
+    if (completed) {
+        vEventGroupDelete(completed);
+        completed = nullptr;
+    }
+}
+
+int BootSequencer::addStage(const char* name, BootStageFunction_t function, void* arg,
+                            uint32_t dependsOn, uint8_t flags) {
+    if (!name || !function || stageCount >= BOOT_MAX_STAGES) {
+        return -1;
+    }
+
+    // Dependencies must refer to stages that were already declared
+    if (dependsOn & ~((1UL << stageCount) - 1)) {
+        Serial.printf("Boot: Stage '%s' depends on an undeclared stage\n", name);
+        return -1;
+    }
+
+    BootStage& stage = stages[stageCount];
+    strncpy(stage.name, name, sizeof(stage.name) - 1);
+    stage.function = function;
+    stage.arg = arg;
+    stage.dependsOn = dependsOn;
+    stage.flags = flags;
+    stage.state = BOOT_STAGE_PENDING;
+    stage.core = -1;
+
+    return stageCount++;
+}
+
+void BootSequencer::executeStage(int index) {
+    BootStage& stage = stages[index];
+
+    stage.core = xPortGetCoreID();
+    stage.state = BOOT_STAGE_RUNNING;
+    uint32_t begin = micros();
+    stage.startUs = begin - startUs;
+
+    bool ok = stage.function(stage.arg);
+
+    stage.durationUs = micros() - begin;
+    stage.state = ok ? BOOT_STAGE_OK : BOOT_STAGE_FAILED;
+
+    Serial.printf("[%s] %s (%.1f ms, core %d)\n",
+                  ok ? "OK" : ((stage.flags & BOOT_STAGE_CRITICAL) ? "FAIL" : "WARN"),
+                  stage.name, stage.durationUs / 1000.0, stage.core);
+}
+
+void BootSequencer::stageTask(void* parameter) {
+    BootStageContext* context = (BootStageContext*)parameter;
+    BootSequencer* self = context->sequencer;
+
+    self->executeStage(context->index);
+    xEventGroupSetBits(self->completed, BOOT_DEP(context->index));
+
+    vTaskDelete(NULL);
+}
+
+bool BootSequencer::launchStage(int index, int helperCount) {
+    // Spread helpers over the cores, starting with the one the boot task is not on
+    int core = (xPortGetCoreID() + 1 + helperCount) % portNUM_PROCESSORS;
+    char taskName[20];
+    snprintf(taskName, sizeof(taskName), "boot_%s", stages[index].name);
+
+    stageContexts[index].sequencer = this;
+    stageContexts[index].index = index;
+
+    return xTaskCreatePinnedToCore(stageTask, taskName, BOOT_STAGE_STACK_SIZE,
+                                   &stageContexts[index], BOOT_STAGE_PRIORITY,
+                                   nullptr, core) == pdPASS;
+}
+
+bool BootSequencer::run() {
+    loadPrevious();
+
+    completed = xEventGroupCreate();
+    if (!completed) {
+        Serial.println("Boot: Failed to create event group");
+        return false;
+    }
+
+    startUs = micros();
+    uint32_t allStages = (1UL << stageCount) - 1;
+    uint32_t launched = 0;
+    uint32_t finished = 0;
+    uint32_t succeeded = 0;
+    int helperCount = 0;
+
+    while (finished != allStages) {
+        // Collect stages completed by helper tasks
+        uint32_t done = xEventGroupGetBits(completed) & launched & ~finished;
+        for (int i = 0; i < stageCount; i++) {
+            if (done & BOOT_DEP(i)) {
+                finished |= BOOT_DEP(i);
+                if (stages[i].state == BOOT_STAGE_OK) {
+                    succeeded |= BOOT_DEP(i);
+                }
+            }
+        }
+
+        // Dispatch every stage whose dependencies are satisfied
+        int inlineStage = -1;
+        bool progressed = done != 0;
+        for (int i = 0; i < stageCount; i++) {
+            BootStage& stage = stages[i];
+            if (launched & BOOT_DEP(i)) {
+                continue;
+            }
+
+            if ((stage.dependsOn & finished) & ~succeeded) {
+                // A dependency failed; nothing downstream can run
+                stage.state = BOOT_STAGE_SKIPPED;
+                launched |= BOOT_DEP(i);
+                finished |= BOOT_DEP(i);
+                progressed = true;
+                Serial.printf("[SKIP] %s (dependency failed)\n", stage.name);
+                continue;
+            }
+            if (stage.dependsOn & ~succeeded) {
+                continue;
+            }
+
+            if (stage.flags & BOOT_STAGE_INLINE) {
+                if (inlineStage < 0) {
+                    inlineStage = i;
+                }
+                continue;
+            }
+
+            launched |= BOOT_DEP(i);
+            progressed = true;
+            if (launchStage(i, helperCount)) {
+                helperCount++;
+            } else {
+                // No memory for a helper: run it here instead
+                executeStage(i);
+                xEventGroupSetBits(completed, BOOT_DEP(i));
+            }
+        }
+
+        if (inlineStage >= 0) {
+            launched |= BOOT_DEP(inlineStage);
+            executeStage(inlineStage);
+            xEventGroupSetBits(completed, BOOT_DEP(inlineStage));
+            continue;
+        }
+
+        if (!progressed) {
+            uint32_t running = launched & ~finished;
+            if (running == 0) {
+                break; // Nothing can make progress
+            }
+            xEventGroupWaitBits(completed, running, pdFALSE, pdFALSE, portMAX_DELAY);
+        }
+    }
+
+    vEventGroupDelete(completed);
+    completed = nullptr;
+
+    for (int i = 0; i < stageCount; i++) {
+        if ((stages[i].flags & BOOT_STAGE_CRITICAL) && stages[i].state != BOOT_STAGE_OK) {
+            failedStage = i;
+            return false;
+        }
+    }
+    return true;
+}
+
+void BootSequencer::markReady(bool warm) {
+    readyUs = micros();
+    this->warm = warm;
+    saveRecord();
+}
+
+const char* BootSequencer::getFailedStage() const {
+    return failedStage >= 0 ? stages[failedStage].name : nullptr;
+}
+
+void BootSequencer::loadPrevious() {
+    hasPrevious = bootRecord.magic == BOOT_RECORD_MAGIC &&
+                  bootRecord.stageCount <= BOOT_MAX_STAGES &&
+                  bootRecord.checksum == recordChecksum(bootRecord);
+    if (hasPrevious) {
+        previous = bootRecord;
+    }
+}
+
+void BootSequencer::saveRecord() {
+    BootRecord record;
+    memset(&record, 0, sizeof(record));
+
+    record.magic = BOOT_RECORD_MAGIC;
+    record.bootCount = hasPrevious ? previous.bootCount + 1 : 1;
+    record.stageCount = stageCount;
+    for (int i = 0; i < stageCount; i++) {
+        strncpy(record.names[i], stages[i].name, sizeof(record.names[i]) - 1);
+        record.durationUs[i] = stages[i].durationUs;
+    }
+    record.readyUs = readyUs;
+    record.coldReadyUs = warm ? (hasPrevious ? previous.coldReadyUs : 0) : readyUs;
+    record.warmReadyUs = warm ? readyUs : (hasPrevious ? previous.warmReadyUs : 0);
+    record.checksum = recordChecksum(record);
+
+    bootRecord = record;
+}
+
+uint32_t BootSequencer::previousDuration(const char* name) {
+    if (!hasPrevious) {
+        return 0;
+    }
+
+    for (int i = 0; i < previous.stageCount; i++) {
+        if (strcmp(previous.names[i], name) == 0) {
+            return previous.durationUs[i];
+        }
+    }
+    return 0;
+}
+
+void BootSequencer::printTimings() {
+    static const char* stateNames[] = {"pending", "running", "ok", "failed", "skipped"};
+
+    Serial.println("Boot Timings (ms):");
+    Serial.println("Stage            State    Core    Start  Duration  Previous");
+    Serial.println("------------------------------------------------------------");
+
+    for (int i = 0; i < stageCount; i++) {
+        const BootStage& stage = stages[i];
+        uint32_t prev = previousDuration(stage.name);
+
+        Serial.printf("%-16s %-8s %4d %8.1f %9.1f ",
+                      stage.name,
+                      stateNames[stage.state],
+                      stage.core,
+                      stage.startUs / 1000.0,
+                      stage.durationUs / 1000.0);
+        if (hasPrevious) {
+            Serial.printf("%9.1f\n", prev / 1000.0);
+        } else {
+            Serial.println("        -");
+        }
+    }
+
+    if (readyUs > 0) {
+        Serial.printf("Time to prompt:  %.1f ms", readyUs / 1000.0);
+        if (hasPrevious && previous.readyUs > 0) {
+            Serial.printf(" (previous boot: %.1f ms)", previous.readyUs / 1000.0);
+        }
+        Serial.println();
+    }
+    if (readyUs > 0) {
+        uint32_t cold = warm ? (hasPrevious ? previous.coldReadyUs : 0) : readyUs;
+        uint32_t warmUs = warm ? readyUs : (hasPrevious ? previous.warmReadyUs : 0);
+        Serial.printf("Last cold boot:  %.1f ms to prompt\n", cold / 1000.0);
+        if (warmUs > 0) {
+            Serial.printf("Last warm boot:  %.1f ms to prompt\n", warmUs / 1000.0);
+        } else {
+            Serial.println("Last warm boot:  -");
+        }
+    }
+    if (hasPrevious) {
+        Serial.printf("Boots since power-on: %u\n", previous.bootCount + 1);
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * ESP32-OS Boot Sequencer Header
+ * Dependency-ordered, parallel init stages with per-stage timing
+ */
+
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+#include "../config/config.h"
+
+#define BOOT_NO_DEPS 0
+#define BOOT_DEP(stage) (1UL << (stage))
+
+// Stage flags
+#define BOOT_STAGE_CRITICAL 0x01  // Boot fails if this stage fails
+#define BOOT_STAGE_INLINE   0x02  // Must run on the boot task (e.g. watchdog setup)
+
+typedef bool (*BootStageFunction_t)(void* arg);
+
+enum BootStageState {
+    BOOT_STAGE_PENDING = 0,
+    BOOT_STAGE_RUNNING,
+    BOOT_STAGE_OK,
+    BOOT_STAGE_FAILED,
+    BOOT_STAGE_SKIPPED
+};
+
+struct BootStage {
+    char name[16];
+    BootStageFunction_t function;
+    void* arg;
+    uint32_t dependsOn;     // Mask of BOOT_DEP() bits
+    uint8_t flags;
+
+    // Results
+    volatile BootStageState state;
+    int8_t core;
+    uint32_t startUs;       // Relative to sequencer start
+    uint32_t durationUs;
+};
+
+// Timings kept in RTC memory so the previous boot can be compared
+struct BootRecord {
+    uint32_t magic;
+    uint32_t bootCount;
+    uint8_t stageCount;
+    char names[BOOT_MAX_STAGES][16];
+    uint32_t durationUs[BOOT_MAX_STAGES];
+    uint32_t readyUs;       // Time to first prompt, from app start
+    uint32_t coldReadyUs;   // Latest of each kind, so the two can be compared
+    uint32_t warmReadyUs;
+    uint32_t checksum;
+};
+
+class BootSequencer {
+private:
+    BootStage stages[BOOT_MAX_STAGES];
+    uint8_t stageCount;
+    EventGroupHandle_t completed;
+    uint32_t startUs;
+    uint32_t readyUs;
+    bool warm;
+    int failedStage;
+
+    BootRecord previous;
+    bool hasPrevious;
+
+    void executeStage(int index);
+    bool launchStage(int index, int helperCount);
+    static void stageTask(void* parameter);
+
+    void loadPrevious();
+    void saveRecord();
+    uint32_t previousDuration(const char* name);
+
+public:
+    BootSequencer();
+    ~BootSequencer();
+
+    // Returns the stage id for use with BOOT_DEP(), or -1
+    int addStage(const char* name, BootStageFunction_t function, void* arg,
+                 uint32_t dependsOn, uint8_t flags = 0);
+
+    // Runs all stages; false if a critical stage failed or was skipped
+    bool run();
+    void markReady(bool warm);
+
+    const char* getFailedStage() const;
+    uint32_t getReadyTimeUs() const { return readyUs; }
+    void printTimings();
+};
+
+#endif // BOOT_H
@@ -0,0 +1,21 @@
+/*
+ * ESP32-OS Checksum Header
+ * FNV-1a hashing for records kept across resets
+ */
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+inline uint32_t fnv1a(const void* data, size_t len, uint32_t hash = 2166136261UL) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+#endif // CHECKSUM_H
@@ -0,0 +1,253 @@
+/*
+ * ESP32-OS Event Bus Implementation
+ */
+
+#include "eventbus.h"
+#include "kernel.h"
+#include "postmortem.h"
+#include <WiFi.h>
+
+static const char* topicNames[EVENT_TOPIC_COUNT] = {
+    "low_memory",
+    "memory_recovered",
+    "button_pressed",
+    "wifi_connected",
+    "wifi_lost",
+    "fs_full"
+};
+
+static void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+    // Runs on the WiFi event loop task
+    if (!kernel || !kernel->getEventBus()) {
+        return;
+    }
+
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+        kernel->getEventBus()->publish(EVENT_WIFI_CONNECTED);
+    } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+        kernel->getEventBus()->publish(EVENT_WIFI_LOST);
+    }
+}
+
+EventBus::EventBus() : busMutex(nullptr) {
+    for (int i = 0; i < EVENT_MAX_SUBSCRIBERS; i++) {
+        subscribers[i].active = false;
+        subscribers[i].callback = nullptr;
+        subscribers[i].context = nullptr;
+        subscribers[i].queue = nullptr;
+    }
+    for (int i = 0; i < EVENT_TOPIC_COUNT; i++) {
+        topicStats[i].published.store(0);
+        topicStats[i].delivered.store(0);
+        topicStats[i].dropped.store(0);
+    }
+}
+
+EventBus::~EventBus() {
+    shutdown();
+}
+
+bool EventBus::init() {
+    busMutex = xSemaphoreCreateMutex();
+    if (!busMutex) {
+        Serial.println("EventBus: Failed to create mutex");
+        return false;
+    }
+
+    WiFi.onEvent(onWiFiEvent);
+
+    Serial.println("EventBus: Event bus initialized");
+    return true;
+}
+
+void EventBus::shutdown() {
+    for (int i = 0; i < EVENT_MAX_SUBSCRIBERS; i++) {
+        subscribers[i].active = false;
+    }
+
+    if (busMutex) {
+        vSemaphoreDelete(busMutex);
+        busMutex = nullptr;
+    }
+}
+
+int EventBus::addSubscriber(EventTopic topic, EventCallback_t callback, void* context,
+                            QueueHandle_t queue) {
+    if (topic >= EVENT_TOPIC_COUNT || !busMutex) {
+        return -1;
+    }
+
+    if (xSemaphoreTake(busMutex, 1000) != pdTRUE) {
+        return -1;
+    }
+
+    int id = -1;
+    for (int i = 0; i < EVENT_MAX_SUBSCRIBERS; i++) {
+        if (!subscribers[i].active) {
+            subscribers[i].topic = topic;
+            subscribers[i].callback = callback;
+            subscribers[i].context = context;
+            subscribers[i].queue = queue;
+            // Publishers scan without locking; publish the slot last
+            std::atomic_thread_fence(std::memory_order_release);
+            subscribers[i].active = true;
+            id = i;
+            break;
+        }
+    }
+
+    xSemaphoreGive(busMutex);
+
+    if (id < 0) {
+        Serial.println("EventBus: No free subscriber slots available");
+    }
+    return id;
+}
+
+int EventBus::subscribe(EventTopic topic, EventCallback_t callback, void* context) {
+    if (!callback) {
+        return -1;
+    }
+    return addSubscriber(topic, callback, context, nullptr);
+}
+
+int EventBus::subscribeQueue(EventTopic topic, QueueHandle_t queue) {
+    if (!queue) {
+        return -1;
+    }
+    return addSubscriber(topic, nullptr, nullptr, queue);
+}
+
+bool EventBus::unsubscribe(int id) {
+    if (id < 0 || id >= EVENT_MAX_SUBSCRIBERS || !busMutex) {
+        return false;
+    }
+
+    if (xSemaphoreTake(busMutex, 1000) != pdTRUE) {
+        return false;
+    }
+
+    // A publish already scanning may still deliver one last event
+    bool wasActive = subscribers[id].active;
+    subscribers[id].active = false;
+
+    xSemaphoreGive(busMutex);
+    return wasActive;
+}
+
+void EventBus::publish(EventTopic topic, uint32_t value) {
+    if (topic >= EVENT_TOPIC_COUNT) {
+        return;
+    }
+
+    Event event;
+    event.topic = topic;
+    event.value = value;
+    event.timestamp = millis();
+
+    EventTopicStats& stats = topicStats[topic];
+    stats.published.fetch_add(1, std::memory_order_relaxed);
+    Postmortem::trace(TRACE_EVENT, value, topicNames[topic]);
+
+    for (int i = 0; i < EVENT_MAX_SUBSCRIBERS; i++) {
+        const EventSubscriber& sub = subscribers[i];
+        if (!sub.active || sub.topic != topic) {
+            continue;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (sub.callback) {
+            sub.callback(event, sub.context);
+            stats.delivered.fetch_add(1, std::memory_order_relaxed);
+        } else if (sub.queue) {
+            // Never block the publisher on a slow consumer
+            if (xQueueSend(sub.queue, &event, 0) == pdTRUE) {
+                stats.delivered.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                stats.dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void IRAM_ATTR EventBus::publishFromISR(EventTopic topic, uint32_t value,
+                                        BaseType_t* higherPriorityTaskWoken) {
+    if (topic >= EVENT_TOPIC_COUNT) {
+        return;
+    }
+
+    Event event;
+    event.topic = topic;
+    event.value = value;
+    event.timestamp = xTaskGetTickCountFromISR() * portTICK_PERIOD_MS;
+
+    EventTopicStats& stats = topicStats[topic];
+    stats.published.fetch_add(1, std::memory_order_relaxed);
+
+    for (int i = 0; i < EVENT_MAX_SUBSCRIBERS; i++) {
+        const EventSubscriber& sub = subscribers[i];
+        if (!sub.active || sub.topic != topic) {
+            continue;
+        }
+
+        if (sub.queue && xQueueSendFromISR(sub.queue, &event, higherPriorityTaskWoken) == pdTRUE) {
+            stats.delivered.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            stats.dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+uint32_t EventBus::getTotalPublished() {
+    uint32_t total = 0;
+    for (int i = 0; i < EVENT_TOPIC_COUNT; i++) {
+        total += topicStats[i].published.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint32_t EventBus::getTotalDropped() {
+    uint32_t total = 0;
+    for (int i = 0; i < EVENT_TOPIC_COUNT; i++) {
+        total += topicStats[i].dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+static uint32_t samplePublished(void* context) { return ((EventBus*)context)->getTotalPublished(); }
+static uint32_t sampleDropped(void* context) { return ((EventBus*)context)->getTotalDropped(); }
+
+void EventBus::registerMetrics(MetricsRegistry* registry) {
+    if (!registry) {
+        return;
+    }
+
+    registry->registerCounter("events_published_total", samplePublished, this);
+    registry->registerCounter("events_dropped_total", sampleDropped, this);
+}
+
+const char* EventBus::getTopicName(EventTopic topic) {
+    return topic < EVENT_TOPIC_COUNT ? topicNames[topic] : "unknown";
+}
+
+void EventBus::printStatistics() {
+    int subscriberCounts[EVENT_TOPIC_COUNT] = {0};
+    for (int i = 0; i < EVENT_MAX_SUBSCRIBERS; i++) {
+        if (subscribers[i].active) {
+            subscriberCounts[subscribers[i].topic]++;
+        }
+    }
+
+    Serial.println("Event Bus Topics:");
+    Serial.println("Topic              Subs  Published  Delivered  Dropped");
+    Serial.println("-------------------------------------------------------");
+
+    for (int i = 0; i < EVENT_TOPIC_COUNT; i++) {
+        Serial.printf("%-18s %4d %10u %10u %8u\n",
+                      topicNames[i],
+                      subscriberCounts[i],
+                      topicStats[i].published.load(std::memory_order_relaxed),
+                      topicStats[i].delivered.load(std::memory_order_relaxed),
+                      topicStats[i].dropped.load(std::memory_order_relaxed));
+    }
+}
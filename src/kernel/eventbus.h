@@ -0,0 +1,83 @@
+/*
+ * ESP32-OS Event Bus Header
+ * Typed publish/subscribe topics with allocation-free fan-out
+ */
+
+#ifndef EVENTBUS_H
+#define EVENTBUS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <atomic>
+#include "../config/config.h"
+#include "metrics.h"
+
+enum EventTopic {
+    EVENT_LOW_MEMORY = 0,       // value: free heap bytes
+    EVENT_MEMORY_RECOVERED,     // value: free heap bytes
+    EVENT_BUTTON_PRESSED,       // value: GPIO pin
+    EVENT_WIFI_CONNECTED,
+    EVENT_WIFI_LOST,
+    EVENT_FS_FULL,              // value: usage percent
+    EVENT_TOPIC_COUNT
+};
+
+struct Event {
+    EventTopic topic;
+    uint32_t value;
+    uint32_t timestamp;         // millis() at publish
+};
+
+typedef void (*EventCallback_t)(const Event& event, void* context);
+
+struct EventSubscriber {
+    EventTopic topic;
+    EventCallback_t callback;   // Called in the publisher's context...
+    void* context;
+    QueueHandle_t queue;        // ...or the event is copied into this queue
+    volatile bool active;
+};
+
+struct EventTopicStats {
+    std::atomic<uint32_t> published;
+    std::atomic<uint32_t> delivered;
+    std::atomic<uint32_t> dropped;  // Subscriber queue full, or callback skipped in ISR
+};
+
+class EventBus {
+private:
+    EventSubscriber subscribers[EVENT_MAX_SUBSCRIBERS];
+    EventTopicStats topicStats[EVENT_TOPIC_COUNT];
+    SemaphoreHandle_t busMutex;
+
+    int addSubscriber(EventTopic topic, EventCallback_t callback, void* context,
+                      QueueHandle_t queue);
+
+public:
+    EventBus();
+    ~EventBus();
+
+    bool init();
+    void shutdown();
+    void registerMetrics(MetricsRegistry* registry);
+
+    // Subscriptions return an id for unsubscribe(), or -1
+    int subscribe(EventTopic topic, EventCallback_t callback, void* context = nullptr);
+    int subscribeQueue(EventTopic topic, QueueHandle_t queue);
+    bool unsubscribe(int id);
+
+    // Publishing never allocates. From an ISR only queue subscribers are
+    // served; callbacks are counted as dropped.
+    void publish(EventTopic topic, uint32_t value = 0);
+    void IRAM_ATTR publishFromISR(EventTopic topic, uint32_t value,
+                                  BaseType_t* higherPriorityTaskWoken);
+
+    static const char* getTopicName(EventTopic topic);
+    uint32_t getTotalPublished();
+    uint32_t getTotalDropped();
+    void printStatistics();
+};
+
+#endif // EVENTBUS_H
@@ -0,0 +1,336 @@
+/*
+ * ESP32-OS CPU Frequency Governor Implementation
+ */
+
+#include "governor.h"
+#include <esp_timer.h>
+#include <esp_freertos_hooks.h>
+
+static const uint32_t levelMhz[GOVERNOR_LEVEL_COUNT] = {80, 160, 240};
+
+#define GOVERNOR_TOP_LEVEL (GOVERNOR_LEVEL_COUNT - 1)
+
+// Tick interrupts seen per core, and how many of them interrupted the idle task
+static volatile uint32_t tickCount[portNUM_PROCESSORS];
+static volatile uint32_t idleCount[portNUM_PROCESSORS];
+
+Governor::Governor() : timerService(nullptr), levelMutex(nullptr), running(false),
+                       mode(GOVERNOR_AUTO), level(GOVERNOR_TOP_LEVEL),
+                       fixedLevel(GOVERNOR_TOP_LEVEL), lowWindows(0), perfLocks(0),
+                       levelSince(0), transitions(0), transitionCounter(nullptr) {
+#if CONFIG_PM_ENABLE
+    pmLock = nullptr;
+#endif
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        lastTicks[core] = 0;
+        lastIdle[core] = 0;
+        coreLoad[core] = 0;
+    }
+    memset(residencyUs, 0, sizeof(residencyUs));
+}
+
+Governor::~Governor() {
+    shutdown();
+}
+
+bool Governor::init(TimerService* timerService) {
+    if (running) {
+        return true;
+    }
+
+    if (!timerService) {
+        Serial.println("Governor: Timer service required");
+        return false;
+    }
+    this->timerService = timerService;
+
+    levelMutex = xSemaphoreCreateMutex();
+    if (!levelMutex) {
+        Serial.println("Governor: Failed to create mutex");
+        return false;
+    }
+
+#if CONFIG_PM_ENABLE
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "perf", &pmLock) != ESP_OK) {
+        Serial.println("Governor: Failed to create power management lock");
+        return false;
+    }
+#endif
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (esp_register_freertos_tick_hook_for_cpu(tickHook, core) != ESP_OK) {
+            Serial.println("Governor: Failed to register tick hook");
+            return false;
+        }
+        lastTicks[core] = tickCount[core];
+        lastIdle[core] = idleCount[core];
+    }
+
+    level = levelFor(getCpuFrequencyMhz());
+    levelSince = esp_timer_get_time();
+    running = true;
+
+    TimerService::setup(&sampleTimer, sampleTick, this);
+    timerService->start(&sampleTimer, GOVERNOR_INTERVAL_MS);
+
+    Serial.printf("Governor: CPU frequency governor initialized at %u MHz\n", levelMhz[level]);
+    return true;
+}
+
+void Governor::shutdown() {
+    if (!running) {
+        return;
+    }
+
+    running = false;
+    timerService->cancel(&sampleTimer);
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        esp_deregister_freertos_tick_hook_for_cpu(tickHook, core);
+    }
+
+    // Leave the CPU at full speed for whoever runs next
+    if (xSemaphoreTake(levelMutex, portMAX_DELAY) == pdTRUE) {
+        setLevelLocked(GOVERNOR_TOP_LEVEL);
+        xSemaphoreGive(levelMutex);
+    }
+
+#if CONFIG_PM_ENABLE
+    if (pmLock) {
+        esp_pm_lock_delete(pmLock);
+        pmLock = nullptr;
+    }
+#endif
+
+    vSemaphoreDelete(levelMutex);
+    levelMutex = nullptr;
+}
+
+static uint32_t sampleFrequency(void* context) { return ((Governor*)context)->getFrequencyMhz(); }
+static uint32_t sampleLoad(void* context) { return ((Governor*)context)->getLoad(); }
+
+void Governor::registerMetrics(MetricsRegistry* registry) {
+    if (!registry) {
+        return;
+    }
+
+    transitionCounter = registry->registerCounter("cpufreq_transitions_total");
+    registry->registerGauge("cpu_freq_mhz", sampleFrequency, this);
+    registry->registerGauge("cpu_load_percent", sampleLoad, this);
+}
+
+void IRAM_ATTR Governor::tickHook() {
+    int core = xPortGetCoreID();
+    tickCount[core]++;
+    if (xTaskGetCurrentTaskHandleForCPU(core) == xTaskGetIdleTaskHandleForCPU(core)) {
+        idleCount[core]++;
+    }
+}
+
+void Governor::sampleTick(void* arg) {
+    ((Governor*)arg)->evaluate();
+}
+
+uint8_t Governor::levelFor(uint32_t mhz) const {
+    for (uint8_t i = 0; i < GOVERNOR_LEVEL_COUNT; i++) {
+        if (levelMhz[i] >= mhz) {
+            return i;
+        }
+    }
+    return GOVERNOR_TOP_LEVEL;
+}
+
+bool Governor::applyFrequency(uint32_t mhz) {
+#if CONFIG_PM_ENABLE
+    // esp_pm owns the clock: the governor moves the floor, locks hold the ceiling
+    esp_pm_config_esp32_t config;
+    config.max_freq_mhz = levelMhz[GOVERNOR_TOP_LEVEL];
+    config.min_freq_mhz = mhz;
+    config.light_sleep_enable = false;
+    return esp_pm_configure(&config) == ESP_OK;
+#else
+    return setCpuFrequencyMhz(mhz);
+#endif
+}
+
+bool Governor::setLevelLocked(uint8_t next) {
+    if (next == level) {
+        return true;
+    }
+
+    if (!applyFrequency(levelMhz[next])) {
+        Serial.printf("Governor: Failed to switch to %u MHz\n", levelMhz[next]);
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+    residencyUs[level] += now - levelSince;
+    levelSince = now;
+    level = next;
+    transitions++;
+    MetricsRegistry::increment(transitionCounter);
+    return true;
+}
+
+void Governor::evaluate() {
+    if (!running) {
+        return;
+    }
+
+    uint8_t busiest = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        uint32_t ticks = tickCount[core] - lastTicks[core];
+        uint32_t idle = idleCount[core] - lastIdle[core];
+        lastTicks[core] += ticks;
+        lastIdle[core] += idle;
+
+        coreLoad[core] = ticks ? (ticks - idle) * 100 / ticks : 0;
+        if (coreLoad[core] > busiest) {
+            busiest = coreLoad[core];
+        }
+    }
+
+    // Never stall the timer service behind a slow perf lock holder
+    if (xSemaphoreTake(levelMutex, 0) == pdTRUE) {
+        if (mode == GOVERNOR_AUTO && perfLocks.load() == 0) {
+            if (busiest >= GOVERNOR_UP_PERCENT) {
+                // Bursts go straight to the top; the way down is gradual
+                lowWindows = 0;
+                setLevelLocked(GOVERNOR_TOP_LEVEL);
+            } else if (busiest < GOVERNOR_DOWN_PERCENT) {
+                if (level > 0 && ++lowWindows >= GOVERNOR_DOWN_WINDOWS) {
+                    lowWindows = 0;
+                    setLevelLocked(level - 1);
+                }
+            } else {
+                lowWindows = 0;
+            }
+        }
+        xSemaphoreGive(levelMutex);
+    }
+
+    bool settled = level == 0 && busiest < GOVERNOR_DOWN_PERCENT;
+    timerService->start(&sampleTimer, settled ? GOVERNOR_IDLE_INTERVAL_MS : GOVERNOR_INTERVAL_MS);
+}
+
+void Governor::acquirePerformance() {
+    if (!running || perfLocks.fetch_add(1) > 0) {
+        return;
+    }
+
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_acquire(pmLock);
+#endif
+    if (xSemaphoreTake(levelMutex, portMAX_DELAY) == pdTRUE) {
+        setLevelLocked(GOVERNOR_TOP_LEVEL);
+        xSemaphoreGive(levelMutex);
+    }
+}
+
+void Governor::releasePerformance() {
+    uint32_t held = perfLocks.load();
+    while (held > 0 && !perfLocks.compare_exchange_weak(held, held - 1)) {
+    }
+    if (!running || held != 1) {
+        return;
+    }
+
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_release(pmLock);
+#endif
+    // Auto mode decays from the top on its own
+    if (xSemaphoreTake(levelMutex, portMAX_DELAY) == pdTRUE) {
+        lowWindows = 0;
+        if (mode == GOVERNOR_FIXED && perfLocks.load() == 0) {
+            setLevelLocked(fixedLevel);
+        }
+        xSemaphoreGive(levelMutex);
+    }
+}
+
+void Governor::setAuto() {
+    mode = GOVERNOR_AUTO;
+    lowWindows = 0;
+}
+
+bool Governor::setFixed(uint32_t mhz) {
+    uint8_t index = levelFor(mhz);
+    if (!running || levelMhz[index] != mhz) {
+        return false;
+    }
+
+    bool ok = false;
+    if (xSemaphoreTake(levelMutex, portMAX_DELAY) == pdTRUE) {
+        mode = GOVERNOR_FIXED;
+        fixedLevel = index;
+        ok = perfLocks.load() > 0 || setLevelLocked(index);
+        xSemaphoreGive(levelMutex);
+    }
+    return ok;
+}
+
+uint32_t Governor::getFrequencyMhz() const {
+    return levelMhz[level];
+}
+
+uint8_t Governor::getLoad() const {
+    uint8_t busiest = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (coreLoad[core] > busiest) {
+            busiest = coreLoad[core];
+        }
+    }
+    return busiest;
+}
+
+uint64_t Governor::getResidencyUs(uint8_t index) {
+    if (index >= GOVERNOR_LEVEL_COUNT) {
+        return 0;
+    }
+
+    uint64_t total = residencyUs[index];
+    if (index == level) {
+        total += esp_timer_get_time() - levelSince;
+    }
+    return total;
+}
+
+void Governor::printStatistics() {
+    uint64_t residency[GOVERNOR_LEVEL_COUNT];
+    uint64_t total = 0;
+    for (uint8_t i = 0; i < GOVERNOR_LEVEL_COUNT; i++) {
+        residency[i] = getResidencyUs(i);
+        total += residency[i];
+    }
+
+    Serial.println("CPU Frequency Governor:");
+    if (mode == GOVERNOR_AUTO) {
+        Serial.printf("Mode:            auto, up >= %d%%, down < %d%%\n",
+                      GOVERNOR_UP_PERCENT, GOVERNOR_DOWN_PERCENT);
+    } else {
+        Serial.printf("Mode:            fixed at %u MHz\n", levelMhz[fixedLevel]);
+    }
+    Serial.printf("Frequency:       %u MHz\n", levelMhz[level]);
+    Serial.printf("Perf locks:      %u\n", perfLocks.load());
+    Serial.print("Load:           ");
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        Serial.printf(" core%d %u%%", core, coreLoad[core]);
+    }
+    Serial.println();
+    Serial.printf("Transitions:     %u\n", transitions);
+    Serial.println("Level      Time (s)   Share");
+    Serial.println("---------------------------");
+    for (uint8_t i = 0; i < GOVERNOR_LEVEL_COUNT; i++) {
+        Serial.printf("%3u MHz %10.1f %6.1f%%\n", levelMhz[i],
+                      residency[i] / 1000000.0,
+                      total ? residency[i] * 100.0 / total : 0.0);
+    }
+}
+
+void Governor::resetStatistics() {
+    if (levelMutex && xSemaphoreTake(levelMutex, portMAX_DELAY) == pdTRUE) {
+        memset(residencyUs, 0, sizeof(residencyUs));
+        levelSince = esp_timer_get_time();
+        transitions = 0;
+        xSemaphoreGive(levelMutex);
+    }
+}
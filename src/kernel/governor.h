@@ -0,0 +1,110 @@
+/*
+ * ESP32-OS CPU Frequency Governor Header
+ * Load-driven CPU frequency scaling with performance locks
+ */
+
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
+#include "../config/config.h"
+#include "timerwheel.h"
+#include "metrics.h"
+
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+
+// Frequencies that keep the APB clock at 80 MHz, so UART and timers are unaffected
+#define GOVERNOR_LEVEL_COUNT 3
+
+enum GovernorMode {
+    GOVERNOR_AUTO = 0,
+    GOVERNOR_FIXED
+};
+
+class Governor {
+private:
+    TimerService* timerService;
+    SoftTimer sampleTimer;
+    SemaphoreHandle_t levelMutex;
+    volatile bool running;
+    GovernorMode mode;
+    uint8_t level;                  // Index into the level table
+    uint8_t fixedLevel;
+    uint8_t lowWindows;             // Consecutive windows below the down threshold
+    std::atomic<uint32_t> perfLocks;
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t pmLock;
+#endif
+
+    // Load over the last window, sampled at the tick interrupt of each core
+    uint32_t lastTicks[portNUM_PROCESSORS];
+    uint32_t lastIdle[portNUM_PROCESSORS];
+    uint8_t coreLoad[portNUM_PROCESSORS];
+
+    // Residency and transitions, esp_timer microseconds
+    int64_t levelSince;
+    uint64_t residencyUs[GOVERNOR_LEVEL_COUNT];
+    uint32_t transitions;
+    Metric* transitionCounter;
+
+    static void IRAM_ATTR tickHook();
+    static void sampleTick(void* arg);
+
+    void evaluate();
+    bool setLevelLocked(uint8_t next);
+    bool applyFrequency(uint32_t mhz);
+    uint8_t levelFor(uint32_t mhz) const;
+
+public:
+    Governor();
+    ~Governor();
+
+    bool init(TimerService* timerService);
+    void shutdown();
+    void registerMetrics(MetricsRegistry* registry);
+
+    // Performance locks pin the top level until the last one is released.
+    // Task context only; the switch happens before acquire returns.
+    void acquirePerformance();
+    void releasePerformance();
+
+    void setAuto();
+    bool setFixed(uint32_t mhz);
+    GovernorMode getMode() const { return mode; }
+
+    uint32_t getFrequencyMhz() const;
+    uint8_t getLoad() const;        // Busiest core over the last window, percent
+    uint32_t getTransitions() const { return transitions; }
+    uint64_t getResidencyUs(uint8_t index);
+    void printStatistics();
+    void resetStatistics();
+};
+
+// Holds the CPU at its top frequency for the lifetime of the object
+class PerfLock {
+private:
+    Governor* governor;
+
+public:
+    explicit PerfLock(Governor* governor) : governor(governor) {
+        if (governor) {
+            governor->acquirePerformance();
+        }
+    }
+    ~PerfLock() {
+        if (governor) {
+            governor->releasePerformance();
+        }
+    }
+
+private:
+    PerfLock(const PerfLock&);
+    PerfLock& operator=(const PerfLock&);
+};
+
+#endif // GOVERNOR_H
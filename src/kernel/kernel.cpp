@@ -4,16 +4,16 @@
  */
 
 #include "kernel.h"
+#include "../filesystem/fs.h"
 #include <esp_system.h>
 #include <vector>
 #include <string>
-#include <SPIFFS.h>
-#include <SD_MMC.h>
-#include <SD.h>
 #include <TFT_eSPI.h>
 Kernel::Kernel() : scheduler(nullptr), memoryManager(nullptr), 
-                   systemMutex(nullptr), initialized(false), healthy(false),
-                   bootTime(0), uptime(0), totalTasks(0), freeMem(0), minFreeMem(0) {
+                   latencyTracker(nullptr), workQueue(nullptr), mountTable(nullptr),
+                   eventBus(nullptr), metrics(nullptr), postmortem(nullptr), timerService(nullptr), profiler(nullptr), services(nullptr), warmBoot(nullptr), powerManager(nullptr), governor(nullptr), stackTuner(nullptr), systemMutex(nullptr), initialized(false), healthy(false),
+                   bootTime(0), totalTasks(0), uptimeGauge(nullptr), heapFreeGauge(nullptr),
+                   heapMinFreeGauge(nullptr), heapLargestGauge(nullptr), monitorQueued(false) {
 }
 
 Kernel::~Kernel() {
@@ -32,12 +32,42 @@ bool Kernel::init() {
         return false;
     }
     
+    // Pick up state from a warm restart before anything is rebuilt
+    warmBoot = new WarmBoot();
+    if (!warmBoot || !warmBoot->init()) {
+        Serial.println("Kernel: Failed to initialize warm boot state");
+        return false;
+    }
+    
+    // Initialize metrics registry next; every subsystem registers into it
+    metrics = new MetricsRegistry();
+    if (!metrics || !metrics->init()) {
+        Serial.println("Kernel: Failed to initialize metrics registry");
+        return false;
+    }
+    if (warmBoot->isWarm()) {
+        metrics->setBaseline(warmBoot->getRecord().counters, warmBoot->getRecord().counterCount);
+    }
+    uptimeGauge = metrics->registerGauge("uptime_seconds");
+    heapFreeGauge = metrics->registerGauge("heap_free_bytes");
+    heapMinFreeGauge = metrics->registerGauge("heap_min_free_bytes");
+    heapLargestGauge = metrics->registerGauge("heap_largest_block_bytes");
+    
+    // Initialize event bus early so other subsystems can publish during init
+    eventBus = new EventBus();
+    if (!eventBus || !eventBus->init()) {
+        Serial.println("Kernel: Failed to initialize event bus");
+        return false;
+    }
+    eventBus->registerMetrics(metrics);
+    
     // Initialize memory manager
     memoryManager = new MemoryManager();
     if (!memoryManager || !memoryManager->init()) {
         Serial.println("Kernel: Failed to initialize memory manager");
         return false;
     }
+    memoryManager->registerMetrics(metrics);
     
     // Initialize scheduler
     scheduler = new Scheduler();
@@ -45,8 +75,85 @@ bool Kernel::init() {
         Serial.println("Kernel: Failed to initialize scheduler");
         return false;
     }
-    std::vector<std::string> disks;
-    diskList(disks);
+    scheduler->registerMetrics(metrics);
+    
+    // Recover the previous boot's postmortem record and start tracing this one
+    postmortem = new Postmortem();
+    if (!postmortem || !postmortem->init(scheduler, memoryManager, metrics)) {
+        Serial.println("Kernel: Failed to initialize postmortem store");
+        return false;
+    }
+    
+    // Initialize interrupt latency tracker
+    latencyTracker = new LatencyTracker();
+    if (!latencyTracker || !latencyTracker->init()) {
+        Serial.println("Kernel: Failed to initialize latency tracker");
+        return false;
+    }
+    
+    // Initialize deferred work queues and their per-core workers
+    workQueue = new WorkQueue();
+    if (!workQueue || !workQueue->init()) {
+        Serial.println("Kernel: Failed to initialize work queue");
+        return false;
+    }
+    workQueue->registerMetrics(metrics);
+    
+    // Initialize kernel timer service
+    timerService = new TimerService();
+    if (!timerService || !timerService->init()) {
+        Serial.println("Kernel: Failed to initialize timer service");
+        return false;
+    }
+    timerService->registerMetrics(metrics);
+    
+    // Initialize power manager; sleep is bounded by the timer wheel's next event
+    powerManager = new PowerManager();
+    if (!powerManager || !powerManager->init(scheduler, timerService, eventBus)) {
+        Serial.println("Kernel: Failed to initialize power manager");
+        return false;
+    }
+    powerManager->registerMetrics(metrics);
+    
+    // Initialize CPU frequency governor; samples load from the tick interrupt
+    governor = new Governor();
+    if (!governor || !governor->init(timerService)) {
+        Serial.println("Kernel: Failed to initialize CPU frequency governor");
+        return false;
+    }
+    governor->registerMetrics(metrics);
+    
+    // Initialize service registry; subsystems outside the kernel start on demand
+    services = new ServiceRegistry();
+    if (!services || !services->init()) {
+        Serial.println("Kernel: Failed to initialize service registry");
+        return false;
+    }
+    
+    // Initialize sampling profiler; its buffer is allocated on first start
+    profiler = new Profiler();
+    if (!profiler || !profiler->init()) {
+        Serial.println("Kernel: Failed to initialize profiler");
+        return false;
+    }
+    
+    // Initialize mount table; every volume is mounted on first use
+    mountTable = new MountTable();
+    if (!mountTable || !mountTable->init()) {
+        Serial.println("Kernel: Failed to initialize mount table");
+        return false;
+    }
+    if (warmBoot->isWarm()) {
+        mountTable->restoreState(warmBoot->getRecord().volumes, warmBoot->getRecord().volumeCount);
+    }
+    
+    // Initialize stack tuner; profiles load once the file system service is up
+    stackTuner = new StackTuner();
+    if (!stackTuner || !stackTuner->init(postmortem)) {
+        Serial.println("Kernel: Failed to initialize stack tuner");
+        return false;
+    }
+    
     // Record boot time
     bootTime = millis();
     
@@ -54,55 +161,89 @@ bool Kernel::init() {
     healthy = true;
     initialized = true;
     
+    // Publish an initial snapshot; the monitor timer takes over from here
+    updateSystemStats();
+    TimerService::setup(&monitorTimer, monitorTick, this);
+    timerService->start(&monitorTimer, SYSTEM_MONITOR_INTERVAL_MS, SYSTEM_MONITOR_INTERVAL_MS);
+    
     Serial.println("Kernel: Core system initialized successfully");
     return true;
 }
-void Kernel::diskList(std::vector<std::string> &disks){
-    // get list of disks
-    Serial.println("Kernel: Listing disks...");
-    // get all device storage that connected
+void Kernel::shutdown() {
+    if (!initialized) {
+        return;
+    }
     
-
-    // Example: Simulate disk enumeration for ESP32 (SPIFFS, SD, etc.)
+    healthy = false;
     
-
-    // Check for SPIFFS
-    if (SPIFFS.begin(true)) {
-        // Use a descriptive name for SPIFFS since partitionLabel_ is private
-        disks.push_back("spiffs");
-        SPIFFS.end();
+    // Stop the monitor before anything it samples goes away
+    if (timerService) {
+        timerService->cancel(&monitorTimer);
     }
-
-    // Check for SD card
-    #ifdef SD_MMC_H
-    if (SD_MMC.begin()) {
-        disks.push_back("sdmmc");
-        SD_MMC.end();
+    while (monitorQueued.load()) {
+        vTaskDelay(1);
     }
-    #endif
-
-    #ifdef SD_H
-    if (SD.begin()) {
-        disks.push_back("sd");
-        SD.end();
+    
+    // Services are built on the kernel, so they go first
+    if (services) {
+        delete services;
+        services = nullptr;
     }
-    #endif
-
-    if (disks.empty()) {
-        Serial.println("No disks found.");
-    } else {
-        for (const auto& disk : disks) {
-            Serial.print("Found disk: ");
-            Serial.println(disk.c_str());
-        }
+    
+    // Clean up stack tuner before the volume it writes to
+    if (stackTuner) {
+        delete stackTuner;
+        stackTuner = nullptr;
     }
-}
-void Kernel::shutdown() {
-    if (!initialized) {
-        return;
+    
+    // Clean up mount table
+    if (mountTable) {
+        delete mountTable;
+        mountTable = nullptr;
     }
     
-    healthy = false;
+    // Clean up profiler
+    if (profiler) {
+        delete profiler;
+        profiler = nullptr;
+    }
+    
+    // Clean up governor; leaves the CPU at full speed
+    if (governor) {
+        delete governor;
+        governor = nullptr;
+    }
+    
+    // Clean up power manager; resumes any quiesced tasks
+    if (powerManager) {
+        delete powerManager;
+        powerManager = nullptr;
+    }
+    
+    // Clean up timer service
+    if (timerService) {
+        timerService->cancel(&monitorTimer);
+        delete timerService;
+        timerService = nullptr;
+    }
+    
+    // Clean up work queue
+    if (workQueue) {
+        delete workQueue;
+        workQueue = nullptr;
+    }
+    
+    // Clean up latency tracker
+    if (latencyTracker) {
+        delete latencyTracker;
+        latencyTracker = nullptr;
+    }
+    
+    // Clean up postmortem store before the subsystems it snapshots
+    if (postmortem) {
+        delete postmortem;
+        postmortem = nullptr;
+    }
     
     // Clean up scheduler
     if (scheduler) {
@@ -116,6 +257,24 @@ void Kernel::shutdown() {
         memoryManager = nullptr;
     }
     
+    // Clean up event bus
+    if (eventBus) {
+        delete eventBus;
+        eventBus = nullptr;
+    }
+    
+    // Clean up metrics registry
+    if (metrics) {
+        delete metrics;
+        metrics = nullptr;
+    }
+    
+    // Clean up warm boot state; the metrics baseline pointed into it
+    if (warmBoot) {
+        delete warmBoot;
+        warmBoot = nullptr;
+    }
+    
     // Clean up mutex
     if (systemMutex) {
         vSemaphoreDelete(systemMutex);
@@ -126,13 +285,20 @@ void Kernel::shutdown() {
 }
 
 bool Kernel::createTask(const char* name, TaskFunction_t taskFunction, 
-                       uint32_t stackSize, void* parameters, UBaseType_t priority) {
+                       uint32_t stackSize, void* parameters, UBaseType_t priority,
+                       bool critical) {
     if (!initialized || !scheduler) {
         return false;
     }
     
+    // Right-size the stack from earlier boots' high-water marks
+    if (stackTuner) {
+        stackSize = stackTuner->tune(name, stackSize);
+    }
+    
     if (takeMutex(1000)) {
-        bool result = scheduler->createTask(name, taskFunction, stackSize, parameters, priority);
+        bool result = scheduler->createTask(name, taskFunction, stackSize, parameters, priority,
+                                            critical);
         if (result) {
             totalTasks++;
         }
@@ -148,6 +314,11 @@ bool Kernel::deleteTask(const char* name) {
         return false;
     }
     
+    // Keep the task's final peak before its high-water mark is gone
+    if (stackTuner) {
+        stackTuner->update(scheduler);
+    }
+    
     if (takeMutex(1000)) {
         bool result = scheduler->deleteTask(name);
         if (result) {
@@ -209,30 +380,144 @@ void Kernel::updateSystemStats() {
         return;
     }
     
-    uptime = (millis() - bootTime) / 1000; // Convert to seconds
-    freeMem = getFreeMemory();
-    minFreeMem = getMinFreeMemory();
+    // Gather everything first, then publish in one short seqlock write
+    SystemStats snapshot;
+    snapshot.sampleTime = millis();
+    snapshot.uptime = (snapshot.sampleTime - bootTime) / 1000; // Convert to seconds
+    snapshot.freeMem = getFreeMemory();
+    snapshot.minFreeMem = getMinFreeMemory();
+    snapshot.totalTasks = totalTasks;
     
-    // Check system health
-    if (freeMem < 10240) { // Less than 10KB free memory is critical
+    if (memoryManager) {
+        snapshot.largestFreeBlock = memoryManager->getLargestFreeBlock();
+        snapshot.totalAllocated = memoryManager->getTotalAllocated();
+        snapshot.peakAllocated = memoryManager->getPeakAllocated();
+        snapshot.allocationCount = memoryManager->getAllocationCount();
+        snapshot.freeCount = memoryManager->getFreeCount();
+    } else {
+        snapshot.largestFreeBlock = 0;
+        snapshot.totalAllocated = 0;
+        snapshot.peakAllocated = 0;
+        snapshot.allocationCount = 0;
+        snapshot.freeCount = 0;
+    }
+    
+    // Check system health; subscribers hear about transitions only
+    if (snapshot.freeMem < 10240) { // Less than 10KB free memory is critical
         Serial.println("WARNING: Low memory condition detected");
+        if (healthy) {
+            Postmortem::trace(TRACE_HEALTH, 0, "low_memory");
+            if (eventBus) {
+                eventBus->publish(EVENT_LOW_MEMORY, snapshot.freeMem);
+            }
+        }
         healthy = false;
     } else {
+        if (!healthy) {
+            Postmortem::trace(TRACE_HEALTH, 1, "recovered");
+            if (eventBus) {
+                eventBus->publish(EVENT_MEMORY_RECOVERED, snapshot.freeMem);
+            }
+        }
         healthy = true;
     }
+    snapshot.healthy = healthy;
+    
+    stats.write(snapshot);
+    
+    MetricsRegistry::set(uptimeGauge, snapshot.uptime);
+    MetricsRegistry::set(heapFreeGauge, snapshot.freeMem);
+    MetricsRegistry::set(heapMinFreeGauge, snapshot.minFreeMem);
+    MetricsRegistry::set(heapLargestGauge, snapshot.largestFreeBlock);
+    
+    // Keep the postmortem record fresh in case the next reset is a panic
+    if (postmortem) {
+        postmortem->checkpoint();
+    }
+    
+    // Track stack peaks; flash access runs as its own low priority item
+    if (stackTuner) {
+        stackTuner->update(scheduler);
+        if (stackTuner->needsLoad() && workQueue) {
+            workQueue->post(loadStackProfiles, stackTuner, WORK_PRIO_LOW);
+        } else if (stackTuner->needsSave() && workQueue) {
+            workQueue->post(saveStackProfiles, stackTuner, WORK_PRIO_LOW);
+        }
+    }
+}
+
+void Kernel::saveStackProfiles(void* arg) {
+    ((StackTuner*)arg)->save();
+}
+
+void Kernel::loadStackProfiles(void* arg) {
+    ((StackTuner*)arg)->load();
+}
+
+// Timer service context: the checkpoint, logging and event delivery may
+// block, so the refresh runs on the work queue
+void Kernel::monitorTick(void* arg) {
+    Kernel* kernel = (Kernel*)arg;
+    if (!kernel->workQueue || kernel->monitorQueued.exchange(true)) {
+        return;     // The previous refresh has not run yet
+    }
+    if (!kernel->workQueue->post(monitorWork, kernel, WORK_PRIO_NORMAL)) {
+        kernel->monitorQueued.store(false);
+    }
+}
+
+void Kernel::monitorWork(void* arg) {
+    Kernel* kernel = (Kernel*)arg;
+    kernel->updateSystemStats();
+    kernel->monitorQueued.store(false);
+}
+
+unsigned long Kernel::getUptime() const {
+    SystemStats snapshot;
+    stats.read(snapshot);
+    return snapshot.uptime;
 }
 
 void Kernel::reboot() {
     Serial.println("Kernel: System reboot requested");
-    delay(1000);
+    if (stackTuner && stackTuner->isDirty()) {
+        stackTuner->save();
+    }
+    if (postmortem) {
+        postmortem->capture(POSTMORTEM_REBOOT);
+    }
+    Serial.flush();
     ESP.restart();
 }
 
-void Kernel::enterLowPowerMode() {
+void Kernel::warmReboot(PostmortemReason reason) {
+    Serial.println("Kernel: Warm reboot requested");
+    if (stackTuner && stackTuner->isDirty()) {
+        stackTuner->save();
+    }
+    if (postmortem) {
+        postmortem->capture(reason);
+    }
+    if (warmBoot) {
+        warmBoot->save(mountTable, metrics, services ? services->find<FileSystem>("fs") : nullptr);
+    }
+    Serial.flush();
+    ESP.restart();
+}
+
+bool Kernel::enterLowPowerMode() {
+    if (!powerManager) {
+        return false;
+    }
+    
     Serial.println("Kernel: Entering low power mode");
-    // Suspend non-critical tasks
-    // This is a simplified implementation
-    esp_deep_sleep_start();
+    return powerManager->enterLowPower();
+}
+
+void Kernel::exitLowPowerMode() {
+    if (powerManager) {
+        powerManager->exitLowPower();
+    }
 }
 
 bool Kernel::takeMutex(TickType_t timeout) {
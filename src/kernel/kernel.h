@@ -12,24 +12,64 @@
 #include <freertos/semphr.h>
 #include <vector>
 #include <string>
+#include <atomic>
 #include "../config/config.h"
 #include "scheduler.h"
 #include "memory.h"
+#include "latency.h"
+#include "workqueue.h"
+#include "mount.h"
+#include "stats.h"
+#include "eventbus.h"
+#include "metrics.h"
+#include "postmortem.h"
+#include "timerwheel.h"
+#include "profiler.h"
+#include "services.h"
+#include "warmboot.h"
+#include "power.h"
+#include "governor.h"
+#include "stacktune.h"
 
 class Kernel {
 private:
     Scheduler* scheduler;
     MemoryManager* memoryManager;
+    LatencyTracker* latencyTracker;
+    WorkQueue* workQueue;
+    MountTable* mountTable;
+    EventBus* eventBus;
+    MetricsRegistry* metrics;
+    Postmortem* postmortem;
+    TimerService* timerService;
+    Profiler* profiler;
+    ServiceRegistry* services;
+    WarmBoot* warmBoot;
+    PowerManager* powerManager;
+    Governor* governor;
+    StackTuner* stackTuner;
     SemaphoreHandle_t systemMutex;
     bool initialized;
     bool healthy;
     
-    // System statistics
+    // System statistics; published by the monitor task (the only writer)
     unsigned long bootTime;
-    unsigned long uptime;
     uint32_t totalTasks;
-    uint32_t freeMem;
-    uint32_t minFreeMem;
+    SeqLock<SystemStats> stats;
+    
+    // Gauges set from each published snapshot
+    Metric* uptimeGauge;
+    Metric* heapFreeGauge;
+    Metric* heapMinFreeGauge;
+    Metric* heapLargestGauge;
+    
+    // Periodic stats refresh: the timer only queues it, the work queue runs it
+    SoftTimer monitorTimer;
+    std::atomic<bool> monitorQueued;
+    static void monitorTick(void* arg);
+    static void monitorWork(void* arg);
+    static void saveStackProfiles(void* arg);
+    static void loadStackProfiles(void* arg);
     
 public:
     Kernel();
@@ -37,14 +77,14 @@ public:
     
     // Core kernel functions
     bool init();
-    void diskList(std::vector<std::string> &disks);
     
     void shutdown();
     bool isHealthy() const { return healthy; }
     
     // Task management (wrapper for scheduler)
     bool createTask(const char* name, TaskFunction_t taskFunction, 
-                   uint32_t stackSize, void* parameters, UBaseType_t priority);
+                   uint32_t stackSize, void* parameters, UBaseType_t priority,
+                   bool critical = false);
     bool deleteTask(const char* name);
     void suspendTask(const char* name);
     void resumeTask(const char* name);
@@ -57,13 +97,17 @@ public:
     
     // System information
     void updateSystemStats();
-    unsigned long getUptime() const { return uptime; }
+    void getStats(SystemStats& out) const { stats.read(out); }
+    uint32_t getStatsGeneration() const { return stats.generation(); }
+    unsigned long getUptime() const;
     uint32_t getTotalTasks() const { return totalTasks; }
     const char* getVersion() const { return OS_VERSION; }
     
     // System control
     void reboot();
-    void enterLowPowerMode();
+    void warmReboot(PostmortemReason reason = POSTMORTEM_REBOOT);
+    bool enterLowPowerMode();
+    void exitLowPowerMode();
     
     // Mutex operations
     bool takeMutex(TickType_t timeout = portMAX_DELAY);
@@ -72,6 +116,19 @@ public:
     // Access to subsystems
     Scheduler* getScheduler() { return scheduler; }
     MemoryManager* getMemoryManager() { return memoryManager; }
+    LatencyTracker* getLatencyTracker() { return latencyTracker; }
+    WorkQueue* getWorkQueue() { return workQueue; }
+    MountTable* getMountTable() { return mountTable; }
+    EventBus* getEventBus() { return eventBus; }
+    MetricsRegistry* getMetrics() { return metrics; }
+    Postmortem* getPostmortem() { return postmortem; }
+    TimerService* getTimerService() { return timerService; }
+    Profiler* getProfiler() { return profiler; }
+    ServiceRegistry* getServices() { return services; }
+    WarmBoot* getWarmBoot() { return warmBoot; }
+    PowerManager* getPowerManager() { return powerManager; }
+    Governor* getGovernor() { return governor; }
+    StackTuner* getStackTuner() { return stackTuner; }
 };
 
 // Global kernel instance declaration
@@ -0,0 +1,348 @@
+/*
+ * ESP32-OS Interrupt Latency Tracker Implementation
+ */
+
+#include "latency.h"
+
+static_assert(LATENCY_HISTOGRAM_BUCKETS == 64,
+              "Latency buckets cover 2 per octave of a 32-bit value");
+
+LatencyTracker* LatencyTracker::isrInstance = nullptr;
+
+LatencyTracker::LatencyTracker() : selfTestSource(-1), selfTestTask(nullptr),
+                                   selfTestRunning(false), selfTestDone(true),
+                                   selfTestRateHz(0) {
+    spinlock = portMUX_INITIALIZER_UNLOCKED;
+    memset(sources, 0, sizeof(sources));
+}
+
+LatencyTracker::~LatencyTracker() {
+    shutdown();
+}
+
+bool LatencyTracker::init() {
+    selfTestSource = registerSource("selftest");
+    if (selfTestSource < 0) {
+        Serial.println("LatencyTracker: Failed to register self-test source");
+        return false;
+    }
+
+    Serial.println("LatencyTracker: Interrupt latency tracker initialized");
+    return true;
+}
+
+void LatencyTracker::shutdown() {
+    selfTestRunning = false;
+    if (isrInstance == this) {
+        isrInstance = nullptr;
+    }
+}
+
+int LatencyTracker::registerSource(const char* name) {
+    if (!name) {
+        return -1;
+    }
+
+    int existing = findSource(name);
+    if (existing >= 0) {
+        return existing;
+    }
+
+    for (int i = 0; i < LATENCY_MAX_SOURCES; i++) {
+        if (!sources[i].active) {
+            memset(&sources[i], 0, sizeof(sources[i]));
+            strncpy(sources[i].name, name, sizeof(sources[i].name) - 1);
+            sources[i].isrCore = -1;
+            sources[i].active = true;
+            return i;
+        }
+    }
+
+    Serial.println("LatencyTracker: No free source slots available");
+    return -1;
+}
+
+int LatencyTracker::findSource(const char* name) {
+    if (!name) {
+        return -1;
+    }
+
+    for (int i = 0; i < LATENCY_MAX_SOURCES; i++) {
+        if (sources[i].active && strcmp(sources[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void LatencyTracker::taskWake(int source) {
+    if (source < 0 || source >= LATENCY_MAX_SOURCES) {
+        return;
+    }
+
+    uint32_t now = ESP.getCycleCount();
+    uint16_t mhz = esp_rom_get_cpu_ticks_per_us();
+    LatencySource& src = sources[source];
+
+    // Consume the pending ISR stamp; a new interrupt may arrive right after
+    portENTER_CRITICAL(&spinlock);
+    uint32_t pending = src.pending;
+    uint32_t stamp = src.isrCycles;
+    uint16_t stampMhz = src.isrMhz;
+    int8_t core = src.isrCore;
+    src.pending = 0;
+    portEXIT_CRITICAL(&spinlock);
+
+    src.serving = false;
+    if (pending == 0) {
+        return;
+    }
+    if (pending > 1) {
+        src.overruns += pending - 1;
+    }
+    if (core != (int8_t)xPortGetCoreID()) {
+        src.crossCore++;
+        return;
+    }
+    if (mhz != stampMhz) {
+        src.clockChanges++;
+        return;
+    }
+
+    src.servingCycles = stamp;
+    src.servingMhz = stampMhz;
+    src.serving = true;
+    record(src.wake, cyclesToNs(now - stamp, mhz));
+}
+
+void LatencyTracker::taskDone(int source) {
+    if (source < 0 || source >= LATENCY_MAX_SOURCES) {
+        return;
+    }
+
+    uint32_t now = ESP.getCycleCount();
+    uint16_t mhz = esp_rom_get_cpu_ticks_per_us();
+    LatencySource& src = sources[source];
+    if (!src.serving) {
+        return;
+    }
+
+    if (mhz == src.servingMhz) {
+        record(src.done, cyclesToNs(now - src.servingCycles, mhz));
+    } else {
+        src.clockChanges++;
+    }
+    src.serving = false;
+}
+
+uint32_t LatencyTracker::cyclesToNs(uint32_t cycles, uint16_t mhz) {
+    if (mhz == 0) {
+        return 0;
+    }
+    uint64_t ns = (uint64_t)cycles * 1000 / mhz;
+    return ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+}
+
+uint8_t LatencyTracker::bucketFor(uint32_t ns) {
+    if (ns < 2) {
+        return ns;
+    }
+    uint8_t msb = 31 - __builtin_clz(ns);
+    return 2 * msb + ((ns >> (msb - 1)) & 1);
+}
+
+uint32_t LatencyTracker::bucketUpperBound(uint8_t bucket) {
+    if (bucket < 2) {
+        return bucket;
+    }
+    uint8_t msb = bucket / 2;
+    uint64_t lower = (uint64_t)(2 + (bucket & 1)) << (msb - 1);
+    return (uint32_t)(lower + (1ULL << (msb - 1)) - 1);
+}
+
+void LatencyTracker::record(LatencyHistogram& hist, uint32_t ns) {
+    hist.buckets[bucketFor(ns)]++;
+    hist.count++;
+    hist.totalNs += ns;
+    if (ns > hist.maxNs) {
+        hist.maxNs = ns;
+    }
+}
+
+uint32_t LatencyTracker::percentile(const LatencyHistogram& hist, uint8_t pct) {
+    if (hist.count == 0) {
+        return 0;
+    }
+
+    uint32_t target = (uint32_t)(((uint64_t)hist.count * pct + 99) / 100);
+    uint32_t seen = 0;
+    for (int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+        seen += hist.buckets[i];
+        if (seen >= target) {
+            uint32_t upper = bucketUpperBound(i);
+            return upper < hist.maxNs ? upper : hist.maxNs;
+        }
+    }
+    return hist.maxNs;
+}
+
+bool LatencyTracker::getPercentiles(int source, uint32_t& p50Ns, uint32_t& p99Ns, uint32_t& maxNs) {
+    if (source < 0 || source >= LATENCY_MAX_SOURCES || !sources[source].active) {
+        return false;
+    }
+
+    const LatencyHistogram& hist = sources[source].wake;
+    p50Ns = percentile(hist, 50);
+    p99Ns = percentile(hist, 99);
+    maxNs = hist.maxNs;
+    return true;
+}
+
+void LatencyTracker::reset(int source) {
+    for (int i = 0; i < LATENCY_MAX_SOURCES; i++) {
+        if (source >= 0 && i != source) {
+            continue;
+        }
+        LatencySource& src = sources[i];
+        portENTER_CRITICAL(&spinlock);
+        src.pending = 0;
+        portEXIT_CRITICAL(&spinlock);
+        src.serving = false;
+        src.overruns = 0;
+        src.crossCore = 0;
+        src.clockChanges = 0;
+        memset(&src.wake, 0, sizeof(src.wake));
+        memset(&src.done, 0, sizeof(src.done));
+    }
+}
+
+void LatencyTracker::printStatistics() {
+    Serial.println("Interrupt Latency (us):");
+    Serial.println("Source           Samples  p50 wake  p99 wake  max wake  p99 done  max done  Overruns");
+    Serial.println("-------------------------------------------------------------------------------------");
+
+    for (int i = 0; i < LATENCY_MAX_SOURCES; i++) {
+        const LatencySource& src = sources[i];
+        if (!src.active) {
+            continue;
+        }
+
+        Serial.printf("%-16s %8u %9.2f %9.2f %9.2f %9.2f %9.2f %9u\n",
+                      src.name,
+                      src.wake.count,
+                      percentile(src.wake, 50) / 1000.0,
+                      percentile(src.wake, 99) / 1000.0,
+                      src.wake.maxNs / 1000.0,
+                      percentile(src.done, 99) / 1000.0,
+                      src.done.maxNs / 1000.0,
+                      src.overruns);
+        if (src.crossCore > 0) {
+            Serial.printf("  (%u samples dropped: task ran on the other core)\n", src.crossCore);
+        }
+        if (src.clockChanges > 0) {
+            Serial.printf("  (%u samples dropped: CPU clock changed mid-sample)\n", src.clockChanges);
+        }
+    }
+}
+
+bool LatencyTracker::runSelfTest(uint32_t rateHz, uint32_t durationMs, bool withLoad) {
+    if (selfTestRunning || selfTestSource < 0 ||
+        rateHz == 0 || rateHz > LATENCY_SELFTEST_MAX_HZ) {
+        return false;
+    }
+
+    reset(selfTestSource);
+    selfTestRateHz = rateHz;
+    selfTestDone = false;
+    selfTestRunning = true;
+    isrInstance = this;
+
+    // The handler attaches the timer ISR itself, so both share a core and CCOUNT
+    BaseType_t core = xPortGetCoreID();
+    if (xTaskCreatePinnedToCore(selfTestHandler, "lat_test", 2048, this,
+                                LATENCY_SELFTEST_PRIORITY, &selfTestTask, core) != pdPASS) {
+        selfTestRunning = false;
+        selfTestDone = true;
+        Serial.println("LatencyTracker: Failed to create self-test task");
+        return false;
+    }
+
+    TaskHandle_t loadTask = nullptr;
+    if (withLoad) {
+        xTaskCreatePinnedToCore(selfTestLoad, "lat_load", 1024, this,
+                                LATENCY_SELFTEST_PRIORITY, &loadTask, core);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(durationMs));
+    selfTestRunning = false;
+
+    while (!selfTestDone) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    if (loadTask) {
+        vTaskDelete(loadTask);
+    }
+    vTaskDelete(selfTestTask);
+    selfTestTask = nullptr;
+
+    return true;
+}
+
+void IRAM_ATTR LatencyTracker::selfTestISR() {
+    LatencyTracker* self = isrInstance;
+    if (!self || !self->selfTestTask) {
+        return;
+    }
+
+    self->isrEnter(self->selfTestSource);
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(self->selfTestTask, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void LatencyTracker::selfTestHandler(void* parameter) {
+    LatencyTracker* self = (LatencyTracker*)parameter;
+
+    hw_timer_t* timer = timerBegin(LATENCY_SELFTEST_TIMER, 80, true); // 1 MHz tick
+    timerAttachInterrupt(timer, selfTestISR, true);
+    timerAlarmWrite(timer, 1000000 / self->selfTestRateHz, true);
+    timerAlarmEnable(timer);
+
+    while (self->selfTestRunning) {
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100)) > 0) {
+            self->taskWake(self->selfTestSource);
+            self->taskDone(self->selfTestSource);
+        }
+    }
+
+    timerAlarmDisable(timer);
+    timerDetachInterrupt(timer);
+    timerEnd(timer);
+
+    self->selfTestDone = true;
+    while (true) {
+        vTaskDelay(portMAX_DELAY); // Deleted by runSelfTest()
+    }
+}
+
+void LatencyTracker::selfTestLoad(void* parameter) {
+    LatencyTracker* self = (LatencyTracker*)parameter;
+
+    // Compete with the handler at equal priority, yielding each tick so the
+    // idle task still feeds the watchdog
+    while (self->selfTestRunning) {
+        uint32_t start = micros();
+        while (micros() - start < LATENCY_SELFTEST_LOAD_US) {
+            __asm__ __volatile__("nop");
+        }
+        vTaskDelay(1);
+    }
+
+    while (true) {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
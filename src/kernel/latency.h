@@ -0,0 +1,111 @@
+/*
+ * ESP32-OS Interrupt Latency Tracker Header
+ * Cycle-accurate ISR-to-task latency measurement and histograms
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_rom_sys.h>
+#include "../config/config.h"
+
+// Log-scale histogram: two buckets per power of two, values in nanoseconds
+struct LatencyHistogram {
+    uint32_t buckets[LATENCY_HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t maxNs;
+    uint64_t totalNs;
+};
+
+struct LatencySource {
+    char name[16];
+    bool active;
+
+    // Written from ISR context
+    volatile uint32_t isrCycles;   // CCOUNT at first unconsumed ISR entry
+    volatile uint16_t isrMhz;      // Clock those cycles count at
+    volatile uint32_t pending;     // ISR entries not yet consumed by the task
+    volatile int8_t isrCore;
+
+    // Written from task context
+    uint32_t servingCycles;        // ISR stamp of the event being handled
+    uint16_t servingMhz;
+    bool serving;
+    uint32_t overruns;             // ISR entries coalesced into one wake
+    uint32_t crossCore;            // Samples dropped, task ran on other core
+    uint32_t clockChanges;         // Samples dropped, CPU clock changed meanwhile
+
+    LatencyHistogram wake;         // ISR entry -> task wake
+    LatencyHistogram done;         // ISR entry -> processing complete
+};
+
+class LatencyTracker {
+private:
+    LatencySource sources[LATENCY_MAX_SOURCES];
+    portMUX_TYPE spinlock;
+
+    // Self-test state
+    int selfTestSource;
+    TaskHandle_t selfTestTask;
+    volatile bool selfTestRunning;
+    volatile bool selfTestDone;
+    uint32_t selfTestRateHz;
+
+    static LatencyTracker* isrInstance;
+    static void IRAM_ATTR selfTestISR();
+    static void selfTestHandler(void* parameter);
+    static void selfTestLoad(void* parameter);
+
+    static uint8_t bucketFor(uint32_t ns);
+    static uint32_t bucketUpperBound(uint8_t bucket);
+    static void record(LatencyHistogram& hist, uint32_t ns);
+    static uint32_t percentile(const LatencyHistogram& hist, uint8_t pct);
+    static uint32_t cyclesToNs(uint32_t cycles, uint16_t mhz);
+
+public:
+    LatencyTracker();
+    ~LatencyTracker();
+
+    bool init();
+    void shutdown();
+
+    // Source registration (returns source id or -1)
+    int registerSource(const char* name);
+    int findSource(const char* name);
+
+    // Timestamps: isrEnter() from the ISR, the rest from the handling task.
+    // CCOUNT is per core, so the handling task must be pinned to the core
+    // that services the interrupt; samples from the other core are dropped.
+    // The governor changes the clock CCOUNT runs at, so each stamp keeps
+    // its MHz and a sample spanning a change is dropped too.
+    void IRAM_ATTR isrEnter(int source) {
+        if (source < 0 || source >= LATENCY_MAX_SOURCES) {
+            return;
+        }
+        uint32_t now = ESP.getCycleCount();
+        uint16_t mhz = esp_rom_get_cpu_ticks_per_us();
+        portENTER_CRITICAL_ISR(&spinlock);
+        if (sources[source].pending == 0) {
+            sources[source].isrCycles = now;
+            sources[source].isrMhz = mhz;
+            sources[source].isrCore = xPortGetCoreID();
+        }
+        sources[source].pending++;
+        portEXIT_CRITICAL_ISR(&spinlock);
+    }
+    void taskWake(int source);
+    void taskDone(int source);
+
+    // Reporting
+    bool getPercentiles(int source, uint32_t& p50Ns, uint32_t& p99Ns, uint32_t& maxNs);
+    void reset(int source = -1);
+    void printStatistics();
+
+    // Timer-interrupt self-test; blocks the caller for durationMs
+    bool runSelfTest(uint32_t rateHz, uint32_t durationMs, bool withLoad);
+};
+
+#endif // LATENCY_H
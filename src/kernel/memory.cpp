@@ -6,7 +6,9 @@
 #include <esp_heap_caps.h>
 
 MemoryManager::MemoryManager() : memoryMutex(nullptr), totalAllocated(0), 
-                                peakAllocated(0), allocationCount(0), freeCount(0) {
+                                peakAllocated(0), allocationCount(0), freeCount(0),
+                                metrics(nullptr), allocCounter(nullptr), freeCounter(nullptr),
+                                allocSizeHistogram(nullptr) {
     // Initialize memory blocks
     for (int i = 0; i < MAX_MEMORY_BLOCKS; i++) {
         blocks[i].ptr = nullptr;
@@ -33,6 +35,25 @@ bool MemoryManager::init() {
     return true;
 }
 
+static uint32_t sampleAllocatedBytes(void* context) {
+    return ((MemoryManager*)context)->getTotalAllocated();
+}
+
+void MemoryManager::registerMetrics(MetricsRegistry* registry) {
+    static const uint32_t sizeBounds[] = {16, 64, 256, 1024, 4096, 16384};
+    
+    if (!registry) {
+        return;
+    }
+    
+    metrics = registry;
+    allocCounter = registry->registerCounter("mem_allocations_total");
+    freeCounter = registry->registerCounter("mem_frees_total");
+    allocSizeHistogram = registry->registerHistogram("mem_allocation_bytes", sizeBounds,
+                                                     sizeof(sizeBounds) / sizeof(sizeBounds[0]));
+    registry->registerGauge("mem_allocated_bytes", sampleAllocatedBytes, this);
+}
+
 void MemoryManager::shutdown() {
     if (memoryMutex) {
         xSemaphoreTake(memoryMutex, portMAX_DELAY);
@@ -98,6 +119,11 @@ void* MemoryManager::allocate(size_t size, const char* tag) {
     
     xSemaphoreGive(memoryMutex);
     
+    MetricsRegistry::increment(allocCounter);
+    if (metrics) {
+        metrics->observe(allocSizeHistogram, size);
+    }
+    
 #if DEBUG_MEMORY
     Serial.print("MemoryManager: Allocated ");
     Serial.print(size);
@@ -134,6 +160,7 @@ void MemoryManager::free(void* ptr) {
     
     totalAllocated -= blocks[slot].size;
     freeCount++;
+    MetricsRegistry::increment(freeCounter);
     
 #if DEBUG_MEMORY
     Serial.print("MemoryManager: Freed ");
@@ -10,6 +10,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 #include "../config/config.h"
+#include "metrics.h"
 
 struct MemoryBlock {
     void* ptr;
@@ -28,6 +29,12 @@ private:
     uint32_t allocationCount;
     uint32_t freeCount;
     
+    // Metrics
+    MetricsRegistry* metrics;
+    Metric* allocCounter;
+    Metric* freeCounter;
+    Metric* allocSizeHistogram;
+    
     int findFreeBlock();
     int findBlockByPtr(void* ptr);
     void defragment();
@@ -38,6 +45,7 @@ public:
     
     bool init();
     void shutdown();
+    void registerMetrics(MetricsRegistry* registry);
     
     // Memory allocation
     void* allocate(size_t size, const char* tag = "unknown");
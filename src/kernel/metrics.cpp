@@ -0,0 +1,321 @@
+/*
+ * ESP32-OS Metrics Registry Implementation
+ */
+
+#include "metrics.h"
+#include "checksum.h"
+
+static const char* typeNames[] = {"counter", "gauge", "histogram"};
+
+MetricsRegistry::MetricsRegistry() : metricCount(0), histogramCount(0), registryMutex(nullptr),
+                                     baseline(nullptr), baselineCount(0) {
+    for (int i = 0; i < METRICS_MAX; i++) {
+        memset(metrics[i].name, 0, sizeof(metrics[i].name));
+        metrics[i].value.store(0);
+        metrics[i].sampler = nullptr;
+        metrics[i].context = nullptr;
+        metrics[i].histogram = -1;
+    }
+    for (int i = 0; i < METRICS_MAX_HISTOGRAMS; i++) {
+        histograms[i].boundCount = 0;
+        for (int b = 0; b <= METRICS_HISTOGRAM_BUCKETS; b++) {
+            histograms[i].buckets[b].store(0);
+        }
+        histograms[i].count.store(0);
+        histograms[i].sum.store(0);
+    }
+}
+
+MetricsRegistry::~MetricsRegistry() {
+    shutdown();
+}
+
+bool MetricsRegistry::init() {
+    registryMutex = xSemaphoreCreateMutex();
+    if (!registryMutex) {
+        Serial.println("MetricsRegistry: Failed to create mutex");
+        return false;
+    }
+
+    Serial.println("MetricsRegistry: Metrics registry initialized");
+    return true;
+}
+
+void MetricsRegistry::shutdown() {
+    if (registryMutex) {
+        vSemaphoreDelete(registryMutex);
+        registryMutex = nullptr;
+    }
+}
+
+Metric* MetricsRegistry::find(const char* name) {
+    if (!name) {
+        return nullptr;
+    }
+
+    uint8_t count = metricCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; i++) {
+        if (strcmp(metrics[i].name, name) == 0) {
+            return &metrics[i];
+        }
+    }
+    return nullptr;
+}
+
+Metric* MetricsRegistry::addMetric(const char* name, MetricType type, MetricSampler_t sampler,
+                                   void* context, const uint32_t* bounds, uint8_t boundCount) {
+    if (!name || !registryMutex) {
+        return nullptr;
+    }
+
+    if (xSemaphoreTake(registryMutex, 1000) != pdTRUE) {
+        return nullptr;
+    }
+
+    Metric* metric = find(name);
+    uint8_t count = metricCount.load(std::memory_order_relaxed);
+    bool needsHistogram = type == METRIC_HISTOGRAM;
+
+    if (metric) {
+        if (metric->type != type) {
+            metric = nullptr; // Name already taken by another type
+        }
+    } else if (count >= METRICS_MAX ||
+               (needsHistogram && histogramCount >= METRICS_MAX_HISTOGRAMS)) {
+        Serial.printf("MetricsRegistry: No free slot for '%s'\n", name);
+    } else {
+        metric = &metrics[count];
+        strncpy(metric->name, name, sizeof(metric->name) - 1);
+        metric->type = type;
+        metric->sampler = sampler;
+        metric->context = context;
+
+        if (type == METRIC_COUNTER) {
+            uint32_t hash = fnv1a(name, strlen(name));
+            for (int i = 0; i < baselineCount; i++) {
+                if (baseline[i].nameHash == hash) {
+                    metric->value.store(baseline[i].value, std::memory_order_relaxed);
+                    break;
+                }
+            }
+        }
+
+        if (needsHistogram) {
+            MetricHistogram& hist = histograms[histogramCount];
+            memcpy(hist.bounds, bounds, boundCount * sizeof(uint32_t));
+            hist.boundCount = boundCount;
+            metric->histogram = histogramCount++;
+        }
+
+        // Exporters scan without locking; publish the slot last
+        metricCount.store(count + 1, std::memory_order_release);
+    }
+
+    xSemaphoreGive(registryMutex);
+    return metric;
+}
+
+void MetricsRegistry::setBaseline(const MetricBaseline* baseline, uint8_t count) {
+    this->baseline = baseline;
+    baselineCount = baseline ? count : 0;
+}
+
+uint8_t MetricsRegistry::saveCounters(MetricBaseline* out, uint8_t maxCounters) {
+    uint8_t count = metricCount.load(std::memory_order_acquire);
+    uint8_t saved = 0;
+
+    for (int i = 0; i < count && saved < maxCounters; i++) {
+        if (metrics[i].type == METRIC_COUNTER) {
+            out[saved].nameHash = fnv1a(metrics[i].name, strlen(metrics[i].name));
+            out[saved].value = readValue(metrics[i]);
+            saved++;
+        }
+    }
+    return saved;
+}
+
+Metric* MetricsRegistry::registerCounter(const char* name) {
+    return addMetric(name, METRIC_COUNTER, nullptr, nullptr, nullptr, 0);
+}
+
+Metric* MetricsRegistry::registerCounter(const char* name, MetricSampler_t sampler, void* context) {
+    if (!sampler) {
+        return nullptr;
+    }
+    return addMetric(name, METRIC_COUNTER, sampler, context, nullptr, 0);
+}
+
+Metric* MetricsRegistry::registerGauge(const char* name) {
+    return addMetric(name, METRIC_GAUGE, nullptr, nullptr, nullptr, 0);
+}
+
+Metric* MetricsRegistry::registerGauge(const char* name, MetricSampler_t sampler, void* context) {
+    if (!sampler) {
+        return nullptr;
+    }
+    return addMetric(name, METRIC_GAUGE, sampler, context, nullptr, 0);
+}
+
+Metric* MetricsRegistry::registerHistogram(const char* name, const uint32_t* bounds, uint8_t boundCount) {
+    if (!bounds || boundCount == 0 || boundCount > METRICS_HISTOGRAM_BUCKETS) {
+        return nullptr;
+    }
+    return addMetric(name, METRIC_HISTOGRAM, nullptr, nullptr, bounds, boundCount);
+}
+
+void MetricsRegistry::observe(Metric* metric, uint32_t value) {
+    if (!metric || metric->histogram < 0) {
+        return;
+    }
+
+    MetricHistogram& hist = histograms[metric->histogram];
+    uint8_t bucket = 0;
+    while (bucket < hist.boundCount && value > hist.bounds[bucket]) {
+        bucket++;
+    }
+
+    hist.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    hist.count.fetch_add(1, std::memory_order_relaxed);
+    hist.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint32_t MetricsRegistry::readValue(const Metric& metric) {
+    if (metric.sampler) {
+        uint32_t base = metric.type == METRIC_COUNTER ? metric.value.load(std::memory_order_relaxed) : 0;
+        return base + metric.sampler(metric.context);
+    }
+    return metric.value.load(std::memory_order_relaxed);
+}
+
+void MetricsRegistry::exportText(Print& out) {
+    uint8_t count = metricCount.load(std::memory_order_acquire);
+
+    for (int i = 0; i < count; i++) {
+        const Metric& metric = metrics[i];
+        out.printf("# TYPE %s %s\n", metric.name, typeNames[metric.type]);
+
+        if (metric.type != METRIC_HISTOGRAM) {
+            out.printf("%s %u\n", metric.name, readValue(metric));
+            continue;
+        }
+
+        // Cumulative buckets, Prometheus style
+        MetricHistogram& hist = histograms[metric.histogram];
+        uint32_t cumulative = 0;
+        for (int b = 0; b < hist.boundCount; b++) {
+            cumulative += hist.buckets[b].load(std::memory_order_relaxed);
+            out.printf("%s_bucket{le=\"%u\"} %u\n", metric.name, hist.bounds[b], cumulative);
+        }
+        cumulative += hist.buckets[hist.boundCount].load(std::memory_order_relaxed);
+        out.printf("%s_bucket{le=\"+Inf\"} %u\n", metric.name, cumulative);
+        out.printf("%s_count %u\n", metric.name, hist.count.load(std::memory_order_relaxed));
+        out.printf("%s_sum %u\n", metric.name, hist.sum.load(std::memory_order_relaxed));
+    }
+}
+
+void MetricsRegistry::exportJson(Print& out) {
+    uint8_t count = metricCount.load(std::memory_order_acquire);
+
+    out.printf("{\"timestamp\":%lu,\"metrics\":{", millis());
+    for (int i = 0; i < count; i++) {
+        const Metric& metric = metrics[i];
+        if (i > 0) {
+            out.print(",");
+        }
+
+        if (metric.type != METRIC_HISTOGRAM) {
+            out.printf("\"%s\":%u", metric.name, readValue(metric));
+            continue;
+        }
+
+        MetricHistogram& hist = histograms[metric.histogram];
+        out.printf("\"%s\":{\"bounds\":[", metric.name);
+        for (int b = 0; b < hist.boundCount; b++) {
+            out.printf(b > 0 ? ",%u" : "%u", hist.bounds[b]);
+        }
+        out.print("],\"buckets\":[");
+        for (int b = 0; b <= hist.boundCount; b++) {
+            out.printf(b > 0 ? ",%u" : "%u", hist.buckets[b].load(std::memory_order_relaxed));
+        }
+        out.printf("],\"count\":%u,\"sum\":%u}",
+                   hist.count.load(std::memory_order_relaxed),
+                   hist.sum.load(std::memory_order_relaxed));
+    }
+    out.println("}}");
+}
+
+static bool putU8(uint8_t* buffer, size_t maxLen, size_t& pos, uint8_t value) {
+    if (pos + 1 > maxLen) {
+        return false;
+    }
+    buffer[pos++] = value;
+    return true;
+}
+
+static bool putU32(uint8_t* buffer, size_t maxLen, size_t& pos, uint32_t value) {
+    if (pos + 4 > maxLen) {
+        return false;
+    }
+    buffer[pos++] = value & 0xFF;
+    buffer[pos++] = (value >> 8) & 0xFF;
+    buffer[pos++] = (value >> 16) & 0xFF;
+    buffer[pos++] = (value >> 24) & 0xFF;
+    return true;
+}
+
+size_t MetricsRegistry::exportBinary(uint8_t* buffer, size_t maxLen) {
+    if (!buffer) {
+        return 0;
+    }
+
+    uint8_t count = metricCount.load(std::memory_order_acquire);
+    size_t pos = 0;
+
+    if (!putU32(buffer, maxLen, pos, METRICS_BINARY_MAGIC) ||
+        !putU8(buffer, maxLen, pos, METRICS_BINARY_VERSION) ||
+        !putU8(buffer, maxLen, pos, count) ||
+        !putU32(buffer, maxLen, pos, millis())) {
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const Metric& metric = metrics[i];
+        uint8_t nameLen = strlen(metric.name);
+
+        if (!putU8(buffer, maxLen, pos, metric.type) ||
+            !putU8(buffer, maxLen, pos, nameLen) ||
+            pos + nameLen > maxLen) {
+            return 0;
+        }
+        memcpy(buffer + pos, metric.name, nameLen);
+        pos += nameLen;
+
+        if (metric.type != METRIC_HISTOGRAM) {
+            if (!putU32(buffer, maxLen, pos, readValue(metric))) {
+                return 0;
+            }
+            continue;
+        }
+
+        MetricHistogram& hist = histograms[metric.histogram];
+        if (!putU8(buffer, maxLen, pos, hist.boundCount + 1)) {
+            return 0;
+        }
+        for (int b = 0; b < hist.boundCount; b++) {
+            if (!putU32(buffer, maxLen, pos, hist.bounds[b])) {
+                return 0;
+            }
+        }
+        for (int b = 0; b <= hist.boundCount; b++) {
+            if (!putU32(buffer, maxLen, pos, hist.buckets[b].load(std::memory_order_relaxed))) {
+                return 0;
+            }
+        }
+        if (!putU32(buffer, maxLen, pos, hist.count.load(std::memory_order_relaxed)) ||
+            !putU32(buffer, maxLen, pos, hist.sum.load(std::memory_order_relaxed))) {
+            return 0;
+        }
+    }
+
+    return pos;
+}
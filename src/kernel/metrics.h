@@ -0,0 +1,111 @@
+/*
+ * ESP32-OS Metrics Registry Header
+ * Named counters, gauges and histograms with text/JSON/binary export
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
+#include "../config/config.h"
+
+enum MetricType {
+    METRIC_COUNTER = 0,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM
+};
+
+// Gauges and counters may be sampled at export time instead of being set
+typedef uint32_t (*MetricSampler_t)(void* context);
+
+struct MetricHistogram {
+    uint32_t bounds[METRICS_HISTOGRAM_BUCKETS];     // Upper bounds, ascending
+    uint8_t boundCount;
+    std::atomic<uint32_t> buckets[METRICS_HISTOGRAM_BUCKETS + 1]; // Last is overflow
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> sum;
+};
+
+struct Metric {
+    char name[METRICS_NAME_LENGTH];
+    MetricType type;
+    std::atomic<uint32_t> value;    // Sampled counters: the warm boot baseline
+    MetricSampler_t sampler;
+    void* context;
+    int8_t histogram;       // Index into the histogram pool, or -1
+};
+
+// Counter value carried across a warm reboot, keyed by name hash
+struct MetricBaseline {
+    uint32_t nameHash;
+    uint32_t value;
+};
+
+// Binary snapshot layout (little endian):
+//   header:  u32 magic "MTRC", u8 version, u8 metric count, u32 millis
+//   metric:  u8 type, u8 name length, name bytes, then
+//            counter/gauge: u32 value
+//            histogram:     u8 bucket count (bounds + 1), u32 bounds[],
+//                           u32 buckets[], u32 count, u32 sum
+#define METRICS_BINARY_MAGIC 0x4352544D
+#define METRICS_BINARY_VERSION 1
+
+class MetricsRegistry {
+private:
+    Metric metrics[METRICS_MAX];
+    MetricHistogram histograms[METRICS_MAX_HISTOGRAMS];
+    std::atomic<uint8_t> metricCount;
+    uint8_t histogramCount;
+    SemaphoreHandle_t registryMutex;
+    const MetricBaseline* baseline;
+    uint8_t baselineCount;
+
+    Metric* addMetric(const char* name, MetricType type, MetricSampler_t sampler,
+                      void* context, const uint32_t* bounds, uint8_t boundCount);
+    uint32_t readValue(const Metric& metric);
+
+public:
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    bool init();
+    void shutdown();
+
+    // Registration returns a handle to keep; registering an existing name
+    // returns the existing metric. nullptr if the registry is full.
+    Metric* registerCounter(const char* name);
+    // For a total the owner already keeps; it still carries over warm reboots
+    Metric* registerCounter(const char* name, MetricSampler_t sampler, void* context = nullptr);
+    Metric* registerGauge(const char* name);
+    Metric* registerGauge(const char* name, MetricSampler_t sampler, void* context = nullptr);
+    Metric* registerHistogram(const char* name, const uint32_t* bounds, uint8_t boundCount);
+    Metric* find(const char* name);
+
+    // Counters registered after this start from their saved value
+    void setBaseline(const MetricBaseline* baseline, uint8_t count);
+    uint8_t saveCounters(MetricBaseline* out, uint8_t maxCounters);
+
+    // Lock-free updates; null handles are ignored
+    static void increment(Metric* metric, uint32_t delta = 1) {
+        if (metric) {
+            metric->value.fetch_add(delta, std::memory_order_relaxed);
+        }
+    }
+    static void set(Metric* metric, uint32_t value) {
+        if (metric) {
+            metric->value.store(value, std::memory_order_relaxed);
+        }
+    }
+    void observe(Metric* metric, uint32_t value);
+
+    // Export
+    void exportText(Print& out);
+    void exportJson(Print& out);
+    size_t exportBinary(uint8_t* buffer, size_t maxLen);
+    uint8_t getMetricCount() const { return metricCount.load(std::memory_order_acquire); }
+};
+
+#endif // METRICS_H
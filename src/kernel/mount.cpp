@@ -0,0 +1,224 @@
+/*
+ * ESP32-OS Mount Table Implementation
+ */
+
+#include "mount.h"
+#include "postmortem.h"
+#include "../filesystem/vfs.h"
+#include <SD_MMC.h>
+#include <SD.h>
+
+static bool mountSDMMC() { return SD_MMC.begin(); }
+static void unmountSDMMC() { SD_MMC.end(); }
+
+static bool mountSD() { return SD.begin(); }
+static void unmountSD() { SD.end(); }
+
+MountTable::MountTable() : volumeCount(0), mountMutex(nullptr) {
+    memset(volumes, 0, sizeof(volumes));
+}
+
+MountTable::~MountTable() {
+    shutdown();
+}
+
+bool MountTable::init() {
+    mountMutex = xSemaphoreCreateMutex();
+    if (!mountMutex) {
+        Serial.println("MountTable: Failed to create mutex");
+        return false;
+    }
+
+    // Built-in volumes. Card slots are lazy: most deployments never use
+    // them and each failed probe costs a bus timeout.
+    const VfsBackend* flash = vfsActive();
+    registerVolume(flash->name, flash->fs, flash->mount, flash->unmount, false);
+    registerVolume("sdmmc", &SD_MMC, mountSDMMC, unmountSDMMC, MOUNT_LAZY_SD);
+    registerVolume("sd", &SD, mountSD, unmountSD, MOUNT_LAZY_SD);
+
+    Serial.println("MountTable: Mount table initialized");
+    return true;
+}
+
+void MountTable::shutdown() {
+    if (!mountMutex) {
+        return;
+    }
+
+    xSemaphoreTake(mountMutex, portMAX_DELAY);
+    for (int i = 0; i < volumeCount; i++) {
+        if (volumes[i].state == VOLUME_MOUNTED) {
+            volumes[i].unmountFn();
+            volumes[i].state = VOLUME_UNMOUNTED;
+        }
+    }
+    xSemaphoreGive(mountMutex);
+
+    vSemaphoreDelete(mountMutex);
+    mountMutex = nullptr;
+}
+
+int MountTable::registerVolume(const char* name, fs::FS* fs, VolumeMountFunction_t mountFn,
+                               VolumeUnmountFunction_t unmountFn, bool lazy) {
+    if (!name || !fs || !mountFn || !unmountFn) {
+        return -1;
+    }
+    if (volumeCount >= MOUNT_MAX_VOLUMES) {
+        Serial.println("MountTable: No free volume slots available");
+        return -1;
+    }
+
+    Volume& volume = volumes[volumeCount];
+    strncpy(volume.name, name, sizeof(volume.name) - 1);
+    volume.fs = fs;
+    volume.mountFn = mountFn;
+    volume.unmountFn = unmountFn;
+    volume.lazy = lazy;
+    volume.state = VOLUME_UNPROBED;
+
+    return volumeCount++;
+}
+
+uint8_t MountTable::saveState(VolumeSnapshot* out, uint8_t maxVolumes) {
+    uint8_t count = 0;
+    for (int i = 0; i < volumeCount && count < maxVolumes; i++) {
+        memcpy(out[count].name, volumes[i].name, sizeof(out[count].name));
+        out[count].state = volumes[i].state;
+        count++;
+    }
+    return count;
+}
+
+void MountTable::restoreState(const VolumeSnapshot* in, uint8_t count) {
+    if (!mountMutex || xSemaphoreTake(mountMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int index = findVolume(in[i].name);
+        if (index >= 0 && in[i].state == VOLUME_ABSENT &&
+            volumes[index].state == VOLUME_UNPROBED) {
+            volumes[index].state = VOLUME_ABSENT;
+        }
+    }
+
+    xSemaphoreGive(mountMutex);
+}
+
+int MountTable::findVolume(const char* name) {
+    if (!name) {
+        return -1;
+    }
+
+    for (int i = 0; i < volumeCount; i++) {
+        if (strcmp(volumes[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool MountTable::mountLocked(Volume& volume) {
+    uint32_t start = micros();
+    bool ok = volume.mountFn();
+    uint32_t elapsed = micros() - start;
+
+    if (ok) {
+        volume.state = VOLUME_MOUNTED;
+        volume.mountUs = elapsed;
+        volume.mountCount++;
+    } else {
+        volume.state = VOLUME_ABSENT;
+    }
+    Postmortem::trace(TRACE_MOUNT, ok ? 1 : 0, volume.name);
+    return ok;
+}
+
+fs::FS* MountTable::mount(const char* name, bool retry) {
+    if (!mountMutex) {
+        return nullptr;
+    }
+
+    int index = findVolume(name);
+    if (index < 0) {
+        return nullptr;
+    }
+
+    if (xSemaphoreTake(mountMutex, portMAX_DELAY) != pdTRUE) {
+        return nullptr;
+    }
+
+    Volume& volume = volumes[index];
+    fs::FS* result = nullptr;
+    if (volume.state == VOLUME_MOUNTED) {
+        result = volume.fs;
+    } else if (volume.state != VOLUME_ABSENT || retry) {
+        if (mountLocked(volume)) {
+            result = volume.fs;
+        }
+    }
+
+    xSemaphoreGive(mountMutex);
+    return result;
+}
+
+bool MountTable::unmount(const char* name) {
+    if (!mountMutex) {
+        return false;
+    }
+
+    int index = findVolume(name);
+    if (index < 0) {
+        return false;
+    }
+
+    if (xSemaphoreTake(mountMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+
+    Volume& volume = volumes[index];
+    bool wasMounted = volume.state == VOLUME_MOUNTED;
+    if (wasMounted) {
+        volume.unmountFn();
+        volume.state = VOLUME_UNMOUNTED;
+        Postmortem::trace(TRACE_MOUNT, 0, volume.name);
+    }
+
+    xSemaphoreGive(mountMutex);
+    return wasMounted;
+}
+
+bool MountTable::isMounted(const char* name) {
+    return getState(name) == VOLUME_MOUNTED;
+}
+
+VolumeState MountTable::getState(const char* name) {
+    int index = findVolume(name);
+    return index >= 0 ? volumes[index].state : VOLUME_ABSENT;
+}
+
+void MountTable::getMountedVolumes(std::vector<std::string>& names) {
+    for (int i = 0; i < volumeCount; i++) {
+        if (volumes[i].state == VOLUME_MOUNTED) {
+            names.push_back(volumes[i].name);
+        }
+    }
+}
+
+void MountTable::printTable() {
+    static const char* stateNames[] = {"unprobed", "mounted", "absent", "unmounted"};
+
+    Serial.println("Mount Table:");
+    Serial.println("Volume       State      Mode   Mounts  Mount(ms)");
+    Serial.println("-------------------------------------------------");
+
+    for (int i = 0; i < volumeCount; i++) {
+        const Volume& volume = volumes[i];
+        Serial.printf("%-12s %-10s %-5s %7u %10.1f\n",
+                      volume.name,
+                      stateNames[volume.state],
+                      volume.lazy ? "lazy" : "boot",
+                      volume.mountCount,
+                      volume.mountUs / 1000.0);
+    }
+}
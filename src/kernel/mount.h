@@ -0,0 +1,79 @@
+/*
+ * ESP32-OS Mount Table Header
+ * Probe-once, cached storage volume mounts shared across subsystems
+ */
+
+#ifndef MOUNT_H
+#define MOUNT_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <vector>
+#include <string>
+#include "FS.h"
+#include "../config/config.h"
+
+enum VolumeState {
+    VOLUME_UNPROBED = 0,    // Lazy volume not touched yet
+    VOLUME_MOUNTED,
+    VOLUME_ABSENT,          // Probe failed; cached until a forced retry
+    VOLUME_UNMOUNTED
+};
+
+// Volume state carried across a warm reboot
+struct VolumeSnapshot {
+    char name[16];
+    uint8_t state;
+};
+
+typedef bool (*VolumeMountFunction_t)();
+typedef void (*VolumeUnmountFunction_t)();
+
+struct Volume {
+    char name[16];
+    fs::FS* fs;
+    VolumeMountFunction_t mountFn;
+    VolumeUnmountFunction_t unmountFn;
+    bool lazy;              // Optional volume no boot service asks for; listed as "lazy"
+    VolumeState state;
+    uint32_t mountUs;       // Duration of the last successful mount
+    uint32_t mountCount;    // Real begin() calls issued
+};
+
+class MountTable {
+private:
+    Volume volumes[MOUNT_MAX_VOLUMES];
+    uint8_t volumeCount;
+    SemaphoreHandle_t mountMutex;
+
+    int findVolume(const char* name);
+    bool mountLocked(Volume& volume);
+
+public:
+    MountTable();
+    ~MountTable();
+
+    bool init();
+    void shutdown();
+
+    int registerVolume(const char* name, fs::FS* fs, VolumeMountFunction_t mountFn,
+                       VolumeUnmountFunction_t unmountFn, bool lazy);
+
+    // Returns the mounted handle, mounting on first use. Absent volumes are
+    // only probed again when retry is set (e.g. after inserting a card).
+    fs::FS* mount(const char* name, bool retry = false);
+    bool unmount(const char* name);
+    bool isMounted(const char* name);
+    VolumeState getState(const char* name);
+
+    // Warm reboot: only known-absent volumes are restored, so they are not
+    // probed again; everything else mounts as usual
+    uint8_t saveState(VolumeSnapshot* out, uint8_t maxVolumes);
+    void restoreState(const VolumeSnapshot* in, uint8_t count);
+
+    void getMountedVolumes(std::vector<std::string>& names);
+    void printTable();
+};
+
+#endif // MOUNT_H
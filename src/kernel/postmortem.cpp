@@ -0,0 +1,282 @@
+/*
+ * ESP32-OS Postmortem Implementation
+ */
+
+#include "postmortem.h"
+#include "checksum.h"
+
+#define POSTMORTEM_MAGIC 0x504D5254 // "PMRT"
+#define POSTMORTEM_VERSION 2
+#define TRACE_MAGIC 0x54524143      // "TRAC"
+
+// Survive software resets, panics and watchdog reboots, not power cycles
+static RTC_NOINIT_ATTR PostmortemRecord postmortemRecord;
+static RTC_NOINIT_ATTR TraceRing traceRing;
+
+volatile bool Postmortem::tracing = false;
+
+static const char* reasonNames[POSTMORTEM_REASON_COUNT] = {
+    "last checkpoint",
+    "health check failed",
+    "reboot requested"
+};
+
+static const char* traceNames[TRACE_CODE_COUNT] = {
+    "task+",
+    "task-",
+    "event",
+    "command",
+    "health",
+    "mount"
+};
+
+static const char* resetReasonName(esp_reset_reason_t reason) {
+    switch (reason) {
+        case ESP_RST_POWERON:   return "Power on";
+        case ESP_RST_EXT:       return "External pin";
+        case ESP_RST_SW:        return "Software restart";
+        case ESP_RST_PANIC:     return "Panic";
+        case ESP_RST_INT_WDT:   return "Interrupt watchdog";
+        case ESP_RST_TASK_WDT:  return "Task watchdog";
+        case ESP_RST_WDT:       return "Other watchdog";
+        case ESP_RST_DEEPSLEEP: return "Deep sleep wake";
+        case ESP_RST_BROWNOUT:  return "Brownout";
+        case ESP_RST_SDIO:      return "SDIO";
+        default:                return "Unknown";
+    }
+}
+
+bool Postmortem::wasCrashReset() const {
+    return resetReason == ESP_RST_PANIC || resetReason == ESP_RST_INT_WDT ||
+           resetReason == ESP_RST_TASK_WDT || resetReason == ESP_RST_WDT;
+}
+
+static uint32_t recordChecksum(const PostmortemRecord& record) {
+    return fnv1a(&record, offsetof(PostmortemRecord, checksum));
+}
+
+Postmortem::Postmortem() : scheduler(nullptr), memoryManager(nullptr), metrics(nullptr),
+                           captureMutex(nullptr), lastCheckpointMs(0), finalCaptured(false),
+                           previous(nullptr), previousTrace(nullptr), previousTraceCount(0),
+                           resetReason(ESP_RST_UNKNOWN) {
+}
+
+Postmortem::~Postmortem() {
+    shutdown();
+}
+
+bool Postmortem::init(Scheduler* scheduler, MemoryManager* memoryManager, MetricsRegistry* metrics) {
+    this->scheduler = scheduler;
+    this->memoryManager = memoryManager;
+    this->metrics = metrics;
+
+    captureMutex = xSemaphoreCreateMutex();
+    if (!captureMutex) {
+        Serial.println("Postmortem: Failed to create mutex");
+        return false;
+    }
+
+    loadPrevious();
+
+    // Start this boot with an empty record and trace ring
+    postmortemRecord.magic = 0;
+    traceRing.head.store(0);
+    traceRing.magic = TRACE_MAGIC;
+    tracing = true;
+
+    if (previous) {
+        Serial.printf("Postmortem: Record from previous boot available (%s, %s)\n",
+                      resetReasonName(resetReason), reasonNames[previous->reason]);
+    } else {
+        Serial.println("Postmortem: No record from previous boot");
+    }
+    return true;
+}
+
+void Postmortem::shutdown() {
+    tracing = false;
+    clearPrevious();
+
+    if (captureMutex) {
+        vSemaphoreDelete(captureMutex);
+        captureMutex = nullptr;
+    }
+}
+
+void Postmortem::loadPrevious() {
+    resetReason = esp_reset_reason();
+
+    const PostmortemRecord& record = postmortemRecord;
+    bool valid = record.magic == POSTMORTEM_MAGIC &&
+                 record.version == POSTMORTEM_VERSION &&
+                 record.reason < POSTMORTEM_REASON_COUNT &&
+                 record.taskCount <= POSTMORTEM_MAX_TASKS &&
+                 record.metricsLength <= POSTMORTEM_METRICS_SIZE &&
+                 record.checksum == recordChecksum(record);
+    if (valid) {
+        previous = new PostmortemRecord(record);
+    }
+
+    // Copy the trace oldest first
+    if (traceRing.magic == TRACE_MAGIC) {
+        uint32_t head = traceRing.head.load();
+        uint32_t count = head < POSTMORTEM_TRACE_EVENTS ? head : POSTMORTEM_TRACE_EVENTS;
+        if (count > 0) {
+            previousTrace = new TraceEvent[count];
+        }
+        if (previousTrace) {
+            for (uint32_t i = 0; i < count; i++) {
+                previousTrace[i] = traceRing.events[(head - count + i) % POSTMORTEM_TRACE_EVENTS];
+                previousTrace[i].tag[sizeof(previousTrace[i].tag) - 1] = '\0';
+            }
+            previousTraceCount = count;
+        }
+    }
+}
+
+void Postmortem::clearPrevious() {
+    if (previous) {
+        delete previous;
+        previous = nullptr;
+    }
+    if (previousTrace) {
+        delete[] previousTrace;
+        previousTrace = nullptr;
+    }
+    previousTraceCount = 0;
+}
+
+void Postmortem::capture(PostmortemReason reason) {
+    if (!captureMutex || xSemaphoreTake(captureMutex, 1000) != pdTRUE) {
+        return;
+    }
+
+    if (finalCaptured) {
+        xSemaphoreGive(captureMutex);
+        return;
+    }
+
+    // Built in place: a crash halfway leaves an invalid magic or checksum
+    PostmortemRecord& record = postmortemRecord;
+    record.magic = 0;
+    record.version = POSTMORTEM_VERSION;
+    record.reason = reason;
+    record.capturedAtMs = millis();
+
+    record.heapFree = esp_get_free_heap_size();
+    record.heapMinFree = esp_get_minimum_free_heap_size();
+    if (memoryManager) {
+        record.heapLargest = memoryManager->getLargestFreeBlock();
+        record.allocatedBytes = memoryManager->getTotalAllocated();
+        record.peakAllocated = memoryManager->getPeakAllocated();
+        record.allocationCount = memoryManager->getAllocationCount();
+        record.freeCount = memoryManager->getFreeCount();
+    } else {
+        record.heapLargest = 0;
+        record.allocatedBytes = 0;
+        record.peakAllocated = 0;
+        record.allocationCount = 0;
+        record.freeCount = 0;
+    }
+
+    record.taskCount = 0;
+    if (scheduler) {
+        uint16_t count = scheduler->snapshotTasks(taskScratch, POSTMORTEM_MAX_TASKS);
+        for (uint16_t i = 0; i < count; i++) {
+            PostmortemTask& task = record.tasks[i];
+            strncpy(task.name, taskScratch[i].name, sizeof(task.name) - 1);
+            task.name[sizeof(task.name) - 1] = '\0';
+            task.priority = taskScratch[i].priority;
+            task.state = taskScratch[i].state;
+            task.reserved = 0;
+            task.stackHighWaterMark = taskScratch[i].stackHighWaterMark;
+        }
+        record.taskCount = count;
+    }
+
+    record.metricsLength = metrics ? metrics->exportBinary(record.metrics, sizeof(record.metrics)) : 0;
+
+    record.magic = POSTMORTEM_MAGIC;
+    record.checksum = recordChecksum(record);
+
+    if (reason != POSTMORTEM_CHECKPOINT) {
+        finalCaptured = true;
+    }
+    lastCheckpointMs = record.capturedAtMs;
+
+    xSemaphoreGive(captureMutex);
+}
+
+void Postmortem::checkpoint() {
+    if (millis() - lastCheckpointMs >= POSTMORTEM_CHECKPOINT_MS || lastCheckpointMs == 0) {
+        capture(POSTMORTEM_CHECKPOINT);
+    }
+}
+
+void Postmortem::trace(TraceCode code, uint32_t arg, const char* tag) {
+    if (!tracing) {
+        return;
+    }
+
+    uint32_t index = traceRing.head.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent& event = traceRing.events[index % POSTMORTEM_TRACE_EVENTS];
+    event.timestamp = millis();
+    event.code = code;
+    event.core = xPortGetCoreID();
+    event.reserved = 0;
+    event.arg = arg;
+    if (tag) {
+        strncpy(event.tag, tag, sizeof(event.tag) - 1);
+        event.tag[sizeof(event.tag) - 1] = '\0';
+    } else {
+        event.tag[0] = '\0';
+    }
+}
+
+void Postmortem::printPrevious() {
+    Serial.printf("Reset Reason:    %s\n", resetReasonName(resetReason));
+
+    if (!previous) {
+        Serial.println("No postmortem record from the previous boot");
+    } else {
+        const PostmortemRecord& record = *previous;
+        Serial.printf("Record:          %s at uptime %lu ms\n",
+                      reasonNames[record.reason], (unsigned long)record.capturedAtMs);
+        Serial.printf("Heap:            %u free, %u min free, %u largest block\n",
+                      record.heapFree, record.heapMinFree, record.heapLargest);
+        Serial.printf("Allocator:       %u bytes (peak %u), %u allocs, %u frees\n",
+                      record.allocatedBytes, record.peakAllocated,
+                      record.allocationCount, record.freeCount);
+
+        Serial.println();
+        Serial.println("Name              Priority  State  Stack");
+        Serial.println("----------------------------------------");
+        for (int i = 0; i < record.taskCount; i++) {
+            const PostmortemTask& task = record.tasks[i];
+            Serial.printf("%-16s %8d  %5d %6u\n",
+                          task.name, task.priority, task.state, task.stackHighWaterMark);
+        }
+
+        // Same encoding as 'metrics bin'
+        if (record.metricsLength > 0) {
+            Serial.println();
+            Serial.print("MTRC ");
+            for (int i = 0; i < record.metricsLength; i++) {
+                Serial.printf("%02X", record.metrics[i]);
+            }
+            Serial.println();
+        }
+    }
+
+    if (previousTraceCount > 0) {
+        Serial.println();
+        Serial.printf("Last %u trace events:\n", previousTraceCount);
+        for (int i = 0; i < previousTraceCount; i++) {
+            const TraceEvent& event = previousTrace[i];
+            Serial.printf("  %10lu  core %u  %-8s %-12s %u\n",
+                          (unsigned long)event.timestamp, event.core,
+                          event.code < TRACE_CODE_COUNT ? traceNames[event.code] : "?",
+                          event.tag, event.arg);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ * ESP32-OS Postmortem Header
+ * Crash snapshot and trace ring kept in RTC memory across resets
+ */
+
+#ifndef POSTMORTEM_H
+#define POSTMORTEM_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_system.h>
+#include <atomic>
+#include "../config/config.h"
+#include "scheduler.h"
+#include "memory.h"
+#include "metrics.h"
+
+enum PostmortemReason {
+    POSTMORTEM_CHECKPOINT = 0,  // Periodic refresh; the reset reason tells what happened
+    POSTMORTEM_UNHEALTHY,       // loop() rebooted on a failed health check
+    POSTMORTEM_REBOOT,          // Reboot requested through the kernel
+    POSTMORTEM_REASON_COUNT
+};
+
+enum TraceCode {
+    TRACE_TASK_CREATE = 0,
+    TRACE_TASK_DELETE,
+    TRACE_EVENT,                // tag: topic, arg: event value
+    TRACE_COMMAND,              // tag: shell command
+    TRACE_HEALTH,               // arg: 1 healthy, 0 degraded
+    TRACE_MOUNT,                // tag: volume, arg: 1 mounted, 0 unmounted
+    TRACE_CODE_COUNT
+};
+
+struct TraceEvent {
+    uint32_t timestamp;         // millis()
+    uint8_t code;
+    uint8_t core;
+    uint16_t reserved;
+    uint32_t arg;
+    char tag[12];
+};
+
+struct PostmortemTask {
+    char name[16];
+    uint8_t priority;
+    uint8_t state;              // eTaskState
+    uint16_t reserved;
+    uint32_t stackHighWaterMark;
+};
+
+struct PostmortemRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reason;            // PostmortemReason
+    uint32_t capturedAtMs;      // Uptime when the record was written
+
+    // Heap and allocator summary
+    uint32_t heapFree;
+    uint32_t heapMinFree;
+    uint32_t heapLargest;
+    uint32_t allocatedBytes;
+    uint32_t peakAllocated;
+    uint32_t allocationCount;
+    uint32_t freeCount;
+
+    uint8_t taskCount;
+    PostmortemTask tasks[POSTMORTEM_MAX_TASKS];
+
+    // Metrics in the registry's binary snapshot format
+    uint16_t metricsLength;
+    uint8_t metrics[POSTMORTEM_METRICS_SIZE];
+
+    uint32_t checksum;
+};
+
+// Written continuously, so it is validated by bounds instead of a checksum
+struct TraceRing {
+    uint32_t magic;
+    std::atomic<uint32_t> head;
+    TraceEvent events[POSTMORTEM_TRACE_EVENTS];
+};
+
+class Postmortem {
+private:
+    Scheduler* scheduler;
+    MemoryManager* memoryManager;
+    MetricsRegistry* metrics;
+    SemaphoreHandle_t captureMutex;
+    uint32_t lastCheckpointMs;
+    bool finalCaptured;         // A shutdown record must not be overwritten by checkpoints
+    TaskInfo taskScratch[POSTMORTEM_MAX_TASKS];
+
+    // What the previous boot left behind
+    PostmortemRecord* previous;
+    TraceEvent* previousTrace;
+    uint16_t previousTraceCount;
+    esp_reset_reason_t resetReason;
+
+    static volatile bool tracing;
+
+    void loadPrevious();
+
+public:
+    Postmortem();
+    ~Postmortem();
+
+    bool init(Scheduler* scheduler, MemoryManager* memoryManager, MetricsRegistry* metrics);
+    void shutdown();
+
+    // Write the record now; call on the way down or from the monitor
+    void capture(PostmortemReason reason);
+    void checkpoint();
+
+    // Append to the trace ring. Safe from any task; not from ISRs.
+    static void trace(TraceCode code, uint32_t arg = 0, const char* tag = nullptr);
+
+    bool hasPrevious() const { return previous != nullptr; }
+    // Panic or watchdog: whatever ran last boot may have been the cause
+    bool wasCrashReset() const;
+    void clearPrevious();
+    void printPrevious();
+};
+
+#endif // POSTMORTEM_H
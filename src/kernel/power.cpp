@@ -0,0 +1,293 @@
+/*
+ * ESP32-OS Power Manager Implementation
+ */
+
+#include "power.h"
+#include "../hal/hal.h"
+#include <atomic>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#include <driver/uart.h>
+
+static const char* stateNames[POWER_STATE_COUNT] = {
+    "active",
+    "idle",
+    "light_sleep"
+};
+
+// millis() of the last console or button activity
+static std::atomic<uint32_t> lastActivityMs(0);
+
+PowerManager::PowerManager() : scheduler(nullptr), timerService(nullptr), eventBus(nullptr),
+                               powerTask(nullptr), running(false), lowPower(false),
+                               quiescedTasks(0), state(POWER_ACTIVE), stateSince(0),
+                               longestSleepMs(0), sleepCounter(nullptr) {
+    memset(residencyUs, 0, sizeof(residencyUs));
+    memset(wakeCounts, 0, sizeof(wakeCounts));
+    vPortCPUInitializeMutex(&lock);
+}
+
+PowerManager::~PowerManager() {
+    shutdown();
+}
+
+bool PowerManager::init(Scheduler* scheduler, TimerService* timerService, EventBus* eventBus) {
+    if (running) {
+        return true;
+    }
+
+    this->scheduler = scheduler;
+    this->timerService = timerService;
+    this->eventBus = eventBus;
+    stateSince = esp_timer_get_time();
+    notifyActivity();
+    running = true;
+
+    // Idle priority: the loop only gets to decide on sleep when its core is
+    // idle. Pinned, so the other core can be checked before sleeping.
+    if (xTaskCreatePinnedToCore(powerLoop, "kpower", POWER_TASK_STACK_SIZE, this,
+                                tskIDLE_PRIORITY, &powerTask, POWER_TASK_CORE) != pdPASS) {
+        running = false;
+        Serial.println("PowerManager: Failed to create power task");
+        return false;
+    }
+
+    Serial.println("PowerManager: Power manager initialized");
+    return true;
+}
+
+void PowerManager::shutdown() {
+    exitLowPower();
+    running = false;
+    if (powerTask) {
+        vTaskDelete(powerTask);
+        powerTask = nullptr;
+    }
+}
+
+static uint32_t sampleSleepSeconds(void* context) {
+    return ((PowerManager*)context)->getResidencyUs(POWER_LIGHT_SLEEP) / 1000000ULL;
+}
+
+void PowerManager::registerMetrics(MetricsRegistry* registry) {
+    if (!registry) {
+        return;
+    }
+
+    sleepCounter = registry->registerCounter("power_light_sleeps_total");
+    registry->registerGauge("power_light_sleep_seconds", sampleSleepSeconds, this);
+}
+
+void IRAM_ATTR PowerManager::notifyActivity() {
+    lastActivityMs.store(millis(), std::memory_order_relaxed);
+}
+
+void PowerManager::enterState(PowerState next) {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&lock);
+    residencyUs[state] += now - stateSince;
+    state = next;
+    stateSince = now;
+    portEXIT_CRITICAL(&lock);
+}
+
+bool PowerManager::enterLowPower() {
+    if (!running) {
+        return false;
+    }
+    if (lowPower) {
+        return true;
+    }
+
+    quiescedTasks = scheduler ? scheduler->suspendNonCritical() : 0;
+
+    // Any traffic on the console RX line wakes the chip
+    uart_set_wakeup_threshold(POWER_CONSOLE_UART, POWER_UART_WAKE_EDGES);
+    esp_sleep_enable_uart_wakeup(POWER_CONSOLE_UART);
+
+    enterState(POWER_IDLE);
+    notifyActivity(); // Give the console a full holdoff before the first sleep
+    lowPower = true;
+    xTaskNotifyGive(powerTask);
+
+    Serial.printf("PowerManager: Low power mode, %u tasks suspended\n", quiescedTasks);
+    return true;
+}
+
+void PowerManager::exitLowPower() {
+    if (!lowPower) {
+        return;
+    }
+
+    lowPower = false;
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_UART);
+
+    uint16_t resumed = scheduler ? scheduler->resumeNonCritical() : 0;
+    quiescedTasks = 0;
+    enterState(POWER_ACTIVE);
+    if (powerTask) {
+        xTaskNotifyGive(powerTask);
+    }
+
+    Serial.printf("PowerManager: Normal power mode, %u tasks resumed\n", resumed);
+}
+
+void PowerManager::lightSleep(uint32_t sleepMs) {
+    gpio_num_t button = (gpio_num_t)HAL_BUTTON_PIN;
+
+    esp_sleep_enable_timer_wakeup((uint64_t)sleepMs * 1000);
+    gpio_wakeup_enable(button, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+
+    // The UART stops mid-byte otherwise
+    Serial.flush();
+
+    enterState(POWER_LIGHT_SLEEP);
+    int64_t begin = esp_timer_get_time();
+    esp_light_sleep_start();
+    uint32_t slept = (esp_timer_get_time() - begin) / 1000;
+    enterState(lowPower ? POWER_IDLE : POWER_ACTIVE);
+
+    gpio_wakeup_disable(button);
+    HAL::restoreButtonInterrupt();
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+
+    switch (esp_sleep_get_wakeup_cause()) {
+        case ESP_SLEEP_WAKEUP_TIMER:
+            wakeCounts[POWER_WAKE_TIMER]++;
+            break;
+        case ESP_SLEEP_WAKEUP_UART:
+            // The byte that woke us is lost; stay up for the rest of the line
+            wakeCounts[POWER_WAKE_UART]++;
+            notifyActivity();
+            break;
+        case ESP_SLEEP_WAKEUP_GPIO:
+            // The press happened while interrupts were off
+            wakeCounts[POWER_WAKE_GPIO]++;
+            notifyActivity();
+            if (eventBus) {
+                eventBus->publish(EVENT_BUTTON_PRESSED, HAL_BUTTON_PIN);
+            }
+            break;
+        default:
+            wakeCounts[POWER_WAKE_OTHER]++;
+            break;
+    }
+
+    if (slept > longestSleepMs) {
+        longestSleepMs = slept;
+    }
+    MetricsRegistry::increment(sleepCounter);
+
+    // The FreeRTOS tick stood still; kernel timers run on esp_timer and catch up
+    if (timerService) {
+        timerService->resync();
+    }
+}
+
+// Light sleep stops both cores, so the core not running kpower must be
+// idle as well
+static bool otherCoreIdle() {
+#if portNUM_PROCESSORS > 1
+    BaseType_t other = POWER_TASK_CORE ^ 1;
+    return xTaskGetCurrentTaskHandleForCPU(other) == xTaskGetIdleTaskHandleForCPU(other);
+#else
+    return true;
+#endif
+}
+
+void PowerManager::powerLoop(void* parameter) {
+    PowerManager* self = (PowerManager*)parameter;
+
+    while (self->running) {
+        if (!self->lowPower) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        uint32_t idleMs = millis() - lastActivityMs.load(std::memory_order_relaxed);
+        if (idleMs < POWER_IDLE_HOLDOFF_MS) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(POWER_IDLE_HOLDOFF_MS - idleMs) + 1);
+            continue;
+        }
+
+        // Never sleep through a kernel timer
+        uint32_t sleepMs = self->timerService ? self->timerService->msUntilNextEvent() : UINT32_MAX;
+        if (sleepMs > POWER_MAX_SLEEP_MS) {
+            sleepMs = POWER_MAX_SLEEP_MS;
+        }
+        if (sleepMs < POWER_MIN_SLEEP_MS) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(POWER_MIN_SLEEP_MS));
+            continue;
+        }
+        if (!otherCoreIdle()) {
+            ulTaskNotifyTake(pdTRUE, 1);
+            continue;
+        }
+
+        self->lightSleep(sleepMs);
+    }
+
+    while (true) {
+        vTaskDelay(portMAX_DELAY); // Deleted by shutdown()
+    }
+}
+
+uint64_t PowerManager::getResidencyUs(PowerState which) {
+    if (which >= POWER_STATE_COUNT) {
+        return 0;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&lock);
+    uint64_t total = residencyUs[which];
+    if (state == which) {
+        total += now - stateSince;
+    }
+    portEXIT_CRITICAL(&lock);
+    return total;
+}
+
+const char* PowerManager::getStateName(PowerState which) {
+    return which < POWER_STATE_COUNT ? stateNames[which] : "unknown";
+}
+
+void PowerManager::printStatistics() {
+    uint64_t residency[POWER_STATE_COUNT];
+    uint64_t total = 0;
+    for (int i = 0; i < POWER_STATE_COUNT; i++) {
+        residency[i] = getResidencyUs((PowerState)i);
+        total += residency[i];
+    }
+
+    Serial.println("Power Manager:");
+    if (lowPower) {
+        Serial.printf("Mode:            low power, %u tasks suspended\n", quiescedTasks);
+    } else {
+        Serial.println("Mode:            normal");
+    }
+    Serial.println("State          Time (s)   Share");
+    Serial.println("--------------------------------");
+    for (int i = 0; i < POWER_STATE_COUNT; i++) {
+        Serial.printf("%-12s %10.1f %6.1f%%\n", stateNames[i],
+                      residency[i] / 1000000.0,
+                      total ? residency[i] * 100.0 / total : 0.0);
+    }
+    Serial.printf("Wake-ups:        timer %u, uart %u, gpio %u, other %u\n",
+                  wakeCounts[POWER_WAKE_TIMER], wakeCounts[POWER_WAKE_UART],
+                  wakeCounts[POWER_WAKE_GPIO], wakeCounts[POWER_WAKE_OTHER]);
+    Serial.printf("Longest sleep:   %u ms\n", longestSleepMs);
+}
+
+void PowerManager::resetStatistics() {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&lock);
+    memset(residencyUs, 0, sizeof(residencyUs));
+    stateSince = now;
+    portEXIT_CRITICAL(&lock);
+
+    memset(wakeCounts, 0, sizeof(wakeCounts));
+    longestSleepMs = 0;
+}
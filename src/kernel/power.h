@@ -0,0 +1,82 @@
+/*
+ * ESP32-OS Power Manager Header
+ * Task quiescing, idle light sleep and power state residency
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "../config/config.h"
+#include "scheduler.h"
+#include "timerwheel.h"
+#include "eventbus.h"
+#include "metrics.h"
+
+enum PowerState {
+    POWER_ACTIVE = 0,           // Normal operation
+    POWER_IDLE,                 // Quiesced, awake
+    POWER_LIGHT_SLEEP,
+    POWER_STATE_COUNT
+};
+
+enum PowerWakeSource {
+    POWER_WAKE_TIMER = 0,
+    POWER_WAKE_UART,
+    POWER_WAKE_GPIO,
+    POWER_WAKE_OTHER,
+    POWER_WAKE_COUNT
+};
+
+class PowerManager {
+private:
+    Scheduler* scheduler;
+    TimerService* timerService;
+    EventBus* eventBus;
+    TaskHandle_t powerTask;
+    portMUX_TYPE lock;
+    volatile bool running;
+    volatile bool lowPower;
+    uint16_t quiescedTasks;
+
+    // Residency accounting, esp_timer microseconds (kept across light sleep)
+    PowerState state;
+    int64_t stateSince;
+    uint64_t residencyUs[POWER_STATE_COUNT];
+    uint32_t wakeCounts[POWER_WAKE_COUNT];
+    uint32_t longestSleepMs;
+    Metric* sleepCounter;
+
+    void enterState(PowerState next);
+    void lightSleep(uint32_t sleepMs);
+
+    static void powerLoop(void* parameter);
+
+public:
+    PowerManager();
+    ~PowerManager();
+
+    bool init(Scheduler* scheduler, TimerService* timerService, EventBus* eventBus);
+    void shutdown();
+    void registerMetrics(MetricsRegistry* registry);
+
+    // Light-sleep whenever both cores are idle; the console UART, the wake
+    // button and kernel timers wake it again. Non-critical tasks created
+    // through the scheduler are suspended. Kernel workers (work queues,
+    // file I/O) are left alone and sleep is simply deferred while they run.
+    bool enterLowPower();
+    void exitLowPower();
+    bool isLowPower() const { return lowPower; }
+
+    // Defers the next sleep by POWER_IDLE_HOLDOFF_MS; safe from tasks and ISRs
+    static void IRAM_ATTR notifyActivity();
+
+    uint64_t getResidencyUs(PowerState which);
+    static const char* getStateName(PowerState which);
+    void printStatistics();
+    void resetStatistics();
+};
+
+#endif // POWER_H
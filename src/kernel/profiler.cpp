@@ -0,0 +1,313 @@
+/*
+ * ESP32-OS Profiler Implementation
+ */
+
+#include "profiler.h"
+#include <algorithm>
+#include <new>
+#if defined(__XTENSA__)
+#include <freertos/xtensa_context.h>
+
+// Interrupt depth per core, maintained by the port's interrupt entry code
+extern "C" volatile unsigned port_interruptNesting[portNUM_PROCESSORS];
+#endif
+
+static_assert((PROFILER_MAX_SAMPLES & (PROFILER_MAX_SAMPLES - 1)) == 0,
+              "PROFILER_MAX_SAMPLES must be a power of two");
+static_assert(PROFILER_MAX_TASKS < PROFILER_TASK_OTHER, "Task index must fit in a byte");
+
+Profiler* Profiler::isrInstance = nullptr;
+
+struct ArmContext {
+    Profiler* profiler;
+    int core;
+    bool arm;
+    TaskHandle_t caller;
+};
+
+Profiler::Profiler() : samples(nullptr), head(0), running(false), rateHz(0),
+                       startMs(0), durationMs(0), taskCount(0) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        timers[core] = nullptr;
+    }
+    vPortCPUInitializeMutex(&taskLock);
+}
+
+Profiler::~Profiler() {
+    shutdown();
+}
+
+bool Profiler::init() {
+    isrInstance = this;
+    Serial.println("Profiler: Sampling profiler initialized");
+    return true;
+}
+
+void Profiler::shutdown() {
+    stop();
+    if (samples) {
+        delete[] samples;
+        samples = nullptr;
+    }
+    isrInstance = nullptr;
+}
+
+uint8_t IRAM_ATTR Profiler::taskIndex(TaskHandle_t handle) {
+    uint8_t count = taskCount.load(std::memory_order_acquire);
+    for (uint8_t i = 0; i < count; i++) {
+        if (taskHandles[i] == handle) {
+            return i;
+        }
+    }
+
+    // First sighting; the other core may be adding the same task
+    uint8_t index = PROFILER_TASK_OTHER;
+    portENTER_CRITICAL_ISR(&taskLock);
+    count = taskCount.load(std::memory_order_relaxed);
+    for (uint8_t i = 0; i < count; i++) {
+        if (taskHandles[i] == handle) {
+            index = i;
+            break;
+        }
+    }
+    if (index == PROFILER_TASK_OTHER && count < PROFILER_MAX_TASKS) {
+        taskHandles[count] = handle;
+        index = count;
+        taskCount.store(count + 1, std::memory_order_release);
+    }
+    portEXIT_CRITICAL_ISR(&taskLock);
+
+    return index;
+}
+
+void IRAM_ATTR Profiler::sampleISR() {
+    Profiler* self = isrInstance;
+    if (!self || !self->running) {
+        return;
+    }
+
+    // This callback runs behind the IDF interrupt dispatcher, so EPC1 no
+    // longer belongs to the interrupted code. Entering from a task, the
+    // port saved that task's exception frame and left its address in the
+    // first word of the TCB (pxTopOfStack), which is where the PC is read.
+    // A timer that nested on another handler has no task frame to read.
+    int core = xPortGetCoreID();
+    TaskHandle_t current = xTaskGetCurrentTaskHandleForCPU(core);
+    uint32_t pc = 0;
+#if defined(__XTENSA__)
+    if (current && port_interruptNesting[core] == 1) {
+        const XtExcFrame* frame = *(const XtExcFrame* const*)current;
+        pc = frame->pc;
+    }
+#endif
+
+    uint8_t task = self->taskIndex(current);
+
+    uint32_t n = self->head.fetch_add(1, std::memory_order_relaxed);
+    ProfileSample& sample = self->samples[n & (PROFILER_MAX_SAMPLES - 1)];
+    sample.pc = pc;
+    sample.task = task;
+    sample.core = core;
+}
+
+void Profiler::armTask(void* parameter) {
+    ArmContext* context = (ArmContext*)parameter;
+    Profiler* self = context->profiler;
+    int core = context->core;
+
+    if (context->arm) {
+        hw_timer_t* timer = timerBegin(PROFILER_TIMER_BASE + core, 80, true); // 1 MHz
+        if (timer) {
+            timerAttachInterrupt(timer, sampleISR, true);
+            timerAlarmWrite(timer, 1000000UL / self->rateHz, true);
+            timerAlarmEnable(timer);
+        }
+        self->timers[core] = timer;
+    } else if (self->timers[core]) {
+        timerAlarmDisable(self->timers[core]);
+        timerDetachInterrupt(self->timers[core]);
+        timerEnd(self->timers[core]);
+        self->timers[core] = nullptr;
+    }
+
+    xTaskNotifyGive(context->caller);
+    vTaskDelete(NULL);
+}
+
+bool Profiler::runOnCore(int core, bool arm) {
+    ArmContext context;
+    context.profiler = this;
+    context.core = core;
+    context.arm = arm;
+    context.caller = xTaskGetCurrentTaskHandle();
+
+    if (xTaskCreatePinnedToCore(armTask, "prof_arm", 2048, &context,
+                                configMAX_PRIORITIES - 1, nullptr, core) != pdPASS) {
+        return false;
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return !arm || timers[core] != nullptr;
+}
+
+bool Profiler::start(uint32_t hz) {
+    if (running || hz == 0 || hz > PROFILER_MAX_HZ) {
+        return false;
+    }
+
+    if (!samples) {
+        samples = new ProfileSample[PROFILER_MAX_SAMPLES];
+        if (!samples) {
+            Serial.println("Profiler: Failed to allocate sample buffer");
+            return false;
+        }
+    }
+
+    head.store(0);
+    taskCount.store(0);
+    rateHz = hz;
+    startMs = millis();
+    durationMs = 0;
+    isrInstance = this;
+    running = true;
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (!runOnCore(core, true)) {
+            Serial.printf("Profiler: Failed to arm sampling timer on core %d\n", core);
+            stop();
+            return false;
+        }
+    }
+    return true;
+}
+
+void Profiler::stop() {
+    if (!running) {
+        return;
+    }
+
+    running = false;
+    durationMs = millis() - startMs;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        runOnCore(core, false);
+    }
+    resolveTaskNames();
+}
+
+void Profiler::resolveTaskNames() {
+    uint8_t count = taskCount.load(std::memory_order_acquire);
+#if configUSE_TRACE_FACILITY
+    for (uint8_t i = 0; i < count; i++) {
+        strcpy(taskNames[i], "exited");
+    }
+
+    // A few spare slots in case tasks were created since counting
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + 4;
+    TaskStatus_t* status = new (std::nothrow) TaskStatus_t[capacity];
+    if (!status) {
+        return;
+    }
+    UBaseType_t live = uxTaskGetSystemState(status, capacity, nullptr);
+    for (uint8_t i = 0; i < count; i++) {
+        for (UBaseType_t j = 0; j < live; j++) {
+            if (status[j].xHandle == taskHandles[i]) {
+                strncpy(taskNames[i], status[j].pcTaskName, sizeof(taskNames[i]) - 1);
+                taskNames[i][sizeof(taskNames[i]) - 1] = '\0';
+                break;
+            }
+        }
+    }
+    delete[] status;
+#else
+    // Without the system state call an exited task's handle can't be told
+    // from a live one, so names are not looked up at all
+    Serial.println("Profiler: Task names unavailable (configUSE_TRACE_FACILITY is off)");
+    for (uint8_t i = 0; i < count; i++) {
+        snprintf(taskNames[i], sizeof(taskNames[i]), "%p", taskHandles[i]);
+    }
+#endif
+}
+
+uint32_t Profiler::sampleCount() const {
+    uint32_t total = head.load(std::memory_order_relaxed);
+    return total < PROFILER_MAX_SAMPLES ? total : PROFILER_MAX_SAMPLES;
+}
+
+const char* Profiler::taskName(uint8_t index) const {
+    if (index >= taskCount.load(std::memory_order_acquire)) {
+        return "other";
+    }
+    return taskNames[index][0] ? taskNames[index] : "unnamed";
+}
+
+void Profiler::printSummary() {
+    uint32_t total = head.load(std::memory_order_relaxed);
+    uint32_t count = sampleCount();
+    uint32_t elapsed = running ? millis() - startMs : durationMs;
+
+    Serial.printf("Profiler:        %s at %u Hz per core\n", running ? "running" : "stopped", rateHz);
+    Serial.printf("Duration:        %lu ms\n", (unsigned long)elapsed);
+    Serial.printf("Samples:         %u kept, %u overwritten\n", count, total - count);
+
+    if (count == 0 || running) {
+        return;
+    }
+
+    uint32_t perTask[PROFILER_MAX_TASKS + 1] = {0};
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t task = samples[i].task;
+        perTask[task < PROFILER_MAX_TASKS ? task : PROFILER_MAX_TASKS]++;
+    }
+
+    Serial.println();
+    Serial.println("Task              Samples  Share");
+    Serial.println("--------------------------------");
+    uint8_t tasks = taskCount.load(std::memory_order_acquire);
+    for (uint8_t i = 0; i <= PROFILER_MAX_TASKS; i++) {
+        if (perTask[i] == 0 || (i < PROFILER_MAX_TASKS && i >= tasks)) {
+            continue;
+        }
+        Serial.printf("%-16s %8u %5.1f%%\n",
+                      i < PROFILER_MAX_TASKS ? taskName(i) : "other",
+                      perTask[i], 100.0f * perTask[i] / count);
+    }
+}
+
+static bool byPc(const ProfileSample& a, const ProfileSample& b) {
+    return a.pc < b.pc;
+}
+
+static bool byTaskPc(const ProfileSample& a, const ProfileSample& b) {
+    return a.task != b.task ? a.task < b.task : a.pc < b.pc;
+}
+
+void Profiler::dump(ProfileFormat format) {
+    if (running || !samples) {
+        Serial.println("Profiler: Stop the profiler before dumping");
+        return;
+    }
+
+    uint32_t count = sampleCount();
+    bool folded = format == PROFILE_FOLDED;
+
+    // Sorting loses time order, which neither format needs
+    std::sort(samples, samples + count, folded ? byTaskPc : byPc);
+
+    // Framed so tools/symbolize_profile.py can cut it out of a serial log
+    Serial.printf("PROF BEGIN format=%s rate=%u samples=%u\n",
+                  folded ? "folded" : "hist", rateHz, count);
+    uint32_t i = 0;
+    while (i < count) {
+        uint32_t j = i + 1;
+        while (j < count && samples[j].pc == samples[i].pc &&
+               (!folded || samples[j].task == samples[i].task)) {
+            j++;
+        }
+        if (folded) {
+            Serial.printf("%s;0x%08x %u\n", taskName(samples[i].task), samples[i].pc, j - i);
+        } else {
+            Serial.printf("0x%08x %u\n", samples[i].pc, j - i);
+        }
+        i = j;
+    }
+    Serial.println("PROF END");
+}
@@ -0,0 +1,75 @@
+/*
+ * ESP32-OS Profiler Header
+ * Statistical PC sampling from a per-core hardware timer interrupt
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include "../config/config.h"
+
+#define PROFILER_TASK_OTHER 0xFF    // Task table full
+
+// One interrupted instruction. Only the leaf PC is recorded; code running
+// with interrupts masked is attributed to where they were re-enabled.
+struct ProfileSample {
+    uint32_t pc;                    // 0 when the timer interrupted another handler
+    uint8_t task;                   // Index into the profiler's task table
+    uint8_t core;
+    uint16_t reserved;
+};
+
+enum ProfileFormat {
+    PROFILE_FOLDED = 0,             // "task;0xPC count", for flame graphs
+    PROFILE_HISTOGRAM               // "0xPC count", all tasks merged
+};
+
+class Profiler {
+private:
+    ProfileSample* samples;
+    std::atomic<uint32_t> head;     // Total samples taken; the buffer keeps the newest
+    volatile bool running;
+    uint32_t rateHz;
+    uint32_t startMs;
+    uint32_t durationMs;
+    hw_timer_t* timers[portNUM_PROCESSORS];
+
+    // Task handles seen by the ISR. Names are looked up once sampling stops,
+    // in task context; tasks gone by then print as "exited".
+    TaskHandle_t taskHandles[PROFILER_MAX_TASKS];
+    char taskNames[PROFILER_MAX_TASKS][16];
+    std::atomic<uint8_t> taskCount;
+    portMUX_TYPE taskLock;
+
+    static Profiler* isrInstance;
+    static void IRAM_ATTR sampleISR();
+    uint8_t IRAM_ATTR taskIndex(TaskHandle_t handle);
+
+    // Timer interrupts are allocated on the core that attaches them
+    bool runOnCore(int core, bool arm);
+    static void armTask(void* parameter);
+    void resolveTaskNames();
+
+    uint32_t sampleCount() const;
+    const char* taskName(uint8_t index) const;
+
+public:
+    Profiler();
+    ~Profiler();
+
+    bool init();
+    void shutdown();
+
+    bool start(uint32_t hz);
+    void stop();
+    bool isRunning() const { return running; }
+
+    void printSummary();
+    void dump(ProfileFormat format);
+};
+
+#endif // PROFILER_H
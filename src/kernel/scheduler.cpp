@@ -3,11 +3,15 @@
  */
 
 #include "scheduler.h"
+#include "postmortem.h"
 
-Scheduler::Scheduler() : taskCount(0), schedulerMutex(nullptr) {
+Scheduler::Scheduler() : taskCount(0), schedulerMutex(nullptr),
+                         createdCounter(nullptr), deletedCounter(nullptr) {
     // Initialize task array
     for (int i = 0; i < MAX_TASKS; i++) {
         tasks[i].active = false;
+        tasks[i].critical = false;
+        tasks[i].powerSuspended = false;
         tasks[i].handle = nullptr;
         memset(tasks[i].name, 0, sizeof(tasks[i].name));
     }
@@ -29,6 +33,20 @@ bool Scheduler::init() {
     return true;
 }
 
+static uint32_t sampleTaskCount(void* context) {
+    return ((Scheduler*)context)->getTaskCount();
+}
+
+void Scheduler::registerMetrics(MetricsRegistry* registry) {
+    if (!registry) {
+        return;
+    }
+    
+    createdCounter = registry->registerCounter("sched_tasks_created_total");
+    deletedCounter = registry->registerCounter("sched_tasks_deleted_total");
+    registry->registerGauge("sched_tasks", sampleTaskCount, this);
+}
+
 void Scheduler::shutdown() {
     // Delete all active tasks
     for (int i = 0; i < MAX_TASKS; i++) {
@@ -48,7 +66,8 @@ void Scheduler::shutdown() {
 }
 
 bool Scheduler::createTask(const char* name, TaskFunction_t taskFunction, 
-                          uint32_t stackSize, void* parameters, UBaseType_t priority) {
+                          uint32_t stackSize, void* parameters, UBaseType_t priority,
+                          bool critical) {
     if (!name || !taskFunction || !schedulerMutex) {
         return false;
     }
@@ -95,11 +114,16 @@ bool Scheduler::createTask(const char* name, TaskFunction_t taskFunction,
     // Fill task info
     strncpy(tasks[slot].name, name, sizeof(tasks[slot].name) - 1);
     tasks[slot].stackSize = stackSize;
+    tasks[slot].stackHighWaterMark = stackSize;
     tasks[slot].priority = priority;
     tasks[slot].active = true;
+    tasks[slot].critical = critical;
+    tasks[slot].powerSuspended = false;
     tasks[slot].state = eReady;
     
     taskCount++;
+    MetricsRegistry::increment(createdCounter);
+    Postmortem::trace(TRACE_TASK_CREATE, priority, name);
     
     xSemaphoreGive(schedulerMutex);
     
@@ -136,6 +160,8 @@ bool Scheduler::deleteTask(const char* name) {
     memset(tasks[slot].name, 0, sizeof(tasks[slot].name));
     
     taskCount--;
+    MetricsRegistry::increment(deletedCounter);
+    Postmortem::trace(TRACE_TASK_DELETE, 0, name);
     
     xSemaphoreGive(schedulerMutex);
     
@@ -188,6 +214,58 @@ bool Scheduler::resumeTask(const char* name) {
     return false;
 }
 
+uint16_t Scheduler::suspendNonCritical() {
+    if (!schedulerMutex) {
+        return 0;
+    }
+    
+    if (xSemaphoreTake(schedulerMutex, 1000) != pdTRUE) {
+        return 0;
+    }
+    
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    uint16_t suspended = 0;
+    
+    for (int i = 0; i < MAX_TASKS; i++) {
+        TaskInfo& task = tasks[i];
+        if (!task.active || task.critical || !task.handle || task.handle == self ||
+            task.powerSuspended || eTaskGetState(task.handle) == eSuspended) {
+            continue;
+        }
+        vTaskSuspend(task.handle);
+        task.state = eSuspended;
+        task.powerSuspended = true;
+        suspended++;
+    }
+    
+    xSemaphoreGive(schedulerMutex);
+    return suspended;
+}
+
+uint16_t Scheduler::resumeNonCritical() {
+    if (!schedulerMutex) {
+        return 0;
+    }
+    
+    if (xSemaphoreTake(schedulerMutex, 1000) != pdTRUE) {
+        return 0;
+    }
+    
+    uint16_t resumed = 0;
+    for (int i = 0; i < MAX_TASKS; i++) {
+        TaskInfo& task = tasks[i];
+        if (task.active && task.powerSuspended && task.handle) {
+            vTaskResume(task.handle);
+            task.state = eReady;
+            resumed++;
+        }
+        task.powerSuspended = false;
+    }
+    
+    xSemaphoreGive(schedulerMutex);
+    return resumed;
+}
+
 void Scheduler::listTasks() {
     if (!schedulerMutex) {
         return;
@@ -203,11 +281,7 @@ void Scheduler::listTasks() {
     
     for (int i = 0; i < MAX_TASKS; i++) {
         if (tasks[i].active) {
-            // Update task state
-            if (tasks[i].handle) {
-                tasks[i].state = eTaskGetState(tasks[i].handle);
-                tasks[i].stackHighWaterMark = uxTaskGetStackHighWaterMark(tasks[i].handle);
-            }
+            refreshTask(tasks[i]);
             
             Serial.printf("%-16s %8d  %-8s %6d\n", 
                          tasks[i].name,
@@ -223,6 +297,54 @@ void Scheduler::listTasks() {
     xSemaphoreGive(schedulerMutex);
 }
 
+uint16_t Scheduler::snapshotTasks(TaskInfo* out, uint16_t maxTasks) {
+    if (!out || !schedulerMutex) {
+        return 0;
+    }
+    
+    if (xSemaphoreTake(schedulerMutex, 1000) != pdTRUE) {
+        return 0;
+    }
+    
+    uint16_t count = 0;
+    for (int i = 0; i < MAX_TASKS && count < maxTasks; i++) {
+        if (tasks[i].active) {
+            refreshTask(tasks[i]);
+            out[count++] = tasks[i];
+        }
+    }
+    
+    xSemaphoreGive(schedulerMutex);
+    return count;
+}
+
+void Scheduler::sampleStacks() {
+    if (!schedulerMutex) {
+        return;
+    }
+    
+    if (xSemaphoreTake(schedulerMutex, 1000) != pdTRUE) {
+        return;
+    }
+    
+    for (int i = 0; i < MAX_TASKS; i++) {
+        if (tasks[i].active) {
+            refreshTask(tasks[i]);
+        }
+    }
+    
+    xSemaphoreGive(schedulerMutex);
+}
+
+void Scheduler::refreshTask(TaskInfo& task) {
+    if (!task.handle) {
+        return;
+    }
+    
+    task.state = eTaskGetState(task.handle);
+    task.stackHighWaterMark = uxTaskGetStackHighWaterMark(task.handle);
+}
+
 int Scheduler::findTaskByName(const char* name) {
     for (int i = 0; i < MAX_TASKS; i++) {
         if (tasks[i].active && strcmp(tasks[i].name, name) == 0) {
@@ -10,6 +10,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include "../config/config.h"
+#include "metrics.h"
 
 struct TaskInfo {
     char name[32];
@@ -17,8 +18,10 @@ struct TaskInfo {
     uint32_t stackSize;
     UBaseType_t priority;
     eTaskState state;
-    uint32_t stackHighWaterMark;
+    uint32_t stackHighWaterMark;    // Least free stack since creation, bytes
     bool active;
+    bool critical;              // Keeps running while the system is quiesced
+    bool powerSuspended;        // Suspended by suspendNonCritical()
 };
 
 class Scheduler {
@@ -26,9 +29,12 @@ private:
     TaskInfo tasks[MAX_TASKS];
     uint16_t taskCount;
     SemaphoreHandle_t schedulerMutex;
+    Metric* createdCounter;
+    Metric* deletedCounter;
     
     int findTaskByName(const char* name);
     int findFreeTaskSlot();
+    void refreshTask(TaskInfo& task);
     
 public:
     Scheduler();
@@ -36,17 +42,25 @@ public:
     
     bool init();
     void shutdown();
+    void registerMetrics(MetricsRegistry* registry);
     
     // Task management
     bool createTask(const char* name, TaskFunction_t taskFunction, 
-                   uint32_t stackSize, void* parameters, UBaseType_t priority);
+                   uint32_t stackSize, void* parameters, UBaseType_t priority,
+                   bool critical = false);
     bool deleteTask(const char* name);
     bool suspendTask(const char* name);
     bool resumeTask(const char* name);
     
+    // Power quiescing; tasks the user suspended stay suspended on resume
+    uint16_t suspendNonCritical();
+    uint16_t resumeNonCritical();
+    
     // Task information
     uint16_t getTaskCount() const { return taskCount; }
     bool getTaskInfo(const char* name, TaskInfo& info);
+    uint16_t snapshotTasks(TaskInfo* out, uint16_t maxTasks);
+    void sampleStacks();
     void listTasks();
     
     // System tasks info
@@ -0,0 +1,227 @@
+/*
+ * ESP32-OS Service Registry Implementation
+ */
+
+#include "services.h"
+
+static const char* stateNames[] = {"idle", "starting", "ready", "failed"};
+
+ServiceRegistry::ServiceRegistry() : serviceCount(0), createdCount(0), registryMutex(nullptr) {
+    memset(services, 0, sizeof(services));
+}
+
+ServiceRegistry::~ServiceRegistry() {
+    shutdown();
+}
+
+bool ServiceRegistry::init() {
+    registryMutex = xSemaphoreCreateRecursiveMutex();
+    if (!registryMutex) {
+        Serial.println("ServiceRegistry: Failed to create mutex");
+        return false;
+    }
+
+    Serial.println("ServiceRegistry: Service registry initialized");
+    return true;
+}
+
+void ServiceRegistry::shutdown() {
+    if (!registryMutex) {
+        return;
+    }
+
+    xSemaphoreTakeRecursive(registryMutex, portMAX_DELAY);
+
+    // Reverse creation order, so dependents go before their dependencies
+    for (int order = createdCount - 1; order >= 0; order--) {
+        for (int i = 0; i < serviceCount; i++) {
+            Service& service = services[i];
+            if (service.createOrder == order && service.state == SERVICE_READY) {
+                if (service.destroy) {
+                    service.destroy(service.instance);
+                }
+                service.instance = nullptr;
+                service.state = SERVICE_REGISTERED;
+            }
+        }
+    }
+    createdCount = 0;
+
+    xSemaphoreGiveRecursive(registryMutex);
+    vSemaphoreDelete(registryMutex);
+    registryMutex = nullptr;
+}
+
+int ServiceRegistry::findService(const char* name) {
+    for (int i = 0; i < serviceCount; i++) {
+        if (strcmp(services[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int ServiceRegistry::registerService(const char* name, ServiceFactory_t factory,
+                                     ServiceDestroy_t destroy, void* arg,
+                                     uint32_t dependsOn, uint8_t flags) {
+    if (!name || !factory || !registryMutex) {
+        return -1;
+    }
+
+    if (xSemaphoreTakeRecursive(registryMutex, 1000) != pdTRUE) {
+        return -1;
+    }
+
+    int id = -1;
+    if (findService(name) >= 0) {
+        Serial.printf("ServiceRegistry: Service '%s' already registered\n", name);
+    } else if (serviceCount >= SERVICES_MAX) {
+        Serial.println("ServiceRegistry: No free service slots available");
+    } else if (dependsOn & ~((1UL << serviceCount) - 1)) {
+        // Dependencies must already be registered, which also rules out cycles
+        Serial.printf("ServiceRegistry: Service '%s' depends on an unknown service\n", name);
+    } else {
+        id = serviceCount;
+        Service& service = services[id];
+        service.name = name;
+        service.factory = factory;
+        service.destroy = destroy;
+        service.arg = arg;
+        service.dependsOn = dependsOn;
+        service.flags = flags;
+        service.state = SERVICE_REGISTERED;
+        service.instance = nullptr;
+        service.createOrder = -1;
+        serviceCount++;
+    }
+
+    xSemaphoreGiveRecursive(registryMutex);
+    return id;
+}
+
+int ServiceRegistry::registerInstance(const char* name, void* instance) {
+    if (!instance || !registryMutex) {
+        return -1;
+    }
+
+    if (xSemaphoreTakeRecursive(registryMutex, 1000) != pdTRUE) {
+        return -1;
+    }
+
+    int id = -1;
+    if (findService(name) < 0 && serviceCount < SERVICES_MAX) {
+        id = serviceCount++;
+        Service& service = services[id];
+        memset(&service, 0, sizeof(service));
+        service.name = name;
+        service.instance = instance;
+        service.state = SERVICE_READY;
+        service.createOrder = -1; // Not ours to destroy
+    }
+
+    xSemaphoreGiveRecursive(registryMutex);
+    return id;
+}
+
+void* ServiceRegistry::acquireLocked(int id) {
+    Service& service = services[id];
+
+    if (service.state == SERVICE_READY) {
+        return service.instance;
+    }
+    if (service.state != SERVICE_REGISTERED) {
+        return nullptr; // Failed earlier
+    }
+
+    service.state = SERVICE_STARTING;
+
+    for (int dep = 0; dep < serviceCount; dep++) {
+        if ((service.dependsOn & SERVICE_DEP(dep)) && !acquireLocked(dep)) {
+            Serial.printf("ServiceRegistry: '%s' unavailable, dependency '%s' failed\n",
+                          service.name, services[dep].name);
+            service.state = SERVICE_FAILED;
+            return nullptr;
+        }
+    }
+
+    uint32_t heapBefore = esp_get_free_heap_size();
+    uint32_t start = micros();
+    void* instance = service.factory(service.arg);
+    service.createUs = micros() - start;
+    service.heapBytes = (int32_t)(heapBefore - esp_get_free_heap_size());
+
+    if (!instance) {
+        Serial.printf("ServiceRegistry: Failed to start '%s'\n", service.name);
+        service.state = SERVICE_FAILED;
+        return nullptr;
+    }
+
+    service.instance = instance;
+    service.createOrder = createdCount++;
+    // acquire() reads READY without the lock; publish the instance first
+    std::atomic_thread_fence(std::memory_order_release);
+    service.state = SERVICE_READY;
+    return instance;
+}
+
+void* ServiceRegistry::acquire(const char* name) {
+    if (!name || !registryMutex) {
+        return nullptr;
+    }
+
+    int id = findService(name);
+    if (id < 0) {
+        return nullptr;
+    }
+
+    // Fast path once created
+    if (services[id].state == SERVICE_READY) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return services[id].instance;
+    }
+
+    if (xSemaphoreTakeRecursive(registryMutex, portMAX_DELAY) != pdTRUE) {
+        return nullptr;
+    }
+    void* instance = acquireLocked(id);
+    xSemaphoreGiveRecursive(registryMutex);
+
+    return instance;
+}
+
+void* ServiceRegistry::peek(const char* name) {
+    int id = name ? findService(name) : -1;
+    if (id < 0 || services[id].state != SERVICE_READY) {
+        return nullptr;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return services[id].instance;
+}
+
+bool ServiceRegistry::startEssential() {
+    bool ok = true;
+    for (int i = 0; i < serviceCount; i++) {
+        if ((services[i].flags & SERVICE_ESSENTIAL) && !acquire(services[i].name)) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void ServiceRegistry::printServices() {
+    Serial.println("Services:");
+    Serial.println("Name         State     Boot  Create ms   Heap");
+    Serial.println("-----------------------------------------------");
+
+    for (int i = 0; i < serviceCount; i++) {
+        const Service& service = services[i];
+        bool adopted = service.factory == nullptr;
+        Serial.printf("%-12s %-9s %-4s ", service.name, stateNames[service.state],
+                      (adopted || (service.flags & SERVICE_ESSENTIAL)) ? "yes" : "no");
+        if (service.state == SERVICE_READY && !adopted) {
+            Serial.printf("%9.1f %6d\n", service.createUs / 1000.0, service.heapBytes);
+        } else {
+            Serial.println("        -      -");
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * ESP32-OS Service Registry Header
+ * Subsystems created on first use from registered factories
+ */
+
+#ifndef SERVICES_H
+#define SERVICES_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
+#include "../config/config.h"
+
+#define SERVICE_NO_DEPS 0
+#define SERVICE_DEP(id) (1UL << (id))
+
+// Service flags
+#define SERVICE_ESSENTIAL 0x01  // Created at boot by startEssential()
+
+// Factories return a ready instance, or nullptr if init failed
+typedef void* (*ServiceFactory_t)(void* arg);
+typedef void (*ServiceDestroy_t)(void* instance);
+
+enum ServiceState {
+    SERVICE_REGISTERED = 0,
+    SERVICE_STARTING,
+    SERVICE_READY,
+    SERVICE_FAILED
+};
+
+struct Service {
+    const char* name;           // Must outlive the registry (string literal)
+    ServiceFactory_t factory;
+    ServiceDestroy_t destroy;
+    void* arg;
+    uint32_t dependsOn;         // Mask of SERVICE_DEP() bits
+    uint8_t flags;
+
+    volatile ServiceState state;
+    void* instance;
+    uint32_t createUs;
+    int32_t heapBytes;          // Heap consumed by creation, approximate
+    int8_t createOrder;
+};
+
+class ServiceRegistry {
+private:
+    Service services[SERVICES_MAX];
+    uint8_t serviceCount;
+    int8_t createdCount;
+    SemaphoreHandle_t registryMutex; // Recursive: factories may acquire dependencies
+
+    int findService(const char* name);
+    void* acquireLocked(int id);
+
+public:
+    ServiceRegistry();
+    ~ServiceRegistry();
+
+    bool init();
+    void shutdown();
+
+    // Returns the service id for SERVICE_DEP(), or -1
+    int registerService(const char* name, ServiceFactory_t factory, ServiceDestroy_t destroy,
+                        void* arg = nullptr, uint32_t dependsOn = SERVICE_NO_DEPS,
+                        uint8_t flags = 0);
+    // Adopt an object created outside the registry; it is never destroyed here
+    int registerInstance(const char* name, void* instance);
+
+    template<typename T>
+    int registerService(const char* name, uint32_t dependsOn = SERVICE_NO_DEPS, uint8_t flags = 0) {
+        return registerService(name, createService<T>, destroyService<T>, nullptr, dependsOn, flags);
+    }
+
+    // Create on first use, dependencies first; nullptr if unknown or failed
+    void* acquire(const char* name);
+    // Never creates
+    void* peek(const char* name);
+
+    template<typename T>
+    T* get(const char* name) { return static_cast<T*>(acquire(name)); }
+    template<typename T>
+    T* find(const char* name) { return static_cast<T*>(peek(name)); }
+
+    bool startEssential();
+    void printServices();
+
+    // Default factory for classes with init()/shutdown()
+    template<typename T>
+    static void* createService(void* arg) {
+        T* instance = new T();
+        if (instance && !instance->init()) {
+            delete instance;
+            instance = nullptr;
+        }
+        return instance;
+    }
+    template<typename T>
+    static void destroyService(void* instance) {
+        delete static_cast<T*>(instance);
+    }
+};
+
+#endif // SERVICES_H
@@ -0,0 +1,352 @@
+/*
+ * ESP32-OS Stack Tuner Implementation
+ */
+
+#include "stacktune.h"
+#include "checksum.h"
+#include "kernel.h"
+#include "../filesystem/fs.h"
+
+#define STACK_TUNE_HEADER 8     // Magic, version and count
+
+// Working copy for update(); too large for the timer service stack
+static TaskInfo taskScratch[MAX_TASKS];
+
+StackTuner::StackTuner() : profileCount(0), tunerMutex(nullptr), crashReset(false),
+                           loaded(false), dirty(false), lastUpdateMs(0), lastSaveMs(0),
+                           createdCount(0) {
+    memset(profiles, 0, sizeof(profiles));
+    memset(createdNames, 0, sizeof(createdNames));
+}
+
+StackTuner::~StackTuner() {
+    shutdown();
+}
+
+bool StackTuner::init(Postmortem* postmortem) {
+    tunerMutex = xSemaphoreCreateMutex();
+    if (!tunerMutex) {
+        Serial.println("StackTuner: Failed to create mutex");
+        return false;
+    }
+
+    crashReset = postmortem && postmortem->wasCrashReset();
+    lastUpdateMs = millis();
+    lastSaveMs = lastUpdateMs;
+
+    Serial.println("StackTuner: Stack tuner initialized");
+    return true;
+}
+
+void StackTuner::shutdown() {
+    if (tunerMutex) {
+        vSemaphoreDelete(tunerMutex);
+        tunerMutex = nullptr;
+    }
+}
+
+StackProfile* StackTuner::findLocked(const char* name, bool create) {
+    for (int i = 0; i < profileCount; i++) {
+        if (strncmp(profiles[i].name, name, sizeof(profiles[i].name) - 1) == 0) {
+            return &profiles[i];
+        }
+    }
+
+    if (!create || profileCount >= STACK_TUNE_MAX_PROFILES) {
+        return nullptr;
+    }
+
+    StackProfile* profile = &profiles[profileCount++];
+    memset(profile, 0, sizeof(*profile));
+    strncpy(profile->name, name, sizeof(profile->name) - 1);
+    return profile;
+}
+
+// Only a file system something else already started; the tuner never
+// mounts storage on its own
+FileSystem* StackTuner::fileSystem() {
+    ServiceRegistry* services = kernel ? kernel->getServices() : nullptr;
+    return services ? services->find<FileSystem>("fs") : nullptr;
+}
+
+// One profile at a time, so loading needs no table on the caller's stack
+bool StackTuner::readProfiles(FileSystem* fs, uint16_t count, uint32_t& hash, bool merge) {
+    for (uint16_t i = 0; i < count; i++) {
+        StackProfile stored;
+        size_t offset = STACK_TUNE_HEADER + i * sizeof(StackProfile);
+        if (fs->read(STACK_TUNE_PATH, offset, (uint8_t*)&stored, sizeof(stored)) != sizeof(stored)) {
+            return false;
+        }
+        hash = fnv1a(&stored, sizeof(stored), hash);
+        if (!merge) {
+            continue;
+        }
+
+        // Tasks may already have been observed before the file system came up
+        stored.name[sizeof(stored.name) - 1] = '\0';
+        StackProfile* profile = findLocked(stored.name, true);
+        if (profile) {
+            if (stored.peakUsed > profile->peakUsed) {
+                profile->peakUsed = stored.peakUsed;
+            }
+            profile->observedSeconds += stored.observedSeconds;
+        }
+    }
+    return true;
+}
+
+void StackTuner::loadLocked() {
+    FileSystem* fs = loaded ? nullptr : fileSystem();
+    if (!fs) {
+        return;
+    }
+    loaded = true;
+
+    size_t size = fs->getFileSize(STACK_TUNE_PATH);
+    if (size == 0) {
+        return; // First boot with tuning
+    }
+
+    uint32_t magic = 0;
+    uint16_t version = 0;
+    uint16_t count = 0;
+    uint32_t checksum = 0;
+    bool ok = fs->read(STACK_TUNE_PATH, 0, (uint8_t*)&magic, sizeof(magic)) == sizeof(magic) &&
+              fs->read(STACK_TUNE_PATH, 4, (uint8_t*)&version, sizeof(version)) == sizeof(version) &&
+              fs->read(STACK_TUNE_PATH, 6, (uint8_t*)&count, sizeof(count)) == sizeof(count) &&
+              magic == STACK_TUNE_MAGIC && version == STACK_TUNE_VERSION &&
+              count <= STACK_TUNE_MAX_PROFILES &&
+              size == STACK_TUNE_HEADER + count * sizeof(StackProfile) + sizeof(checksum);
+
+    // Verified in full before anything is merged
+    uint32_t hash = fnv1a(&magic, sizeof(magic));
+    hash = fnv1a(&version, sizeof(version), hash);
+    hash = fnv1a(&count, sizeof(count), hash);
+    ok = ok && readProfiles(fs, count, hash, false) &&
+         fs->read(STACK_TUNE_PATH, size - sizeof(checksum), (uint8_t*)&checksum,
+                  sizeof(checksum)) == sizeof(checksum) &&
+         hash == checksum;
+    if (!ok) {
+        Serial.println("StackTuner: Ignoring corrupt stack profile");
+        return;
+    }
+    readProfiles(fs, count, hash, true);
+
+    // Any shrunk stack may be what overflowed. Every profile goes back to
+    // the requested size while it relearns, and its peak grows by the
+    // margin so the next recommendation is larger than the one that failed.
+    if (crashReset && profileCount > 0) {
+        for (int i = 0; i < profileCount; i++) {
+            profiles[i].peakUsed += profiles[i].peakUsed * STACK_TUNE_MARGIN_PERCENT / 100;
+            profiles[i].observedSeconds = 0;
+        }
+        dirty = true;
+        Serial.println("StackTuner: Crash reset, stack profiles relearning with more headroom");
+    }
+}
+
+bool StackTuner::needsLoad() const {
+    return !loaded && fileSystem() != nullptr;
+}
+
+void StackTuner::load() {
+    if (!tunerMutex || xSemaphoreTake(tunerMutex, 1000) != pdTRUE) {
+        return;
+    }
+    loadLocked();
+    xSemaphoreGive(tunerMutex);
+}
+
+uint32_t StackTuner::recommend(uint32_t peakUsed) const {
+    uint32_t headroom = peakUsed * STACK_TUNE_MARGIN_PERCENT / 100;
+    if (headroom < STACK_TUNE_MIN_HEADROOM) {
+        headroom = STACK_TUNE_MIN_HEADROOM;
+    }
+
+    uint32_t size = peakUsed + headroom;
+    size = (size + STACK_TUNE_ROUNDING - 1) / STACK_TUNE_ROUNDING * STACK_TUNE_ROUNDING;
+    return size < STACK_TUNE_MIN_SIZE ? STACK_TUNE_MIN_SIZE : size;
+}
+
+void StackTuner::noteCreated(const char* name, uint32_t requested, uint32_t used) {
+    int slot = -1;
+    for (int i = 0; i < createdCount; i++) {
+        if (strcmp(createdNames[i], name) == 0) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        if (createdCount >= MAX_TASKS) {
+            return;
+        }
+        slot = createdCount++;
+        strncpy(createdNames[slot], name, sizeof(createdNames[slot]) - 1);
+    }
+    requestedSizes[slot] = requested;
+    createdSizes[slot] = used;
+}
+
+uint32_t StackTuner::tune(const char* name, uint32_t requested) {
+    if (!name || !tunerMutex || xSemaphoreTake(tunerMutex, 1000) != pdTRUE) {
+        return requested;
+    }
+
+    loadLocked();
+
+    uint32_t size = requested;
+    uint32_t peak = 0;
+    StackProfile* profile = findLocked(name, false);
+    if (STACK_TUNE_APPLY && profile && profile->peakUsed > 0 &&
+        profile->observedSeconds >= STACK_TUNE_MIN_OBSERVED_S) {
+        peak = profile->peakUsed;
+        size = recommend(peak);
+    }
+    noteCreated(name, requested, size);
+
+    xSemaphoreGive(tunerMutex);
+
+    if (size != requested) {
+        Serial.printf("StackTuner: '%s' stack %u -> %u bytes (peak %u)\n",
+                      name, requested, size, peak);
+    }
+    return size;
+}
+
+void StackTuner::update(Scheduler* scheduler) {
+    if (!scheduler || !tunerMutex || xSemaphoreTake(tunerMutex, 1000) != pdTRUE) {
+        return;
+    }
+
+    uint32_t elapsed = (millis() - lastUpdateMs) / 1000;
+    lastUpdateMs += elapsed * 1000;
+
+    uint16_t count = scheduler->snapshotTasks(taskScratch, MAX_TASKS);
+    for (int i = 0; i < count; i++) {
+        const TaskInfo& task = taskScratch[i];
+        if (task.stackHighWaterMark > task.stackSize) {
+            continue;
+        }
+
+        StackProfile* profile = findLocked(task.name, true);
+        if (!profile) {
+            continue;
+        }
+
+        uint32_t used = task.stackSize - task.stackHighWaterMark;
+        if (used > profile->peakUsed) {
+            profile->peakUsed = used;
+            dirty = true;
+        }
+
+        // Persist once a profile becomes trusted; after that only new peaks matter
+        uint32_t before = profile->observedSeconds;
+        profile->observedSeconds += elapsed;
+        if (before < STACK_TUNE_MIN_OBSERVED_S && profile->observedSeconds >= STACK_TUNE_MIN_OBSERVED_S) {
+            dirty = true;
+        }
+    }
+
+    xSemaphoreGive(tunerMutex);
+}
+
+bool StackTuner::needsSave() const {
+    return dirty && loaded && millis() - lastSaveMs >= STACK_TUNE_SAVE_INTERVAL_MS;
+}
+
+bool StackTuner::save() {
+    if (!tunerMutex || xSemaphoreTake(tunerMutex, 1000) != pdTRUE) {
+        return false;
+    }
+
+    // Saving before loading would drop the stored history
+    loadLocked();
+    FileSystem* fs = loaded ? fileSystem() : nullptr;
+
+    uint32_t magic = STACK_TUNE_MAGIC;
+    uint16_t version = STACK_TUNE_VERSION;
+    uint16_t count = profileCount;
+    size_t bytes = count * sizeof(StackProfile);
+    size_t total = STACK_TUNE_HEADER + bytes + sizeof(uint32_t);
+    uint8_t* image = fs ? (uint8_t*)malloc(total) : nullptr;
+    if (!image) {
+        xSemaphoreGive(tunerMutex);
+        Serial.println("StackTuner: File system not available for the stack profile");
+        return false;
+    }
+
+    memcpy(image, &magic, sizeof(magic));
+    memcpy(image + 4, &version, sizeof(version));
+    memcpy(image + 6, &count, sizeof(count));
+    memcpy(image + STACK_TUNE_HEADER, profiles, bytes);
+    uint32_t checksum = fnv1a(image, STACK_TUNE_HEADER + bytes);
+    memcpy(image + STACK_TUNE_HEADER + bytes, &checksum, sizeof(checksum));
+
+    // Replaced atomically, so a reset mid-save keeps the previous profile
+    bool ok = fs->writeFile(STACK_TUNE_PATH, image, total);
+    free(image);
+
+    if (ok) {
+        dirty = false;
+    }
+    lastSaveMs = millis();
+
+    xSemaphoreGive(tunerMutex);
+    return ok;
+}
+
+bool StackTuner::clear() {
+    if (!tunerMutex || xSemaphoreTake(tunerMutex, 1000) != pdTRUE) {
+        return false;
+    }
+
+    profileCount = 0;
+    dirty = false;
+    FileSystem* fs = fileSystem();
+    if (fs && fs->fileExists(STACK_TUNE_PATH)) {
+        fs->deleteFile(STACK_TUNE_PATH);
+    }
+
+    xSemaphoreGive(tunerMutex);
+    return true;
+}
+
+void StackTuner::printReport(Scheduler* scheduler) {
+    update(scheduler);
+
+    if (!tunerMutex || xSemaphoreTake(tunerMutex, 1000) != pdTRUE) {
+        return;
+    }
+
+    Serial.println("Stack Profiles:");
+    Serial.println("Task              Asked   Given    Peak  Recommend  Observed");
+    Serial.println("-------------------------------------------------------------");
+
+    int32_t reclaimable = 0;
+    for (int i = 0; i < profileCount; i++) {
+        const StackProfile& profile = profiles[i];
+        uint32_t recommended = recommend(profile.peakUsed);
+
+        int slot = -1;
+        for (int c = 0; c < createdCount; c++) {
+            if (strcmp(createdNames[c], profile.name) == 0) {
+                slot = c;
+                break;
+            }
+        }
+
+        if (slot >= 0) {
+            Serial.printf("%-16s %6u %7u", profile.name, requestedSizes[slot], createdSizes[slot]);
+            reclaimable += (int32_t)createdSizes[slot] - (int32_t)recommended;
+        } else {
+            Serial.printf("%-16s %6s %7s", profile.name, "-", "-");
+        }
+        Serial.printf(" %7u %10u %8us%s\n", profile.peakUsed, recommended, profile.observedSeconds,
+                      profile.observedSeconds < STACK_TUNE_MIN_OBSERVED_S ? " (learning)" : "");
+    }
+
+    Serial.printf("Reclaimable now: %d bytes (%s on next boot)\n", reclaimable,
+                  STACK_TUNE_APPLY ? "applied" : "not applied");
+
+    xSemaphoreGive(tunerMutex);
+}
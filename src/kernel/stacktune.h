@@ -0,0 +1,78 @@
+/*
+ * ESP32-OS Stack Tuner Header
+ * Per-task stack peaks persisted across boots to right-size task stacks
+ */
+
+#ifndef STACKTUNE_H
+#define STACKTUNE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "../config/config.h"
+#include "scheduler.h"
+#include "postmortem.h"
+
+class FileSystem;
+
+struct StackProfile {
+    char name[16];              // configMAX_TASK_NAME_LEN
+    uint32_t peakUsed;          // Most stack ever used, bytes, over all boots
+    uint32_t observedSeconds;   // Total run time behind the peak
+};
+
+// File layout: u32 magic "STKP", u16 version, u16 count, profiles[],
+// u32 FNV-1a over everything before it
+#define STACK_TUNE_MAGIC 0x504B5453
+#define STACK_TUNE_VERSION 1
+
+class StackTuner {
+private:
+    StackProfile profiles[STACK_TUNE_MAX_PROFILES];
+    uint8_t profileCount;
+    SemaphoreHandle_t tunerMutex;
+    bool crashReset;            // Last boot ended in a panic or watchdog reset
+    bool loaded;
+    bool dirty;
+    uint32_t lastUpdateMs;
+    uint32_t lastSaveMs;
+
+    // Stack size each task was created with, for the report
+    char createdNames[MAX_TASKS][16];
+    uint32_t createdSizes[MAX_TASKS];
+    uint32_t requestedSizes[MAX_TASKS];
+    uint8_t createdCount;
+
+    StackProfile* findLocked(const char* name, bool create);
+    static FileSystem* fileSystem();
+    bool readProfiles(FileSystem* fs, uint16_t count, uint32_t& hash, bool merge);
+    void loadLocked();
+    void noteCreated(const char* name, uint32_t requested, uint32_t used);
+
+public:
+    StackTuner();
+    ~StackTuner();
+
+    bool init(Postmortem* postmortem);
+    void shutdown();
+
+    // Stack size to create a task with: the request, or the recommendation
+    // once the task has a long enough history
+    uint32_t tune(const char* name, uint32_t requested);
+    uint32_t recommend(uint32_t peakUsed) const;
+
+    // Profiles are read once the file system service is up; never mounts it
+    bool needsLoad() const;
+    void load();
+
+    // Folds current high-water marks into the profiles
+    void update(Scheduler* scheduler);
+    bool isDirty() const { return dirty; }
+    bool needsSave() const;     // Dirty and not saved within STACK_TUNE_SAVE_INTERVAL_MS
+    bool save();
+
+    void printReport(Scheduler* scheduler);
+    bool clear();
+};
+
+#endif // STACKTUNE_H
@@ -0,0 +1,75 @@
+/*
+ * ESP32-OS System Statistics Header
+ * Consistent, lock-free snapshot of kernel and memory statistics
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+
+struct SystemStats {
+    uint32_t sampleTime;        // millis() when published
+    uint32_t uptime;            // Seconds since kernel init
+    bool healthy;
+
+    // Heap
+    uint32_t freeMem;
+    uint32_t minFreeMem;
+    uint32_t largestFreeBlock;
+
+    // Tasks
+    uint32_t totalTasks;
+
+    // Memory manager
+    uint32_t totalAllocated;
+    uint32_t peakAllocated;
+    uint32_t allocationCount;
+    uint32_t freeCount;
+};
+
+// Single-writer sequence lock. Readers never block the writer and retry
+// if a publish overlapped their copy; the sequence is odd while writing.
+template <typename T>
+class SeqLock {
+private:
+    std::atomic<uint32_t> sequence;
+    T data;
+
+public:
+    SeqLock() : sequence(0) {
+        memset(&data, 0, sizeof(data));
+    }
+
+    void write(const T& value) {
+        // Keep same-core readers from preempting a half-written copy;
+        // readers on the other core simply retry
+        vTaskSuspendAll();
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        data = value;
+        sequence.store(seq + 2, std::memory_order_release);
+        xTaskResumeAll();
+    }
+
+    void read(T& out) const {
+        uint32_t begin, end;
+        do {
+            begin = sequence.load(std::memory_order_acquire);
+            out = data;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            end = sequence.load(std::memory_order_relaxed);
+        } while ((begin & 1) || begin != end);
+    }
+
+    // Number of completed publishes
+    uint32_t generation() const {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+};
+
+#endif // STATS_H
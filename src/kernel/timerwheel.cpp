@@ -0,0 +1,514 @@
+/*
+ * ESP32-OS Timer Wheel Implementation
+ */
+
+#include "timerwheel.h"
+#include <freertos/timers.h>
+#include <esp_timer.h>
+
+static_assert(TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS < 32,
+              "The wheel range must fit in a 32-bit tick");
+
+#define TIMER_WHEEL_RANGE (1UL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+
+// Wheel ticks follow esp_timer rather than the FreeRTOS tick count, which
+// stands still while the chip is in light sleep
+static inline uint32_t wheelNow() {
+    return (uint32_t)(esp_timer_get_time() / (portTICK_PERIOD_MS * 1000));
+}
+
+static inline void listInit(TimerLink* head) {
+    head->next = head;
+    head->prev = head;
+}
+
+static inline bool listEmpty(const TimerLink* head) {
+    return head->next == head;
+}
+
+static inline void listAppend(TimerLink* head, TimerLink* link) {
+    link->prev = head->prev;
+    link->next = head;
+    head->prev->next = link;
+    head->prev = link;
+}
+
+static inline void listUnlink(TimerLink* link) {
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->next = nullptr;
+    link->prev = nullptr;
+}
+
+// Move every node of 'from' to the tail of 'to' in O(1)
+static inline void listSplice(TimerLink* from, TimerLink* to) {
+    if (listEmpty(from)) {
+        return;
+    }
+    from->next->prev = to->prev;
+    to->prev->next = from->next;
+    from->prev->next = to;
+    to->prev = from->prev;
+    listInit(from);
+}
+
+TimerService::TimerService() : currentTick(0), activeCount(0), serviceTask(nullptr),
+                               running(false), fired(0), cascaded(0), maxBatch(0),
+                               maxLateTicks(0) {
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (uint32_t slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+            listInit(&wheel[level][slot]);
+        }
+    }
+    listInit(&expired);
+    vPortCPUInitializeMutex(&lock);
+}
+
+TimerService::~TimerService() {
+    shutdown();
+}
+
+bool TimerService::init() {
+    if (running) {
+        return true;
+    }
+
+    currentTick = wheelNow();
+    running = true;
+
+    if (xTaskCreate(serviceLoop, "ktimer", TIMER_SERVICE_STACK_SIZE, this,
+                    TIMER_SERVICE_PRIORITY, &serviceTask) != pdPASS) {
+        running = false;
+        Serial.println("TimerService: Failed to create service task");
+        return false;
+    }
+
+    Serial.println("TimerService: Timer wheel initialized");
+    return true;
+}
+
+void TimerService::shutdown() {
+    running = false;
+    if (serviceTask) {
+        vTaskDelete(serviceTask);
+        serviceTask = nullptr;
+    }
+}
+
+static uint32_t sampleActive(void* context) { return ((TimerService*)context)->getActiveCount(); }
+
+void TimerService::registerMetrics(MetricsRegistry* registry) {
+    if (!registry) {
+        return;
+    }
+
+    registry->registerGauge("timers_active", sampleActive, this);
+}
+
+void TimerService::setup(SoftTimer* timer, SoftTimerCallback_t callback, void* arg) {
+    timer->link.next = nullptr;
+    timer->link.prev = nullptr;
+    timer->expires = 0;
+    timer->period = 0;
+    timer->callback = callback;
+    timer->arg = arg;
+}
+
+void TimerService::addLocked(SoftTimer* timer) {
+    uint32_t delta = timer->expires - currentTick;
+    if ((int32_t)delta < 0) {
+        // Already due; the slot for the current tick is processed next
+        timer->expires = currentTick;
+        delta = 0;
+    }
+
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 &&
+           delta >= (1UL << (TIMER_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+
+    // Beyond the wheel's range: park in the furthest slot and re-cascade later
+    uint32_t slotTick = timer->expires;
+    if (delta >= TIMER_WHEEL_RANGE) {
+        slotTick = currentTick + TIMER_WHEEL_RANGE - 1;
+    }
+
+    uint32_t index = (slotTick >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+    listAppend(&wheel[level][index], &timer->link);
+}
+
+void TimerService::cascadeLocked(int level, uint32_t index) {
+    TimerLink pending;
+    listInit(&pending);
+    listSplice(&wheel[level][index], &pending);
+
+    while (!listEmpty(&pending)) {
+        TimerLink* link = pending.next;
+        listUnlink(link);
+        addLocked((SoftTimer*)link);
+        cascaded++;
+    }
+}
+
+void TimerService::advanceLocked() {
+    currentTick++;
+    uint32_t index = currentTick & TIMER_WHEEL_MASK;
+
+    // Pull the next span of each outer level down once the inner one wraps
+    if (index == 0) {
+        for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            uint32_t outer = (currentTick >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+            cascadeLocked(level, outer);
+            if (outer != 0) {
+                break;
+            }
+        }
+    }
+
+    listSplice(&wheel[0][index], &expired);
+}
+
+void TimerService::runExpired() {
+    uint32_t batch = 0;
+
+    while (true) {
+        portENTER_CRITICAL(&lock);
+        if (listEmpty(&expired)) {
+            portEXIT_CRITICAL(&lock);
+            break;
+        }
+
+        SoftTimer* timer = (SoftTimer*)expired.next;
+        listUnlink(&timer->link);
+
+        uint32_t late = wheelNow() - timer->expires;
+        if (late > maxLateTicks) {
+            maxLateTicks = late;
+        }
+
+        // Re-arm before the callback so it may cancel or restart the timer
+        if (timer->period) {
+            timer->expires += timer->period;
+            if ((int32_t)(timer->expires - currentTick) <= 0) {
+                timer->expires = currentTick + timer->period; // Skip missed periods
+            }
+            addLocked(timer);
+        } else {
+            activeCount--;
+        }
+
+        SoftTimerCallback_t callback = timer->callback;
+        void* arg = timer->arg;
+        portEXIT_CRITICAL(&lock);
+
+        // A cancel racing with expiry may still see this one last callback
+        if (callback) {
+            callback(arg);
+        }
+        batch++;
+    }
+
+    fired += batch;
+    if (batch > maxBatch) {
+        maxBatch = batch;
+    }
+}
+
+uint32_t TimerService::ticksUntilNextLocked() {
+    if (activeCount == 0) {
+        return portMAX_DELAY;
+    }
+
+    uint32_t index = currentTick & TIMER_WHEEL_MASK;
+    for (uint32_t i = 1; i < TIMER_WHEEL_SLOTS - index; i++) {
+        if (!listEmpty(&wheel[0][index + i])) {
+            return i;
+        }
+    }
+    return TIMER_WHEEL_SLOTS - index;
+}
+
+void TimerService::serviceLoop(void* parameter) {
+    TimerService* self = (TimerService*)parameter;
+
+    while (self->running) {
+        uint32_t now = wheelNow();
+
+        // Catch up tick by tick; every timer due by now joins one batch
+        // (start() may move an empty wheel past 'now')
+        while ((int32_t)(now - self->currentTick) > 0) {
+            portENTER_CRITICAL(&self->lock);
+            if (self->activeCount == 0) {
+                self->currentTick = now;
+            } else {
+                self->advanceLocked();
+            }
+            portEXIT_CRITICAL(&self->lock);
+        }
+
+        self->runExpired();
+
+        // Sleep until the next occupied inner slot or the next cascade
+        portENTER_CRITICAL(&self->lock);
+        TickType_t wait = self->ticksUntilNextLocked();
+        portEXIT_CRITICAL(&self->lock);
+
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+
+    while (true) {
+        vTaskDelay(portMAX_DELAY); // Deleted by shutdown()
+    }
+}
+
+bool TimerService::start(SoftTimer* timer, uint32_t delayMs, uint32_t periodMs) {
+    if (!timer || !running) {
+        return false;
+    }
+
+    uint32_t now = wheelNow();
+    uint32_t delay = pdMS_TO_TICKS(delayMs);
+
+    portENTER_CRITICAL(&lock);
+    if (isPending(timer)) {
+        listUnlink(&timer->link);
+    } else {
+        if (activeCount == 0) {
+            currentTick = now; // Empty wheel: nothing depends on the old position
+        }
+        activeCount++;
+    }
+
+    timer->period = periodMs ? pdMS_TO_TICKS(periodMs) : 0;
+    if (periodMs && timer->period == 0) {
+        timer->period = 1;
+    }
+    timer->expires = now + (delay ? delay : 1);
+    addLocked(timer);
+    portEXIT_CRITICAL(&lock);
+
+    // The service may be sleeping past the new deadline
+    xTaskNotifyGive(serviceTask);
+    return true;
+}
+
+bool TimerService::cancel(SoftTimer* timer) {
+    if (!timer) {
+        return false;
+    }
+
+    bool wasPending = false;
+    portENTER_CRITICAL(&lock);
+    if (isPending(timer)) {
+        listUnlink(&timer->link);
+        activeCount--;
+        wasPending = true;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    return wasPending;
+}
+
+uint32_t TimerService::msUntilNextEvent() {
+    portENTER_CRITICAL(&lock);
+    uint32_t ticks = ticksUntilNextLocked();
+    uint32_t elapsed = wheelNow() - currentTick; // Ticks the service has yet to catch up
+    portEXIT_CRITICAL(&lock);
+
+    if (ticks == portMAX_DELAY) {
+        return UINT32_MAX;
+    }
+    return ticks > elapsed ? (ticks - elapsed) * portTICK_PERIOD_MS : 0;
+}
+
+void TimerService::resync() {
+    if (serviceTask) {
+        xTaskNotifyGive(serviceTask);
+    }
+}
+
+void TimerService::printStatistics() {
+    Serial.println("Timer Wheel Statistics:");
+    Serial.printf("Geometry:        %d levels x %lu slots, %lu ms range\n",
+                  TIMER_WHEEL_LEVELS, (unsigned long)TIMER_WHEEL_SLOTS,
+                  (unsigned long)(TIMER_WHEEL_RANGE * portTICK_PERIOD_MS));
+    Serial.printf("Active timers:   %u\n", activeCount);
+    Serial.printf("Fired:           %u\n", fired);
+    Serial.printf("Cascaded:        %u\n", cascaded);
+    Serial.printf("Largest batch:   %u\n", maxBatch);
+    Serial.printf("Max lateness:    %lu ms\n", (unsigned long)(maxLateTicks * portTICK_PERIOD_MS));
+}
+
+// Benchmark bookkeeping shared by both timer implementations
+struct TimerBenchResult {
+    uint32_t startCycles;
+    uint32_t cancelCycles;
+    uint32_t maxLate;
+    uint64_t totalLate;
+    uint32_t memory;
+    bool complete;
+};
+
+static TickType_t* benchDue = nullptr;
+static std::atomic<uint32_t> benchFired(0);
+static std::atomic<uint32_t> benchMaxLate(0);
+static std::atomic<uint32_t> benchTotalLate(0);
+
+static void benchRecord(uint32_t index) {
+    uint32_t late = xTaskGetTickCount() - benchDue[index];
+    uint32_t max = benchMaxLate.load(std::memory_order_relaxed);
+    while (late > max && !benchMaxLate.compare_exchange_weak(max, late)) {
+    }
+    benchTotalLate.fetch_add(late, std::memory_order_relaxed);
+    benchFired.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void benchWheelCallback(void* arg) {
+    benchRecord((uint32_t)(uintptr_t)arg);
+}
+
+static void benchRtosCallback(TimerHandle_t handle) {
+    benchRecord((uint32_t)(uintptr_t)pvTimerGetTimerID(handle));
+}
+
+static uint32_t benchDelayMs(uint32_t index) {
+    // Spread deadlines over a second without clustering
+    return TIMER_BENCH_MIN_DELAY_MS + (index * 7919UL) % 1000;
+}
+
+static void benchReset() {
+    benchFired.store(0);
+    benchMaxLate.store(0);
+    benchTotalLate.store(0);
+}
+
+static bool benchWait(uint32_t count) {
+    uint32_t deadline = millis() + TIMER_BENCH_MIN_DELAY_MS + 3000;
+    while (benchFired.load() < count && (int32_t)(millis() - deadline) < 0) {
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+    return benchFired.load() >= count;
+}
+
+static void printBenchRow(const char* name, const TimerBenchResult& result, uint32_t count) {
+    float mhz = ESP.getCpuFreqMHz();
+    Serial.printf("%-16s %9.2f %10.2f %9u %9.2f %9u%s\n", name,
+                  result.startCycles / mhz / count,
+                  result.cancelCycles / mhz / count,
+                  (unsigned)(result.maxLate * portTICK_PERIOD_MS),
+                  (float)result.totalLate * portTICK_PERIOD_MS / count,
+                  result.memory,
+                  result.complete ? "" : "  (incomplete)");
+}
+
+bool TimerService::runBenchmark(uint32_t timerCount) {
+    if (!running || timerCount == 0 || timerCount > TIMER_BENCH_MAX) {
+        return false;
+    }
+
+    benchDue = new TickType_t[timerCount];
+    if (!benchDue) {
+        return false;
+    }
+
+    TimerBenchResult wheelResult;
+    TimerBenchResult rtosResult;
+    memset(&wheelResult, 0, sizeof(wheelResult));
+    memset(&rtosResult, 0, sizeof(rtosResult));
+
+    // Timing wheel: the caller owns the timer storage
+    uint32_t heapBefore = esp_get_free_heap_size();
+    SoftTimer* timers = new SoftTimer[timerCount];
+    if (!timers) {
+        delete[] benchDue;
+        benchDue = nullptr;
+        return false;
+    }
+    wheelResult.memory = heapBefore - esp_get_free_heap_size();
+
+    for (uint32_t i = 0; i < timerCount; i++) {
+        setup(&timers[i], benchWheelCallback, (void*)(uintptr_t)i);
+    }
+
+    benchReset();
+    uint32_t begin = ESP.getCycleCount();
+    for (uint32_t i = 0; i < timerCount; i++) {
+        benchDue[i] = xTaskGetTickCount() + pdMS_TO_TICKS(benchDelayMs(i));
+        start(&timers[i], benchDelayMs(i));
+    }
+    wheelResult.startCycles = ESP.getCycleCount() - begin;
+    wheelResult.complete = benchWait(timerCount);
+    wheelResult.maxLate = benchMaxLate.load();
+    wheelResult.totalLate = benchTotalLate.load();
+
+    for (uint32_t i = 0; i < timerCount; i++) {
+        start(&timers[i], 60000);
+    }
+    begin = ESP.getCycleCount();
+    for (uint32_t i = 0; i < timerCount; i++) {
+        cancel(&timers[i]);
+    }
+    wheelResult.cancelCycles = ESP.getCycleCount() - begin;
+    delete[] timers;
+
+    // FreeRTOS software timers: one heap object each, commands go through a queue
+    TimerHandle_t* handles = new TimerHandle_t[timerCount];
+    if (!handles) {
+        delete[] benchDue;
+        benchDue = nullptr;
+        return false;
+    }
+
+    heapBefore = esp_get_free_heap_size();
+    uint32_t created = 0;
+    for (; created < timerCount; created++) {
+        handles[created] = xTimerCreate("bench", pdMS_TO_TICKS(benchDelayMs(created)), pdFALSE,
+                                        (void*)(uintptr_t)created, benchRtosCallback);
+        if (!handles[created]) {
+            break;
+        }
+    }
+    rtosResult.memory = heapBefore - esp_get_free_heap_size();
+
+    if (created == timerCount) {
+        benchReset();
+        begin = ESP.getCycleCount();
+        for (uint32_t i = 0; i < timerCount; i++) {
+            benchDue[i] = xTaskGetTickCount() + pdMS_TO_TICKS(benchDelayMs(i));
+            xTimerStart(handles[i], portMAX_DELAY);
+        }
+        rtosResult.startCycles = ESP.getCycleCount() - begin;
+        rtosResult.complete = benchWait(timerCount);
+        rtosResult.maxLate = benchMaxLate.load();
+        rtosResult.totalLate = benchTotalLate.load();
+
+        for (uint32_t i = 0; i < timerCount; i++) {
+            xTimerChangePeriod(handles[i], pdMS_TO_TICKS(60000), portMAX_DELAY);
+        }
+        begin = ESP.getCycleCount();
+        for (uint32_t i = 0; i < timerCount; i++) {
+            xTimerStop(handles[i], portMAX_DELAY);
+        }
+        rtosResult.cancelCycles = ESP.getCycleCount() - begin;
+    } else {
+        Serial.printf("TimerService: Heap exhausted after %u FreeRTOS timers\n", created);
+    }
+
+    for (uint32_t i = 0; i < created; i++) {
+        xTimerDelete(handles[i], portMAX_DELAY);
+    }
+    delete[] handles;
+    delete[] benchDue;
+    benchDue = nullptr;
+
+    Serial.printf("Timer benchmark: %u one-shot timers, %u-%u ms deadlines\n",
+                  timerCount, TIMER_BENCH_MIN_DELAY_MS, TIMER_BENCH_MIN_DELAY_MS + 999);
+    Serial.println("Implementation    Start us  Cancel us  Max late  Avg late    Memory");
+    Serial.println("--------------------------------------------------------------------");
+    printBenchRow("Timing wheel", wheelResult, timerCount);
+    if (created == timerCount) {
+        printBenchRow("FreeRTOS timers", rtosResult, timerCount);
+    }
+    return true;
+}
@@ -0,0 +1,90 @@
+/*
+ * ESP32-OS Timer Wheel Header
+ * Kernel software timers on a hierarchical timing wheel
+ */
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include "../config/config.h"
+#include "metrics.h"
+
+#define TIMER_WHEEL_SLOTS (1UL << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+
+typedef void (*SoftTimerCallback_t)(void* arg);
+
+// Circular doubly linked list node; unlinking never needs to know the list
+struct TimerLink {
+    TimerLink* next;
+    TimerLink* prev;
+};
+
+// Owned by the caller and linked into the wheel, so arming a timer never
+// allocates. Initialize with TimerService::setup() before first use.
+struct SoftTimer {
+    TimerLink link;                 // Must stay first
+    uint32_t expires;               // Absolute wheel tick (esp_timer based)
+    uint32_t period;                // Ticks; 0 for one-shot
+    SoftTimerCallback_t callback;
+    void* arg;
+};
+
+class TimerService {
+private:
+    TimerLink wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    TimerLink expired;              // Batch waiting for its callbacks
+    uint32_t currentTick;
+    uint32_t activeCount;
+    portMUX_TYPE lock;
+    TaskHandle_t serviceTask;
+    volatile bool running;
+
+    // Statistics
+    uint32_t fired;
+    uint32_t cascaded;
+    uint32_t maxBatch;
+    uint32_t maxLateTicks;
+
+    void addLocked(SoftTimer* timer);
+    void cascadeLocked(int level, uint32_t index);
+    void advanceLocked();
+    uint32_t ticksUntilNextLocked();
+    void runExpired();
+
+    static void serviceLoop(void* parameter);
+
+public:
+    TimerService();
+    ~TimerService();
+
+    bool init();
+    void shutdown();
+    void registerMetrics(MetricsRegistry* registry);
+
+    static void setup(SoftTimer* timer, SoftTimerCallback_t callback, void* arg = nullptr);
+
+    // O(1) from task context. Restarting a pending timer re-arms it.
+    // Callbacks run on the service task and must not block for long.
+    bool start(SoftTimer* timer, uint32_t delayMs, uint32_t periodMs = 0);
+    bool cancel(SoftTimer* timer);
+    static bool isPending(const SoftTimer* timer) { return timer && timer->link.next != nullptr; }
+
+    // Upper bound on how long the CPU may sleep before the service must run;
+    // UINT32_MAX when no timer is armed
+    uint32_t msUntilNextEvent();
+    // Let the service catch up after the system has been asleep
+    void resync();
+
+    uint32_t getActiveCount() const { return activeCount; }
+    void printStatistics();
+
+    // Compare against FreeRTOS software timers with the given number of timers
+    bool runBenchmark(uint32_t timerCount);
+};
+
+#endif // TIMERWHEEL_H
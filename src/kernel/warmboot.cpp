@@ -0,0 +1,111 @@
+/*
+ * ESP32-OS Warm Boot Implementation
+ */
+
+#include "warmboot.h"
+#include "checksum.h"
+#include "../filesystem/fs.h"
+#include <esp_system.h>
+#include <esp_ota_ops.h>
+
+#define WARM_RECORD_MAGIC 0x5741524D // "WARM"
+#define WARM_RECORD_VERSION 2
+
+// Survives software resets only; any other reset reason boots cold
+static RTC_NOINIT_ATTR WarmRecord warmRecord;
+
+// The image's ELF hash changes whenever any part of the firmware does
+static uint32_t buildId() {
+    const esp_app_desc_t* app = esp_ota_get_app_description();
+    return fnv1a(app->app_elf_sha256, sizeof(app->app_elf_sha256));
+}
+
+static uint32_t recordChecksum(const WarmRecord& record) {
+    return fnv1a(&record, offsetof(WarmRecord, checksum));
+}
+
+WarmBoot::WarmBoot() : warm(false), recordLock(portMUX_INITIALIZER_UNLOCKED), fsDirty(false) {
+    memset(&restored, 0, sizeof(restored));
+}
+
+bool WarmBoot::isValid(const WarmRecord& record) {
+    return record.magic == WARM_RECORD_MAGIC &&
+           record.version == WARM_RECORD_VERSION &&
+           record.buildId == buildId() &&
+           record.volumeCount <= MOUNT_MAX_VOLUMES &&
+           record.counterCount <= WARM_MAX_COUNTERS &&
+           record.checksum == recordChecksum(record);
+}
+
+bool WarmBoot::pending() {
+    return esp_reset_reason() == ESP_RST_SW && isValid(warmRecord);
+}
+
+bool WarmBoot::init() {
+    const WarmRecord& record = warmRecord;
+    warm = esp_reset_reason() == ESP_RST_SW && isValid(record);
+
+    if (warm) {
+        restored = record;
+        Serial.printf("WarmBoot: Warm restart, reusing state saved at uptime %lu ms\n",
+                      (unsigned long)restored.savedAtMs);
+    }
+
+    warmRecord.magic = 0;
+    return true;
+}
+
+void WarmBoot::save(MountTable* mountTable, MetricsRegistry* metrics, FileSystem* fs) {
+    // Sampled first: a change after this point marks the file system dirty
+    uint32_t fsTotal = 0;
+    uint32_t fsUsed = 0;
+    bool fsClean = fs && fs->prepareWarmReboot(fsTotal, fsUsed);
+
+    WarmRecord& record = warmRecord;
+    record.magic = 0;
+    record.version = WARM_RECORD_VERSION;
+    record.buildId = buildId();
+    record.savedAtMs = millis();
+    record.warmBoots = warm ? restored.warmBoots + 1 : 1;
+    record.volumeCount = mountTable ? mountTable->saveState(record.volumes, MOUNT_MAX_VOLUMES) : 0;
+    record.counterCount = metrics ? metrics->saveCounters(record.counters, WARM_MAX_COUNTERS) : 0;
+    record.fsTotalBytes = fsTotal;
+    record.fsUsedBytes = fsUsed;
+
+    portENTER_CRITICAL(&recordLock);
+    record.fsClean = fsClean && !fsDirty;
+    record.magic = WARM_RECORD_MAGIC;
+    record.checksum = recordChecksum(record);
+    portEXIT_CRITICAL(&recordLock);
+}
+
+void WarmBoot::markFsDirty() {
+    portENTER_CRITICAL(&recordLock);
+    fsDirty = true;
+    WarmRecord& record = warmRecord;
+    if (record.magic == WARM_RECORD_MAGIC && record.fsClean) {
+        record.fsClean = 0;
+        record.checksum = recordChecksum(record);
+    }
+    portEXIT_CRITICAL(&recordLock);
+}
+
+void WarmBoot::printStatus() {
+    if (!warm) {
+        Serial.println("Last start:      cold");
+        return;
+    }
+
+    uint8_t absent = 0;
+    for (int i = 0; i < restored.volumeCount; i++) {
+        if (restored.volumes[i].state == VOLUME_ABSENT) {
+            absent++;
+        }
+    }
+
+    Serial.printf("Last start:      warm (%u in a row)\n", restored.warmBoots);
+    Serial.printf("Restored:        %u volume states (%u known absent), %u counters\n",
+                  restored.volumeCount, absent, restored.counterCount);
+    Serial.printf("File system:     %s\n", restored.fsClean ? "clean, recovery and usage query skipped"
+                                                              : "recovered as after a cold boot");
+}
@@ -0,0 +1,65 @@
+/*
+ * ESP32-OS Warm Boot Header
+ * Kernel state carried in RTC memory across a software restart
+ */
+
+#ifndef WARMBOOT_H
+#define WARMBOOT_H
+
+#include <Arduino.h>
+#include "../config/config.h"
+#include "mount.h"
+#include "metrics.h"
+
+class FileSystem;
+
+struct WarmRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t volumeCount;
+    uint8_t counterCount;
+    uint32_t buildId;           // State from another firmware is never reused
+    uint32_t savedAtMs;         // Uptime when the restart was requested
+    uint32_t warmBoots;         // Consecutive warm restarts
+
+    // Nothing was mid-replace: the file system skips recovery and takes
+    // its usage from here instead of querying the backend
+    uint8_t fsClean;
+    uint32_t fsTotalBytes;
+    uint32_t fsUsedBytes;
+
+    VolumeSnapshot volumes[MOUNT_MAX_VOLUMES];
+    MetricBaseline counters[WARM_MAX_COUNTERS];
+
+    uint32_t checksum;
+};
+
+class WarmBoot {
+private:
+    WarmRecord restored;        // Consumed from RTC memory at init
+    bool warm;
+    portMUX_TYPE recordLock;    // Saving races file system writers on the other core
+    bool fsDirty;
+
+    static bool isValid(const WarmRecord& record);
+
+public:
+    WarmBoot();
+
+    // Loads and invalidates the RTC record, so a later crash boots cold
+    bool init();
+
+    // Whether init() will find a usable record; callable before it
+    static bool pending();
+
+    bool isWarm() const { return warm; }
+    const WarmRecord& getRecord() const { return restored; }
+
+    // Called right before ESP.restart(); fs may be null if it never started
+    void save(MountTable* mountTable, MetricsRegistry* metrics, FileSystem* fs);
+    // The file system changed after save(); it must recover on the way up
+    void markFsDirty();
+    void printStatus();
+};
+
+#endif // WARMBOOT_H
@@ -0,0 +1,285 @@
+/*
+ * ESP32-OS Deferred Work Queue Implementation
+ */
+
+#include "workqueue.h"
+#include <esp_timer.h>
+
+static_assert((WORKQUEUE_DEPTH & (WORKQUEUE_DEPTH - 1)) == 0,
+              "WORKQUEUE_DEPTH must be a power of two");
+
+static const char* priorityNames[WORK_PRIO_COUNT] = {"high", "normal", "low"};
+
+struct WorkerContext {
+    WorkQueue* queue;
+    int core;
+};
+static WorkerContext workerContexts[portNUM_PROCESSORS];
+
+WorkQueue::WorkQueue() : running(false) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        workers[core] = nullptr;
+        for (int prio = 0; prio < WORK_PRIO_COUNT; prio++) {
+            WorkRing& ring = rings[core][prio];
+            for (uint32_t i = 0; i < WORKQUEUE_DEPTH; i++) {
+                ring.cells[i].sequence.store(i, std::memory_order_relaxed);
+                ring.cells[i].item.function = nullptr;
+                ring.cells[i].item.arg = nullptr;
+            }
+            ring.enqueuePos.store(0, std::memory_order_relaxed);
+            ring.dequeuePos.store(0, std::memory_order_relaxed);
+        }
+    }
+    resetStatistics();
+}
+
+WorkQueue::~WorkQueue() {
+    shutdown();
+}
+
+bool WorkQueue::init() {
+    if (running) {
+        return true;
+    }
+
+    running = true;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        char name[16];
+        snprintf(name, sizeof(name), "kworker/%d", core);
+        workerContexts[core].queue = this;
+        workerContexts[core].core = core;
+
+        if (xTaskCreatePinnedToCore(workerTask, name, WORKQUEUE_WORKER_STACK_SIZE,
+                                    &workerContexts[core], WORKQUEUE_WORKER_PRIORITY,
+                                    &workers[core], core) != pdPASS) {
+            Serial.println("WorkQueue: Failed to create worker task");
+            shutdown();
+            return false;
+        }
+    }
+
+    Serial.println("WorkQueue: Deferred work queues initialized");
+    return true;
+}
+
+void WorkQueue::shutdown() {
+    running = false;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (workers[core]) {
+            vTaskDelete(workers[core]);
+            workers[core] = nullptr;
+        }
+    }
+}
+
+bool IRAM_ATTR WorkQueue::enqueue(WorkRing& ring, WorkFunction_t function, void* arg) {
+    uint32_t pos = ring.enqueuePos.load(std::memory_order_relaxed);
+    WorkCell* cell;
+
+    for (;;) {
+        cell = &ring.cells[pos & (WORKQUEUE_DEPTH - 1)];
+        uint32_t seq = cell->sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (ring.enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false; // Full
+        } else {
+            pos = ring.enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->item.function = function;
+    cell->item.arg = arg;
+    cell->item.postUs = (uint32_t)esp_timer_get_time();
+    cell->sequence.store(pos + 1, std::memory_order_release);
+
+    ring.posted.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool WorkQueue::dequeue(WorkRing& ring, WorkItem& item) {
+    uint32_t pos = ring.dequeuePos.load(std::memory_order_relaxed);
+    WorkCell* cell = &ring.cells[pos & (WORKQUEUE_DEPTH - 1)];
+    uint32_t seq = cell->sequence.load(std::memory_order_acquire);
+
+    if ((int32_t)(seq - (pos + 1)) < 0) {
+        return false; // Empty, or producer still filling the cell
+    }
+
+    item = cell->item;
+    ring.dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    cell->sequence.store(pos + WORKQUEUE_DEPTH, std::memory_order_release);
+    return true;
+}
+
+bool IRAM_ATTR WorkQueue::postFromISR(WorkFunction_t function, void* arg,
+                                      WorkPriority priority, BaseType_t* higherPriorityTaskWoken) {
+    if (!function || priority >= WORK_PRIO_COUNT || !running) {
+        return false;
+    }
+
+    int core = xPortGetCoreID();
+    if (!enqueue(rings[core][priority], function, arg)) {
+        return false;
+    }
+
+    vTaskNotifyGiveFromISR(workers[core], higherPriorityTaskWoken);
+    return true;
+}
+
+bool WorkQueue::post(WorkFunction_t function, void* arg, WorkPriority priority) {
+    if (!function || priority >= WORK_PRIO_COUNT || !running) {
+        return false;
+    }
+
+    int core = xPortGetCoreID();
+    if (!enqueue(rings[core][priority], function, arg)) {
+        return false;
+    }
+
+    xTaskNotifyGive(workers[core]);
+    return true;
+}
+
+void WorkQueue::runItem(WorkRing& ring, const WorkItem& item) {
+    uint32_t latencyNs = ((uint32_t)esp_timer_get_time() - item.postUs) * 1000;
+
+    ring.totalLatencyNs += latencyNs;
+    if (latencyNs > ring.maxLatencyNs) {
+        ring.maxLatencyNs = latencyNs;
+    }
+
+    item.function(item.arg);
+    ring.executed++;
+}
+
+void WorkQueue::workerTask(void* parameter) {
+    WorkerContext* context = (WorkerContext*)parameter;
+    WorkQueue* self = context->queue;
+    WorkRing* coreRings = self->rings[context->core];
+
+    // Runs until deleted by shutdown()
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Always drain the highest non-empty priority first, rechecking
+        // after every item so urgent work waits for at most one item
+        bool didWork = true;
+        while (didWork) {
+            didWork = false;
+            for (int prio = 0; prio < WORK_PRIO_COUNT; prio++) {
+                WorkRing& ring = coreRings[prio];
+
+                uint32_t depth = ring.enqueuePos.load(std::memory_order_relaxed) -
+                                 ring.dequeuePos.load(std::memory_order_relaxed);
+                if (depth > ring.maxDepth) {
+                    ring.maxDepth = depth;
+                }
+
+                WorkItem item;
+                if (self->dequeue(ring, item)) {
+                    self->runItem(ring, item);
+                    didWork = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+uint32_t WorkQueue::getDepth(int core, WorkPriority priority) {
+    if (core < 0 || core >= portNUM_PROCESSORS || priority >= WORK_PRIO_COUNT) {
+        return 0;
+    }
+
+    WorkRing& ring = rings[core][priority];
+    return ring.enqueuePos.load(std::memory_order_relaxed) -
+           ring.dequeuePos.load(std::memory_order_relaxed);
+}
+
+uint32_t WorkQueue::getTotalDepth() {
+    uint32_t total = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        for (int prio = 0; prio < WORK_PRIO_COUNT; prio++) {
+            total += getDepth(core, (WorkPriority)prio);
+        }
+    }
+    return total;
+}
+
+uint32_t WorkQueue::getTotalPosted() {
+    uint32_t total = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        for (int prio = 0; prio < WORK_PRIO_COUNT; prio++) {
+            total += rings[core][prio].posted.load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+uint32_t WorkQueue::getTotalDropped() {
+    uint32_t total = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        for (int prio = 0; prio < WORK_PRIO_COUNT; prio++) {
+            total += rings[core][prio].dropped.load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+static uint32_t sampleDepth(void* context) { return ((WorkQueue*)context)->getTotalDepth(); }
+static uint32_t samplePosted(void* context) { return ((WorkQueue*)context)->getTotalPosted(); }
+static uint32_t sampleDropped(void* context) { return ((WorkQueue*)context)->getTotalDropped(); }
+
+void WorkQueue::registerMetrics(MetricsRegistry* registry) {
+    if (!registry) {
+        return;
+    }
+
+    registry->registerGauge("wq_depth", sampleDepth, this);
+    registry->registerCounter("wq_posted_total", samplePosted, this);
+    registry->registerCounter("wq_dropped_total", sampleDropped, this);
+}
+
+void WorkQueue::printStatistics() {
+    Serial.println("Deferred Work Queues:");
+    Serial.println("Core Priority  Depth  MaxDepth    Posted  Executed  Dropped  Avg(us)  Max(us)");
+    Serial.println("------------------------------------------------------------------------------");
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        for (int prio = 0; prio < WORK_PRIO_COUNT; prio++) {
+            WorkRing& ring = rings[core][prio];
+            double avgUs = ring.executed > 0 ?
+                           ring.totalLatencyNs / (double)ring.executed / 1000.0 : 0.0;
+
+            Serial.printf("%4d %-8s %6u %9u %9u %9u %8u %8.2f %8.2f\n",
+                          core,
+                          priorityNames[prio],
+                          getDepth(core, (WorkPriority)prio),
+                          ring.maxDepth,
+                          ring.posted.load(std::memory_order_relaxed),
+                          ring.executed,
+                          ring.dropped.load(std::memory_order_relaxed),
+                          avgUs,
+                          ring.maxLatencyNs / 1000.0);
+        }
+    }
+}
+
+void WorkQueue::resetStatistics() {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        for (int prio = 0; prio < WORK_PRIO_COUNT; prio++) {
+            WorkRing& ring = rings[core][prio];
+            ring.posted.store(0, std::memory_order_relaxed);
+            ring.dropped.store(0, std::memory_order_relaxed);
+            ring.executed = 0;
+            ring.maxDepth = 0;
+            ring.totalLatencyNs = 0;
+            ring.maxLatencyNs = 0;
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/*
+ * ESP32-OS Deferred Work Queue Header
+ * Lock-free bottom-half queues for handing ISR work to task context
+ */
+
+#ifndef WORKQUEUE_H
+#define WORKQUEUE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include "../config/config.h"
+#include "metrics.h"
+
+enum WorkPriority {
+    WORK_PRIO_HIGH = 0,
+    WORK_PRIO_NORMAL,
+    WORK_PRIO_LOW,
+    WORK_PRIO_COUNT
+};
+
+typedef void (*WorkFunction_t)(void* arg);
+
+struct WorkItem {
+    WorkFunction_t function;
+    void* arg;
+    uint32_t postUs;        // esp_timer when posted; CCOUNT would follow the governor's clock
+};
+
+struct WorkCell {
+    std::atomic<uint32_t> sequence;
+    WorkItem item;
+};
+
+// Bounded multi-producer ring (Vyukov); each ring has a single consumer,
+// the worker task of its core
+struct WorkRing {
+    WorkCell cells[WORKQUEUE_DEPTH];
+    std::atomic<uint32_t> enqueuePos;
+    std::atomic<uint32_t> dequeuePos;
+
+    // Statistics
+    std::atomic<uint32_t> posted;
+    std::atomic<uint32_t> dropped;
+    uint32_t executed;
+    uint32_t maxDepth;
+    uint64_t totalLatencyNs;
+    uint32_t maxLatencyNs;
+};
+
+class WorkQueue {
+private:
+    WorkRing rings[portNUM_PROCESSORS][WORK_PRIO_COUNT];
+    TaskHandle_t workers[portNUM_PROCESSORS];
+    volatile bool running;
+
+    bool IRAM_ATTR enqueue(WorkRing& ring, WorkFunction_t function, void* arg);
+    bool dequeue(WorkRing& ring, WorkItem& item);
+    void runItem(WorkRing& ring, const WorkItem& item);
+
+    static void workerTask(void* parameter);
+
+public:
+    WorkQueue();
+    ~WorkQueue();
+
+    bool init();
+    void shutdown();
+    void registerMetrics(MetricsRegistry* registry);
+
+    // Queue work on the calling core. Returns false if the queue is full.
+    bool IRAM_ATTR postFromISR(WorkFunction_t function, void* arg,
+                               WorkPriority priority, BaseType_t* higherPriorityTaskWoken);
+    bool post(WorkFunction_t function, void* arg, WorkPriority priority = WORK_PRIO_NORMAL);
+
+    // Statistics
+    uint32_t getDepth(int core, WorkPriority priority);
+    uint32_t getTotalDepth();
+    uint32_t getTotalPosted();
+    uint32_t getTotalDropped();
+    void printStatistics();
+    void resetStatistics();
+};
+
+#endif // WORKQUEUE_H
@@ -11,69 +11,88 @@
 #include "shell/shell.h"
 #include "hal/hal.h"
 #include "filesystem/fs.h"
+#include "filesystem/assets.h"
+#include "filesystem/asyncio.h"
 #include "config/config.h"
-#define FORMAT_SPIFFS_IF_FAILED true
+#include "kernel/boot.h"
 // Global system objects
 Kernel* kernel;
-Shell* shell;
-HAL* hal;
-FileSystem* fs_;
+BootSequencer* bootSequencer;
+static HAL* hal;
+
+// Boot stages - run by the boot sequencer in dependency order
+static bool bootHAL(void* arg) {
+    hal = new HAL();
+    return hal->init();
+}
+
+static bool bootKernel(void* arg) {
+    kernel = new Kernel();
+    return kernel->init();
+}
+
+static bool bootServices(void* arg) {
+    // Subsystems outside the kernel are created on first use unless essential
+    ServiceRegistry* services = kernel->getServices();
+    services->registerInstance("hal", hal);
+    services->registerInstance("boot", bootSequencer);
+    int fsId = services->registerService<FileSystem>("fs", SERVICE_NO_DEPS,
+                                                     SERVICE_FS_ESSENTIAL ? SERVICE_ESSENTIAL : 0);
+    services->registerService<AsyncIO>("fsio", SERVICE_DEP(fsId));
+    services->registerService<AssetStore>("assets");
+    services->registerService<Shell>("shell", SERVICE_NO_DEPS,
+                                     SERVICE_SHELL_ESSENTIAL ? SERVICE_ESSENTIAL : 0);
+    if (!services->startEssential()) {
+        return false;
+    }
+    
+    // Tuned stack sizes are read from the file system, so it has to be up
+    // before setup() creates the first tuned task
+    if (STACK_TUNE_APPLY && services->get<FileSystem>("fs")) {
+        kernel->getStackTuner()->load();
+    }
+    return true;
+}
 
 void setup() {
     // Initialize serial communication for shell interface
     Serial.begin(SERIAL_BAUD_RATE);
-    delay(1000); // Allow serial to stabilize
+    if (!WarmBoot::pending()) {
+        delay(BOOT_SERIAL_SETTLE_MS); // Allow serial to stabilize; a warm restart keeps its monitor
+    }
     
     // Print boot banner
-     Serial.println("========================================");
+    Serial.println("========================================");
     Serial.println("ESP32-OS v1.0 - Custom Operating System");
     Serial.println("========================================");
     Serial.println("Initializing system components...");
     
-    // Initialize Hardware Abstraction Layer first
-    hal = new HAL();
-    if (!hal->init()) {
-        Serial.println("FATAL: HAL initialization failed");
+    // Declare init stages; independent stages run concurrently on both cores.
+    // HAL runs on this task since it registers it with the watchdog.
+    bootSequencer = new BootSequencer();
+    int halStage = bootSequencer->addStage("hal", bootHAL, NULL, BOOT_NO_DEPS,
+                                           BOOT_STAGE_CRITICAL | BOOT_STAGE_INLINE);
+    int kernelStage = bootSequencer->addStage("kernel", bootKernel, NULL, BOOT_NO_DEPS,
+                                              BOOT_STAGE_CRITICAL);
+    bootSequencer->addStage("services", bootServices, NULL,
+                            BOOT_DEP(halStage) | BOOT_DEP(kernelStage), BOOT_STAGE_CRITICAL);
+    
+    if (!bootSequencer->run()) {
+        Serial.printf("FATAL: Boot stage '%s' failed\n", bootSequencer->getFailedStage());
         while(1) delay(1000); // Halt system
     }
-    Serial.println("[OK] Hardware Abstraction Layer initialized");
-    
-    // Initialize File System
     
+    // Start the shell task; it keeps running while the system is quiesced
+    kernel->createTask("shell_task", shellTask, 4096, NULL, 1, true);
     
-    // Initialize Kernel (task scheduler and memory management)
-    kernel = new Kernel();
-    if (!kernel->init()) {
-        Serial.println("FATAL: Kernel initialization failed");
-        while(1) delay(1000); // Halt system
-    }
-    Serial.println("[OK] Kernel initialized");
-    fs_ = new FileSystem();
-    if (!fs_->init()) {
-        Serial.println("WARNING: File System initialization failed");
-        // Continue without filesystem - non-critical
-    } else {
-        Serial.println("[OK] File System initialized");
-    }
-    // Initialize Shell interface
-    shell = new Shell();
-    if (!shell->init()) {
-        Serial.println("FATAL: Shell initialization failed");
-        while(1) delay(1000); // Halt system
-    }
-    Serial.println("[OK] Shell initialized");
+    bootSequencer->markReady(kernel->getWarmBoot() && kernel->getWarmBoot()->isWarm());
     
     // System initialization complete
     Serial.println("========================================");
     Serial.println("System boot complete!");
+    bootSequencer->printTimings();
     Serial.println("Type 'help' for available commands");
     Serial.println("========================================");
-    
-    // Start the shell task
-    kernel->createTask("shell_task", shellTask, 4096, NULL, 1);
-    
-    // Start system monitoring task
-    kernel->createTask("monitor_task", monitorTask, 2048, NULL, 0);
 }
 
 void loop() {
@@ -84,29 +103,29 @@ void loop() {
     // Check for system critical errors
     if (kernel && !kernel->isHealthy()) {
         Serial.println("CRITICAL: Kernel health check failed - rebooting...");
-        delay(1000);
-        ESP.restart();
+        kernel->warmReboot(POSTMORTEM_UNHEALTHY);
     }
 }
 
 // Shell task function - runs the command interface
 void shellTask(void* parameter) {
+    ServiceRegistry* services = kernel->getServices();
+    Shell* shell = nullptr;
+    
     while (true) {
+        if (Serial.available()) {
+            PowerManager::notifyActivity(); // Hold off light sleep while typing
+        }
+        if (!shell) {
+            // Started at boot if essential, otherwise by the first keystroke
+            shell = services->find<Shell>("shell");
+            if (!shell && Serial.available()) {
+                shell = services->get<Shell>("shell");
+            }
+        }
         if (shell) {
             shell->processInput();
         }
         vTaskDelay(10 / portTICK_PERIOD_MS); // Small delay to prevent watchdog issues
     }
 }
-
-// System monitoring task - monitors system health and resources
-void monitorTask(void* parameter) {
-    while (true) {
-        if (kernel) {
-            kernel->updateSystemStats();
-        }
-        
-        // Monitor every 5 seconds
-        vTaskDelay(5000 / portTICK_PERIOD_MS);
-    }
-}
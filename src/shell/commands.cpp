@@ -6,12 +6,19 @@
 #include "../kernel/kernel.h"
 #include "../hal/hal.h"
 #include "../filesystem/fs.h"
+#include "../filesystem/appendlog.h"
+#include "../filesystem/assets.h"
+#include "../filesystem/asyncio.h"
+#include "../kernel/boot.h"
 #include <WiFi.h>
 
 // External references
-extern Kernel* kernel;
-extern HAL* hal;
-extern FileSystem* fs_;
+// Subsystems outside the kernel come from the service registry
+template<typename T>
+static T* service(const char* name) {
+    ServiceRegistry* services = kernel ? kernel->getServices() : nullptr;
+    return services ? services->get<T>(name) : nullptr;
+}
 
 // Command table
 const Command Commands::commandList[] = {
@@ -28,7 +35,28 @@ const Command Commands::commandList[] = {
     {"echo", "Echo text to output", cmd_echo},
     {"sleep", "Sleep for specified seconds", cmd_sleep},
     {"led", "Control built-in LED", cmd_led},
-    {"wifi", "WiFi management commands", cmd_wifi}
+    {"wifi", "WiFi management commands", cmd_wifi},
+    {"lat", "Interrupt latency histograms and self-test", cmd_lat},
+    {"wq", "Show deferred work queue statistics", cmd_wq},
+    {"boot", "Show boot stage timings", cmd_boot},
+    {"mount", "Show mount table or mount a volume", cmd_mount},
+    {"umount", "Unmount a volume", cmd_umount},
+    {"events", "Show event bus topic counters", cmd_events},
+    {"metrics", "Export metrics as text, json or bin", cmd_metrics},
+    {"postmortem", "Show or clear the previous boot's crash record", cmd_postmortem},
+    {"timers", "Kernel timer statistics and benchmark", cmd_timers},
+    {"prof", "Sampling profiler control and dump", cmd_prof},
+    {"services", "Show subsystem services and their state", cmd_services},
+    {"power", "Low power mode and power state residency", cmd_power},
+    {"cpufreq", "CPU frequency governor control and residency", cmd_cpufreq},
+    {"stacks", "Task stack peaks and recommended sizes", cmd_stacks},
+    {"df", "File system usage and block cache statistics", cmd_df},
+    {"fsbench", "Compare SPIFFS and LittleFS on the scratch partition", cmd_fsbench},
+    {"cat", "Print a file of any size", cmd_cat},
+    {"logbench", "Compare appendFile with a buffered append log", cmd_logbench},
+    {"assets", "List or print assets mapped from flash", cmd_assets},
+    {"fsio", "Async file I/O queue statistics and benchmark", cmd_fsio},
+    {"compress", "Show or set per-directory file compression", cmd_compress}
 };
 
 const int Commands::commandCount = sizeof(commandList) / sizeof(Command);
@@ -57,6 +85,7 @@ bool Commands::execute(const char* cmd, char args[][32], int argCount) {
     // Find and execute command
     for (int i = 0; i < commandCount; i++) {
         if (strcasecmp(cmd, commandList[i].name) == 0) {
+            Postmortem::trace(TRACE_COMMAND, argCount, commandList[i].name);
             commandList[i].handler(args, argCount);
             return true;
         }
@@ -127,8 +156,9 @@ void Commands::cmd_help(char args[][32], int argCount) {
 }
 
 void Commands::cmd_ls(char args[][32], int argCount) {
-    if (fs_) {
-        fs_->listFiles();
+    FileSystem* fs = service<FileSystem>("fs");
+    if (fs) {
+        fs->listFiles();
     } else {
         Serial.println("File system not available");
     }
@@ -164,9 +194,16 @@ void Commands::cmd_free(char args[][32], int argCount) {
 }
 
 void Commands::cmd_reboot(char args[][32], int argCount) {
+    bool warm = argCount > 0 && strcasecmp(args[0], "warm") == 0;
+    if (argCount > 0 && !warm) {
+        printUsage("reboot", "reboot [warm]");
+        return;
+    }
+    
     Serial.println("Rebooting system...");
-    delay(1000);
-    if (kernel) {
+    if (kernel && warm) {
+        kernel->warmReboot();
+    } else if (kernel) {
         kernel->reboot();
     } else {
         ESP.restart();
@@ -188,10 +225,20 @@ void Commands::cmd_info(char args[][32], int argCount) {
     Serial.printf("Flash Speed:     %d Hz\n", ESP.getFlashChipSpeed());
     
     if (kernel) {
-        char uptimeStr[32];
-        formatTime(kernel->getUptime(), uptimeStr, sizeof(uptimeStr));
+        // One consistent snapshot, as last published by the monitor task
+        SystemStats stats;
+        kernel->getStats(stats);
+        
+        char uptimeStr[32], freeStr[32], minFreeStr[32];
+        formatTime(stats.uptime, uptimeStr, sizeof(uptimeStr));
+        formatBytes(stats.freeMem, freeStr, sizeof(freeStr));
+        formatBytes(stats.minFreeMem, minFreeStr, sizeof(minFreeStr));
         Serial.printf("Uptime:          %s\n", uptimeStr);
-        Serial.printf("Total Tasks:     %d\n", kernel->getTotalTasks());
+        Serial.printf("Total Tasks:     %d\n", stats.totalTasks);
+        Serial.printf("Free Memory:     %s\n", freeStr);
+        Serial.printf("Min Free Memory: %s\n", minFreeStr);
+        Serial.printf("Health:          %s\n", stats.healthy ? "OK" : "DEGRADED");
+        Serial.printf("Stats Age:       %lu ms\n", millis() - stats.sampleTime);
     }
 }
 
@@ -260,6 +307,7 @@ void Commands::cmd_led(char args[][32], int argCount) {
         return;
     }
     
+    HAL* hal = service<HAL>("hal");
     if (hal) {
         if (strcasecmp(args[0], "on") == 0) {
             hal->setLED(true);
@@ -315,6 +363,471 @@ void Commands::cmd_wifi(char args[][32], int argCount) {
     }
 }
 
+void Commands::cmd_lat(char args[][32], int argCount) {
+    if (!kernel || !kernel->getLatencyTracker()) {
+        Serial.println("Latency tracker not available");
+        return;
+    }
+    
+    LatencyTracker* tracker = kernel->getLatencyTracker();
+    
+    if (argCount < 1 || strcasecmp(args[0], "show") == 0) {
+        tracker->printStatistics();
+    } else if (strcasecmp(args[0], "reset") == 0) {
+        tracker->reset();
+        Serial.println("Latency histograms cleared");
+    } else if (strcasecmp(args[0], "test") == 0) {
+        int rate = 1000;
+        int seconds = 5;
+        bool withLoad = false;
+        
+        if (argCount > 1 && (!parseInteger(args[1], &rate) || rate <= 0)) {
+            Serial.println("Invalid rate");
+            return;
+        }
+        if (argCount > 2 && (!parseInteger(args[2], &seconds) || seconds <= 0)) {
+            Serial.println("Invalid duration");
+            return;
+        }
+        if (argCount > 3 && strcasecmp(args[3], "load") == 0) {
+            withLoad = true;
+        }
+        
+        Serial.printf("Running latency self-test: %d Hz for %d seconds%s...\n",
+                     rate, seconds, withLoad ? " under load" : "");
+        PerfLock perf(kernel->getGovernor()); // Cycle counts need a steady clock
+        if (!tracker->runSelfTest(rate, seconds * 1000, withLoad)) {
+            Serial.println("Self-test failed to start");
+            return;
+        }
+        tracker->printStatistics();
+    } else {
+        printUsage("lat", "lat [show|reset|test [hz] [seconds] [load]]");
+    }
+}
+
+void Commands::cmd_wq(char args[][32], int argCount) {
+    if (!kernel || !kernel->getWorkQueue()) {
+        Serial.println("Work queue not available");
+        return;
+    }
+    
+    if (argCount > 0 && strcasecmp(args[0], "reset") == 0) {
+        kernel->getWorkQueue()->resetStatistics();
+        Serial.println("Work queue statistics cleared");
+    } else {
+        kernel->getWorkQueue()->printStatistics();
+    }
+}
+
+void Commands::cmd_boot(char args[][32], int argCount) {
+    BootSequencer* bootSequencer = service<BootSequencer>("boot");
+    if (kernel && kernel->getWarmBoot()) {
+        kernel->getWarmBoot()->printStatus();
+    }
+    if (bootSequencer) {
+        bootSequencer->printTimings();
+    } else {
+        Serial.println("Boot timings not available");
+    }
+}
+
+void Commands::cmd_mount(char args[][32], int argCount) {
+    if (!kernel || !kernel->getMountTable()) {
+        Serial.println("Mount table not available");
+        return;
+    }
+    
+    MountTable* mounts = kernel->getMountTable();
+    if (argCount < 1) {
+        mounts->printTable();
+        return;
+    }
+    
+    // Explicit mounts always re-probe, e.g. after inserting a card
+    if (mounts->mount(args[0], true)) {
+        Serial.printf("Volume '%s' mounted\n", args[0]);
+    } else {
+        Serial.printf("Failed to mount '%s'\n", args[0]);
+    }
+}
+
+void Commands::cmd_umount(char args[][32], int argCount) {
+    if (argCount < 1) {
+        printUsage("umount", "umount <volume>");
+        return;
+    }
+    
+    if (!kernel || !kernel->getMountTable()) {
+        Serial.println("Mount table not available");
+        return;
+    }
+    
+    // Only refuse if the file system is up; never start it just to check
+    if (strcmp(args[0], FS_VOLUME) == 0 && kernel->getServices()->peek("fs")) {
+        Serial.println("Volume '" FS_VOLUME "' is in use by the file system");
+        return;
+    }
+    
+    if (kernel->getMountTable()->unmount(args[0])) {
+        Serial.printf("Volume '%s' unmounted\n", args[0]);
+    } else {
+        Serial.printf("Volume '%s' is not mounted\n", args[0]);
+    }
+}
+
+void Commands::cmd_events(char args[][32], int argCount) {
+    if (kernel && kernel->getEventBus()) {
+        kernel->getEventBus()->printStatistics();
+    } else {
+        Serial.println("Event bus not available");
+    }
+}
+
+void Commands::cmd_metrics(char args[][32], int argCount) {
+    if (!kernel || !kernel->getMetrics()) {
+        Serial.println("Metrics registry not available");
+        return;
+    }
+    
+    MetricsRegistry* metrics = kernel->getMetrics();
+    const char* format = argCount > 0 ? args[0] : "text";
+    
+    if (strcasecmp(format, "text") == 0) {
+        metrics->exportText(Serial);
+    } else if (strcasecmp(format, "json") == 0) {
+        metrics->exportJson(Serial);
+    } else if (strcasecmp(format, "bin") == 0) {
+        // Hex-encoded on one line so it survives the serial console
+        static uint8_t buffer[METRICS_BINARY_MAX_SIZE];
+        size_t len = metrics->exportBinary(buffer, sizeof(buffer));
+        if (len == 0) {
+            Serial.println("Metrics snapshot does not fit the export buffer");
+            return;
+        }
+        Serial.print("MTRC ");
+        for (size_t i = 0; i < len; i++) {
+            Serial.printf("%02X", buffer[i]);
+        }
+        Serial.println();
+    } else {
+        printUsage("metrics", "metrics [text|json|bin]");
+    }
+}
+
+void Commands::cmd_postmortem(char args[][32], int argCount) {
+    if (!kernel || !kernel->getPostmortem()) {
+        Serial.println("Postmortem store not available");
+        return;
+    }
+    
+    Postmortem* postmortem = kernel->getPostmortem();
+    if (argCount > 0 && strcasecmp(args[0], "clear") == 0) {
+        postmortem->clearPrevious();
+        Serial.println("Postmortem record cleared");
+    } else if (argCount > 0) {
+        printUsage("postmortem", "postmortem [clear]");
+    } else {
+        postmortem->printPrevious();
+    }
+}
+
+void Commands::cmd_timers(char args[][32], int argCount) {
+    if (!kernel || !kernel->getTimerService()) {
+        Serial.println("Timer service not available");
+        return;
+    }
+    
+    TimerService* timers = kernel->getTimerService();
+    
+    if (argCount < 1 || strcasecmp(args[0], "show") == 0) {
+        timers->printStatistics();
+    } else if (strcasecmp(args[0], "bench") == 0) {
+        int count = 1000;
+        if (argCount > 1 && (!parseInteger(args[1], &count) || count <= 0 || count > TIMER_BENCH_MAX)) {
+            Serial.printf("Invalid timer count (1-%d)\n", TIMER_BENCH_MAX);
+            return;
+        }
+        
+        Serial.printf("Benchmarking %d timers...\n", count);
+        PerfLock perf(kernel->getGovernor()); // Cycle counts need a steady clock
+        if (!timers->runBenchmark(count)) {
+            Serial.println("Benchmark failed: out of memory");
+        }
+    } else {
+        printUsage("timers", "timers [show|bench [count]]");
+    }
+}
+
+void Commands::cmd_prof(char args[][32], int argCount) {
+    if (!kernel || !kernel->getProfiler()) {
+        Serial.println("Profiler not available");
+        return;
+    }
+    
+    Profiler* profiler = kernel->getProfiler();
+    
+    if (argCount < 1) {
+        profiler->printSummary();
+    } else if (strcasecmp(args[0], "start") == 0) {
+        int rate = PROFILER_DEFAULT_HZ;
+        if (argCount > 1 && (!parseInteger(args[1], &rate) || rate <= 0 || rate > PROFILER_MAX_HZ)) {
+            Serial.printf("Invalid rate (1-%d Hz)\n", PROFILER_MAX_HZ);
+            return;
+        }
+        
+        if (profiler->start(rate)) {
+            Serial.printf("Profiling at %d Hz per core; 'prof stop' to finish\n", rate);
+        } else {
+            Serial.println("Failed to start profiler");
+        }
+    } else if (strcasecmp(args[0], "stop") == 0) {
+        profiler->stop();
+        profiler->printSummary();
+    } else if (strcasecmp(args[0], "dump") == 0) {
+        bool hist = argCount > 1 && strcasecmp(args[1], "hist") == 0;
+        profiler->dump(hist ? PROFILE_HISTOGRAM : PROFILE_FOLDED);
+    } else {
+        printUsage("prof", "prof [start [hz]|stop|dump [folded|hist]]");
+    }
+}
+
+void Commands::cmd_services(char args[][32], int argCount) {
+    if (kernel && kernel->getServices()) {
+        kernel->getServices()->printServices();
+    } else {
+        Serial.println("Service registry not available");
+    }
+}
+
+void Commands::cmd_power(char args[][32], int argCount) {
+    if (!kernel || !kernel->getPowerManager()) {
+        Serial.println("Power manager not available");
+        return;
+    }
+    
+    PowerManager* power = kernel->getPowerManager();
+    
+    if (argCount < 1 || strcasecmp(args[0], "stats") == 0) {
+        power->printStatistics();
+    } else if (strcasecmp(args[0], "low") == 0) {
+        if (kernel->enterLowPowerMode()) {
+            Serial.printf("Console wakes the system; idle after %d ms\n", POWER_IDLE_HOLDOFF_MS);
+        } else {
+            Serial.println("Failed to enter low power mode");
+        }
+    } else if (strcasecmp(args[0], "normal") == 0) {
+        kernel->exitLowPowerMode();
+    } else if (strcasecmp(args[0], "reset") == 0) {
+        power->resetStatistics();
+        Serial.println("Power statistics reset");
+    } else {
+        printUsage("power", "power [stats|low|normal|reset]");
+    }
+}
+
+void Commands::cmd_cpufreq(char args[][32], int argCount) {
+    if (!kernel || !kernel->getGovernor()) {
+        Serial.println("CPU frequency governor not available");
+        return;
+    }
+    
+    Governor* governor = kernel->getGovernor();
+    
+    if (argCount < 1 || strcasecmp(args[0], "stats") == 0) {
+        governor->printStatistics();
+    } else if (strcasecmp(args[0], "auto") == 0) {
+        governor->setAuto();
+        Serial.println("CPU frequency follows load");
+    } else if (strcasecmp(args[0], "fix") == 0 && argCount > 1) {
+        int mhz = 0;
+        if (!parseInteger(args[1], &mhz) || !governor->setFixed(mhz)) {
+            Serial.println("Invalid frequency (80, 160 or 240 MHz)");
+            return;
+        }
+        Serial.printf("CPU frequency fixed at %d MHz\n", mhz);
+    } else if (strcasecmp(args[0], "reset") == 0) {
+        governor->resetStatistics();
+        Serial.println("Governor statistics reset");
+    } else {
+        printUsage("cpufreq", "cpufreq [stats|auto|fix <mhz>|reset]");
+    }
+}
+
+void Commands::cmd_stacks(char args[][32], int argCount) {
+    if (!kernel || !kernel->getStackTuner()) {
+        Serial.println("Stack tuner not available");
+        return;
+    }
+    
+    StackTuner* tuner = kernel->getStackTuner();
+    
+    if (argCount < 1) {
+        tuner->printReport(kernel->getScheduler());
+    } else if (strcasecmp(args[0], "save") == 0) {
+        tuner->update(kernel->getScheduler());
+        Serial.println(tuner->save() ? "Stack profiles saved" : "Failed to save stack profiles");
+    } else if (strcasecmp(args[0], "clear") == 0) {
+        Serial.println(tuner->clear() ? "Stack profiles cleared" : "Failed to clear stack profiles");
+    } else {
+        printUsage("stacks", "stacks [save|clear]");
+    }
+}
+
+void Commands::cmd_df(char args[][32], int argCount) {
+    FileSystem* fs = service<FileSystem>("fs");
+    if (!fs) {
+        Serial.println("File system not available");
+        return;
+    }
+    
+    if (argCount > 0 && strcasecmp(args[0], "reset") == 0) {
+        fs->resetCacheStatistics();
+        Serial.println("Block cache statistics reset");
+    } else if (argCount > 0) {
+        printUsage("df", "df [reset]");
+    } else {
+        fs->printStatistics();
+    }
+}
+
+void Commands::cmd_fsbench(char args[][32], int argCount) {
+    if (argCount > 0) {
+        printUsage("fsbench", "fsbench");
+        return;
+    }
+    
+    PerfLock perf(kernel->getGovernor()); // Same clock for both backends
+    if (!vfsRunBenchmark()) {
+        Serial.println("Benchmark failed");
+    }
+}
+
+void Commands::cmd_cat(char args[][32], int argCount) {
+    if (argCount < 1) {
+        printUsage("cat", "cat <path>");
+        return;
+    }
+    
+    FileSystem* fs = service<FileSystem>("fs");
+    if (!fs) {
+        Serial.println("File system not available");
+        return;
+    }
+    if (!fs->fileExists(args[0])) {
+        Serial.printf("No such file: %s\n", args[0]);
+        return;
+    }
+    
+    // Streamed through one small buffer, so file size does not matter
+    uint8_t buffer[128];
+    ChunkReader reader(fs, args[0], ByteSpan(buffer, sizeof(buffer)));
+    ByteSpan chunk;
+    while (reader.next(chunk)) {
+        Serial.write(chunk.data, chunk.length);
+    }
+    Serial.println();
+}
+
+void Commands::cmd_logbench(char args[][32], int argCount) {
+    FileSystem* fs = service<FileSystem>("fs");
+    if (!fs) {
+        Serial.println("File system not available");
+        return;
+    }
+    
+    int count = 500;
+    if (argCount > 0 && (!parseInteger(args[0], &count) || count <= 0 || count > FS_LOG_BENCH_MAX)) {
+        Serial.printf("Invalid record count (1-%d)\n", FS_LOG_BENCH_MAX);
+        return;
+    }
+    
+    Serial.printf("Logging %d records each way...\n", count);
+    PerfLock perf(kernel->getGovernor());
+    if (!AppendLog::runBenchmark(fs, count)) {
+        Serial.println("Benchmark failed");
+    }
+}
+
+static void printAsset(const Asset& asset, void* context) {
+    Serial.printf("%-28s %8u  %p\n", asset.name, (unsigned)asset.length, asset.data);
+}
+
+void Commands::cmd_assets(char args[][32], int argCount) {
+    AssetStore* assets = service<AssetStore>("assets");
+    if (!assets) {
+        Serial.println("Asset store not available");
+        return;
+    }
+    
+    if (argCount == 0 || strcasecmp(args[0], "ls") == 0) {
+        Serial.println("Name                          Size  Address");
+        Serial.println("--------------------------------------------------");
+        assets->forEach(printAsset, nullptr);
+    } else if (strcasecmp(args[0], "cat") == 0 && argCount > 1) {
+        Asset asset;
+        if (!assets->find(args[1], asset)) {
+            Serial.printf("No such asset: %s\n", args[1]);
+            return;
+        }
+        Serial.write(asset.data, asset.length);   // Straight from mapped flash
+        Serial.println();
+    } else if (strcasecmp(args[0], "stats") == 0) {
+        assets->printStatistics();
+    } else {
+        printUsage("assets", "assets [ls|cat <name>|stats]");
+    }
+}
+
+void Commands::cmd_fsio(char args[][32], int argCount) {
+    AsyncIO* io = service<AsyncIO>("fsio");
+    if (!io) {
+        Serial.println("Async file I/O not available");
+        return;
+    }
+    
+    if (argCount == 0 || strcasecmp(args[0], "stats") == 0) {
+        io->printStatistics();
+    } else if (strcasecmp(args[0], "bench") == 0) {
+        int count = 32;
+        if (argCount > 1 && (!parseInteger(args[1], &count) || count <= 0 || count > FSIO_BENCH_MAX)) {
+            Serial.printf("Invalid request count (1-%d)\n", FSIO_BENCH_MAX);
+            return;
+        }
+        if (!io->runBenchmark(count)) {
+            Serial.println("Benchmark failed");
+        }
+    } else {
+        printUsage("fsio", "fsio [stats|bench [count]]");
+    }
+}
+
+void Commands::cmd_compress(char args[][32], int argCount) {
+    FileSystem* fs = service<FileSystem>("fs");
+    if (!fs) {
+        Serial.println("File system not available");
+        return;
+    }
+    
+    if (argCount == 0) {
+        fs->printCompression();
+        return;
+    }
+    
+    bool enable = argCount > 1 && strcasecmp(args[1], "on") == 0;
+    if (argCount < 2 || (!enable && strcasecmp(args[1], "off") != 0)) {
+        printUsage("compress", "compress [<dir> on|off]");
+        return;
+    }
+    // Existing files keep their format; only new files follow the setting
+    if (!fs->setCompression(args[0], enable)) {
+        Serial.printf("Cannot %s compression for %s (max %d directories)\n",
+                      enable ? "enable" : "disable", args[0], FS_COMPRESS_DIRS);
+        return;
+    }
+    Serial.printf("Compression %s for %s\n", enable ? "enabled" : "disabled", args[0]);
+}
+
 // Utility functions
 
 void Commands::printUsage(const char* command, const char* usage) {
@@ -39,6 +39,27 @@ private:
     static void cmd_sleep(char args[][32], int argCount);
     static void cmd_led(char args[][32], int argCount);
     static void cmd_wifi(char args[][32], int argCount);
+    static void cmd_lat(char args[][32], int argCount);
+    static void cmd_wq(char args[][32], int argCount);
+    static void cmd_boot(char args[][32], int argCount);
+    static void cmd_mount(char args[][32], int argCount);
+    static void cmd_umount(char args[][32], int argCount);
+    static void cmd_events(char args[][32], int argCount);
+    static void cmd_metrics(char args[][32], int argCount);
+    static void cmd_postmortem(char args[][32], int argCount);
+    static void cmd_timers(char args[][32], int argCount);
+    static void cmd_prof(char args[][32], int argCount);
+    static void cmd_services(char args[][32], int argCount);
+    static void cmd_power(char args[][32], int argCount);
+    static void cmd_cpufreq(char args[][32], int argCount);
+    static void cmd_stacks(char args[][32], int argCount);
+    static void cmd_df(char args[][32], int argCount);
+    static void cmd_fsbench(char args[][32], int argCount);
+    static void cmd_cat(char args[][32], int argCount);
+    static void cmd_logbench(char args[][32], int argCount);
+    static void cmd_assets(char args[][32], int argCount);
+    static void cmd_fsio(char args[][32], int argCount);
+    static void cmd_compress(char args[][32], int argCount);
     
     // Utility functions
     static void printUsage(const char* command, const char* usage);
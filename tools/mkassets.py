@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""
+ESP32-OS asset image builder
+
+Packs every file under a directory into the read-only image that the
+AssetStore maps straight out of the 'assets' flash partition. Names are
+paths relative to the directory, with '/' separators.
+
+    python3 tools/mkassets.py assets build/assets.bin
+    python3 tools/mkassets.py assets build/assets.bin --max-size 0x60000
+
+Layout (little-endian, must match src/filesystem/assets.h):
+    header   u32 magic "ASET", u16 version, u16 count, u32 indexSize,
+             u32 imageSize, u32 FNV-1a over the index
+    index    count x (u32 nameHash, u32 nameOffset, u32 dataOffset, u32 length),
+             sorted by (nameHash, name)
+    names    NUL-terminated, directly after the entries
+    data     each file 4-byte aligned so tables can be read in place
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = 0x54455341  # "ASET"
+VERSION = 1
+HEADER = struct.Struct("<IHHIII")
+ENTRY = struct.Struct("<IIII")
+ALIGN = 4
+MAX_NAME = 63  # FS_MAX_PATH_LENGTH - 1
+
+
+def fnv1a(data, value=2166136261):
+    for byte in data:
+        value ^= byte
+        value = (value * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def collect(root):
+    assets = []
+    if not os.path.isdir(root):
+        return assets
+    for directory, _, files in os.walk(root):
+        for name in files:
+            path = os.path.join(directory, name)
+            relative = os.path.relpath(path, root).replace(os.sep, "/")
+            encoded = relative.encode("utf-8")
+            if len(encoded) > MAX_NAME:
+                sys.exit("error: asset name too long (max %d): %s" % (MAX_NAME, relative))
+            with open(path, "rb") as handle:
+                assets.append((fnv1a(encoded), encoded, handle.read()))
+    assets.sort(key=lambda asset: (asset[0], asset[1]))
+    return assets
+
+
+def pad(size):
+    return (size + ALIGN - 1) & ~(ALIGN - 1)
+
+
+def build(assets):
+    names_offset = HEADER.size + ENTRY.size * len(assets)
+    names = b"".join(name + b"\0" for _, name, _ in assets)
+    data_offset = pad(names_offset + len(names))
+
+    entries = b""
+    data = b""
+    name_cursor = names_offset
+    for name_hash, name, content in assets:
+        entries += ENTRY.pack(name_hash, name_cursor, data_offset + len(data), len(content))
+        name_cursor += len(name) + 1
+        data += content + b"\0" * (pad(len(content)) - len(content))
+
+    index = entries + names
+    index += b"\0" * (data_offset - names_offset - len(names))
+    image_size = data_offset + len(data)
+    header = HEADER.pack(MAGIC, VERSION, len(assets), len(index), image_size, fnv1a(index))
+    return header + index + data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build the ESP32-OS asset partition image")
+    parser.add_argument("source", help="directory of assets; missing means an empty image")
+    parser.add_argument("output", help="image file to write")
+    parser.add_argument("--max-size", type=lambda value: int(value, 0), default=None,
+                        help="partition size; fail if the image does not fit")
+    args = parser.parse_args()
+
+    assets = collect(args.source)
+    image = build(assets)
+    if args.max_size is not None and len(image) > args.max_size:
+        sys.exit("error: image is %d bytes, partition holds %d" % (len(image), args.max_size))
+
+    directory = os.path.dirname(args.output)
+    if directory:
+        os.makedirs(directory, exist_ok=True)
+    with open(args.output, "wb") as handle:
+        handle.write(image)
+    print("Packed %d assets into %s (%d bytes)" % (len(assets), args.output, len(image)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+ESP32-OS profile symbolizer
+
+Reads a serial log containing the output of 'prof dump [folded|hist]',
+resolves the sampled PCs against the firmware ELF and prints either
+folded stacks (for flamegraph.pl / speedscope) or a flat histogram.
+
+    python3 tools/symbolize_profile.py capture.log > profile.folded
+    python3 tools/symbolize_profile.py capture.log --flat
+"""
+
+import argparse
+import glob
+import os
+import shutil
+import subprocess
+import sys
+from collections import defaultdict
+
+ADDR2LINE = "xtensa-esp32-elf-addr2line"
+
+
+def find_elf():
+    candidates = glob.glob(os.path.join("build", "**", "firmware.elf"), recursive=True)
+    if not candidates:
+        sys.exit("error: no firmware.elf under build/; pass --elf")
+    return max(candidates, key=os.path.getmtime)
+
+
+def find_addr2line():
+    tool = shutil.which(ADDR2LINE)
+    if tool:
+        return tool
+    packaged = os.path.expanduser(
+        os.path.join("~", ".platformio", "packages", "toolchain-xtensa-esp32", "bin", ADDR2LINE))
+    if os.path.exists(packaged):
+        return packaged
+    sys.exit("error: %s not found; pass --addr2line" % ADDR2LINE)
+
+
+def read_block(stream):
+    """Return (format, [(task or None, pc, count)]) from the last PROF block."""
+    block, fmt, current = None, None, None
+    for line in stream:
+        line = line.strip()
+        if line.startswith("PROF BEGIN"):
+            current = []
+            fields = dict(f.split("=", 1) for f in line.split()[2:] if "=" in f)
+            fmt = fields.get("format", "folded")
+        elif line == "PROF END" and current is not None:
+            block, current = current, None
+        elif current is not None and line:
+            key, _, count = line.rpartition(" ")
+            task, _, pc = key.rpartition(";")
+            current.append((task or None, int(pc, 16), int(count)))
+    if block is None:
+        sys.exit("error: no complete PROF BEGIN/END block in input")
+    return fmt, block
+
+
+def symbolize(addr2line, elf, pcs, with_lines):
+    pcs = sorted(set(pcs))
+    out = subprocess.run([addr2line, "-f", "-C", "-e", elf] + ["0x%08x" % pc for pc in pcs],
+                         check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+    lines = out.splitlines()
+    names = {}
+    for i, pc in enumerate(pcs):
+        function = lines[2 * i] if 2 * i < len(lines) else "??"
+        location = lines[2 * i + 1] if 2 * i + 1 < len(lines) else "??:0"
+        if pc == 0:
+            function = "[interrupt]"  # Timer nested on another handler
+        elif function == "??":
+            function = "0x%08x" % pc
+        if with_lines and not location.startswith("??"):
+            function = "%s (%s)" % (function, os.path.basename(location))
+        names[pc] = function
+    return names
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("log", nargs="?", help="serial capture (default: stdin)")
+    parser.add_argument("--elf", help="firmware ELF (default: newest build/**/firmware.elf)")
+    parser.add_argument("--addr2line", help="path to %s" % ADDR2LINE)
+    parser.add_argument("--flat", action="store_true", help="print a flat function histogram")
+    parser.add_argument("--lines", action="store_true", help="append source file:line to names")
+    args = parser.parse_args()
+
+    if args.log:
+        with open(args.log, errors="replace") as stream:
+            fmt, samples = read_block(stream)
+    else:
+        fmt, samples = read_block(sys.stdin)
+
+    names = symbolize(args.addr2line or find_addr2line(), args.elf or find_elf(),
+                      [pc for _, pc, _ in samples], args.lines)
+
+    totals = defaultdict(int)
+    for task, pc, count in samples:
+        if args.flat or fmt != "folded":
+            totals[names[pc]] += count
+        else:
+            totals["%s;%s" % (task, names[pc])] += count
+
+    if args.flat or fmt != "folded":
+        total = sum(totals.values()) or 1
+        print("%8s %6s  %s" % ("Samples", "Share", "Function"))
+        for name, count in sorted(totals.items(), key=lambda item: -item[1]):
+            print("%8d %5.1f%%  %s" % (count, 100.0 * count / total, name))
+    else:
+        for stack, count in sorted(totals.items()):
+            print("%s %d" % (stack, count))
+
+
+if __name__ == "__main__":
+    main()